@@ -12,7 +12,8 @@
 			※８ビット、１ストップビット、パリティ無し、５７６００ボー
 			・RXD   <---- P1_4(16):TXD0 @n
 			・TXD   ----> P1_5(15):RXD0 @n
-			※リセット、モード端子は、ハードウェアーマニュアルを参照の事
+			※リセット、モード端子は、ハードウェアーマニュアルを参照の事 @n
+			スイープ、FSK のワードは、タイマーＢの割り込み（SWEEP_RATE）で書き込む。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2019, 2021 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -28,6 +29,7 @@
 #include "common/format.hpp"
 #include "common/input.hpp"
 #include "common/spi_io.hpp"
+#include "common/dds_sweep.hpp"
 #include "chip/AD985X.hpp"
 
 // インジケーターＬＥＤ点滅を行う場合
@@ -39,9 +41,6 @@ namespace {
 	typedef device::PORT<device::PORT1, device::bitpos::B3> LED;
 #endif
 
-	typedef device::trb_io<utils::null_task, uint8_t> timer_b;
-	timer_b timer_b_;
-
 	typedef utils::fifo<uint8_t, 16> buffer;
 	typedef device::uart_io<device::UART0, buffer, buffer> UART;
 	UART	uart_;
@@ -59,7 +58,55 @@ namespace {
 	typedef chip::AD985X<D7, W_CLK, FQ_UP, RESET, 180> AD9851;
 	AD9851	ad9851_;
 
+	static const uint8_t W0 = 0b00001001;  // Phase: 1, PLL 6x
+
+	// スイープ、FSK の更新レート
+	static const uint16_t SWEEP_RATE = 1000;
+
+	typedef utils::dds_sweep<AD9851> SWEEP;
+	SWEEP	sweep_(ad9851_);
+
+	class sweep_task {
+	public:
+		void operator() () {
+			sweep_.itask();
+		}
+	};
+
+	typedef device::trb_io<sweep_task, uint16_t> timer_b;
+	timer_b timer_b_;
+
+	uint32_t	fsk_[2];
+	uint8_t		fsk_data_;
+	uint8_t		fsk_bit_;
+
 	utils::command<64> command_;
+
+	void stop_sweep_()
+	{
+		sweep_.stop();
+		while(sweep_.length() != 0) ;  // 割り込みでの書き込みを終わらせる
+	}
+
+	bool get_hz_(uint8_t n, uint32_t& hz)
+	{
+		char tmp[16];
+		command_.get_word(n, sizeof(tmp), tmp);
+		return (utils::input("%d", tmp) % hz).status();
+	}
+
+	// FSK: 送信データ（カウンター）を LSB から積む
+	void service_fsk_()
+	{
+		while(1) {
+			if(!sweep_.put_symbol((fsk_data_ >> fsk_bit_) & 1)) break;
+			++fsk_bit_;
+			if(fsk_bit_ >= 8) {
+				fsk_bit_ = 0;
+				++fsk_data_;
+			}
+		}
+	}
 }
 
 extern "C" {
@@ -118,7 +165,7 @@ int main(int argc, char *argv[])
 	// タイマーＢ初期化
 	{
 		uint8_t ir_level = 2;
-		timer_b_.start(60, ir_level);
+		timer_b_.start(SWEEP_RATE, ir_level);
 	}
 
 	// UART の設定 (P1_4: TXD0[out], P1_5: RXD0[in])
@@ -133,6 +180,7 @@ int main(int argc, char *argv[])
 	{  // AD9851 開始
 		ad9851_.start();
 		ad9851_.reset();
+		ad9851_.set_word(W0, 0);
 	}
 
 	utils::format("Start R8C AD9851 sample\n");
@@ -140,7 +188,7 @@ int main(int argc, char *argv[])
 
 #ifdef INDICATOR_LED
 	LED::DIR = 1;
-	uint8_t cnt = 0;
+	uint16_t cnt = 0;
 #endif
 
 	while(1) {
@@ -148,13 +196,18 @@ int main(int argc, char *argv[])
 
 #ifdef INDICATOR_LED
 		++cnt;
-		if(cnt >= 30) {
+		if(cnt >= (SWEEP_RATE / 2)) {
 			cnt = 0;
 		}
-		if(cnt < 10) LED::P = 1;
+		if(cnt < (SWEEP_RATE / 6)) LED::P = 1;
 		else LED::P = 0;
 #endif
 
+		sweep_.service();
+		if(sweep_.get_mode() == SWEEP::MODE::SYMBOL) {
+			service_fsk_();
+		}
+
 		// コマンド入力と、コマンド解析
 		if(command_.service()) {
 			bool error = false;
@@ -168,13 +221,51 @@ int main(int argc, char *argv[])
 						command_.get_word(1, sizeof(tmp), tmp);
 						float a = 0.0f;
 						if((utils::input("%f", tmp) % a).status()) {
-							ad9851_.set_reg(0b00001001, a);  // Phase: 1, PLL 6x
+							stop_sweep_();
+							ad9851_.set_reg(W0, a);
 						} else {
 							error = true;							
 						}
 					}
+				} else if((command_.cmp_word(0, "lin") || command_.cmp_word(0, "log")) && cmdn == 4) {
+					uint32_t f0;
+					uint32_t f1;
+					uint32_t n;
+					if(get_hz_(1, f0) && get_hz_(2, f1) && get_hz_(3, n) && n > 0 && n <= 65535) {
+						stop_sweep_();
+						sweep_.set_hold(1);
+						if(command_.cmp_word(0, "lin")) {
+							sweep_.start_linear(f0, f1, n, true);
+						} else if(!sweep_.start_log(f0, f1, n, true)) {
+							error = true;
+						}
+					} else {
+						error = true;
+					}
+				} else if(command_.cmp_word(0, "fsk") && cmdn == 4) {
+					uint32_t f0;
+					uint32_t f1;
+					uint32_t baud;
+					if(get_hz_(1, f0) && get_hz_(2, f1) && get_hz_(3, baud) && baud > 0 && baud <= SWEEP_RATE) {
+						stop_sweep_();
+						fsk_[0] = AD9851::freq_word(f0);
+						fsk_[1] = AD9851::freq_word(f1);
+						fsk_data_ = 0;
+						fsk_bit_ = 0;
+						sweep_.set_hold(SWEEP_RATE / baud);
+						sweep_.start_symbol(fsk_, 2);
+					} else {
+						error = true;
+					}
+				} else if(command_.cmp_word(0, "stop")) {
+					stop_sweep_();
+					utils::format("underrun: %u\n") % sweep_.get_underrun();
 				} else if(command_.cmp_word(0, "help")) {
 					utils::format("freq [xxxx(Hz)]\n");
+					utils::format("lin f0 f1 steps (Hz, %u steps/s)\n") % SWEEP_RATE;
+					utils::format("log f0 f1 steps (Hz, %u steps/s)\n") % SWEEP_RATE;
+					utils::format("fsk f0 f1 baud (Hz)\n");
+					utils::format("stop\n");
 				} else {
 					error = true;
 				}
@@ -31,7 +31,9 @@ namespace {
 //	constexpr int16_t VCC = 50;    ///< 5.0V (1.25)
 	constexpr int16_t VCC = 33;    ///< 3.3V (0.825)
 
-	typedef device::adc_io<utils::null_task> ADC;
+	// 繰り返し変換、２ビットのオーバーサンプリング（１２ビット）、６４回平均
+	typedef device::adc_decimator<2, 2, 64> ADC_TASK;
+	typedef device::adc_io<ADC_TASK> ADC;
 	ADC		adc_;
 }
 
@@ -62,6 +64,11 @@ extern "C" {
 	}
 
 
+	void ADC_intr(void) {
+		adc_.itask();
+	}
+
+
 	void UART0_TX_intr(void) {
 		uart_.isend();
 	}
@@ -110,35 +117,34 @@ int main(int argc, char *argv[])
 	{
 		utils::PORT_MAP(utils::port_map::P10::AN0);
 		utils::PORT_MAP(utils::port_map::P11::AN1);
-		adc_.start(ADC::CH_TYPE::CH0_CH1, ADC::CH_GROUP::AN0_AN1, true);
+		uint8_t intr_level = 1;
+		adc_.start(ADC::CH_TYPE::CH0_CH1, ADC::CH_GROUP::AN0_AN1, true, intr_level);
+		adc_.scan();
 	}
 
 	uint8_t cnt = 0;
 	uint16_t nnn = 0;
+	ADC_TASK::value_t val[2] = { { 0 } };
 	while(1) {
 		timer_b_.sync();
 
+		// 変換は割り込みで継続、間引き済みの最新値だけを受け取る
+		while(adc_.at_task().get(val)) ;
+
 		++cnt;
 		if(cnt >= 30) {
 			cnt = 0;
-			adc_.scan();
-			adc_.sync();
 			// 「%3.2:8y」は小数点以下 8 ビットの固定小数点を 3 桁、小数点以下 2 桁表示
-			//   5V の場合 1.25  倍して、小数点以下 8 ビットで、1023 で   5V 表示となる。
-			// 3.3V の場合 0.825 倍して、小数点以下 8 ビットで、1023 で 3.3V 表示となる。
-			{
-				auto v = adc_.get_value(0);
-				utils::format("(%5d) CH0: %3.2:8y[V], %d\n")
-					% nnn
-					% static_cast<uint16_t>(((v + 1) * VCC) / (1024 * 10 / 256))
-					% v;
-			}
-
-			{
-				auto v = adc_.get_value(1);
-				utils::format("        CH1: %3.2:8y[V], %d\n")
-					% static_cast<uint16_t>(((v + 1) * VCC) / (1024 * 10 / 256))
-					% v;
+			//   5V の場合 1.25  倍して、小数点以下 8 ビットで、4095 で   5V 表示となる。
+			// 3.3V の場合 0.825 倍して、小数点以下 8 ビットで、4095 で 3.3V 表示となる。
+			for(uint8_t i = 0; i < 2; ++i) {
+				auto v = val[i].val;
+				if(i == 0) utils::format("(%5d) ") % nnn;
+				else utils::format("        ");
+				utils::format("CH%d: %3.2:8y[V], %d (%d - %d)\n")
+					% static_cast<uint16_t>(i)
+					% static_cast<uint16_t>((static_cast<uint32_t>(v + 1) * VCC) / (4096 * 10 / 256))
+					% v % val[i].min % val[i].max;
 			}
 			++nnn;
 		}
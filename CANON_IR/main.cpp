@@ -1,6 +1,9 @@
 //=====================================================================//
 /*!	@file
-	@brief	R8C Canon IR remocon
+	@brief	R8C Canon IR remocon @n
+			赤外線リモコンの送受信（NEC、SONY、Canon） @n
+			P1_7: TRJIO（キャリア出力、赤外線 LED ドライバーへ） @n
+			P1_0: TRCIOD（赤外線受信モジュールの出力）
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2018, 2021 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -14,6 +17,8 @@
 #include "common/trb_io.hpp"
 #include "common/command.hpp"
 #include "common/format.hpp"
+#include "common/input.hpp"
+#include "common/ir_io.hpp"
 
 namespace {
 
@@ -24,7 +29,37 @@ namespace {
 	typedef device::uart_io<device::UART0, buffer, buffer> uart;
 	uart uart_;
 
+	typedef device::ir_io<> IR;
+	IR		ir_;
+
 	utils::command<64> command_;
+
+	bool get_num_(uint8_t n, uint32_t& v)
+	{
+		char tmp[16];
+		command_.get_word(n, sizeof(tmp), tmp);
+		return (utils::input("%d", tmp) % v).status();
+	}
+
+	void list_(const utils::ir_frame& f)
+	{
+		switch(f.proto) {
+		case utils::ir_frame::PROTO::NEC:
+			utils::format("NEC: %02X %02X (%08X)%s\n")
+				% (f.data & 0xff) % ((f.data >> 16) & 0xff) % f.data
+				% (f.repeat ? " repeat" : "");
+			break;
+		case utils::ir_frame::PROTO::SONY:
+			utils::format("SONY%d: adr: %d, cmd: %d\n")
+				% static_cast<uint16_t>(f.bits) % (f.data >> 7) % (f.data & 0x7f);
+			break;
+		case utils::ir_frame::PROTO::CANON:
+			utils::format("Canon: %s\n") % (f.data ? "2s delay" : "release");
+			break;
+		default:
+			break;
+		}
+	}
 }
 
 extern "C" {
@@ -54,6 +89,11 @@ extern "C" {
 	}
 
 
+	void TIMER_RC_intr(void) {
+		ir_.itask();
+	}
+
+
 	void UART0_TX_intr(void) {
 		uart_.isend();
 	}
@@ -95,12 +135,26 @@ int main(int argc, char *argv[])
 		uart_.start(57600, ir_level);
 	}
 
+	// 赤外線送受信（キャリア: TRJIO、受信: TRCIOD）
+	{
+		utils::PORT_MAP(utils::port_map::P17::TRJIO);
+		utils::PORT_MAP(utils::port_map::P10::TRCIOD);
+		uint8_t ir_level = 3;
+		ir_.start(ir_level);
+	}
+
 	utils::format("Start R8C Canon IR\n");
 	command_.set_prompt("# ");
 
 	while(1) {
 		timer_b_.sync();
 
+		ir_.service();
+		utils::ir_frame frame;
+		while(ir_.get(frame)) {
+			list_(frame);
+		}
+
 		// コマンド入力と、コマンド解析
 		if(command_.service()) {
 			bool error = false;
@@ -108,13 +162,44 @@ int main(int argc, char *argv[])
 			emsg[0] = 0;
 			uint8_t cmdn = command_.get_words();
 			if(cmdn >= 1) {
-				if(command_.cmp_word(0, "help")) {
-
+				if(command_.cmp_word(0, "canon") && cmdn <= 2) {
+					uint32_t dly = 0;
+					if(cmdn == 2 && !get_num_(1, dly)) error = true;
+					else if(!ir_.send(utils::ir_frame(utils::ir_frame::PROTO::CANON, dly != 0))) {
+						utils::format("IR busy\n");
+					}
+				} else if(command_.cmp_word(0, "nec") && (cmdn == 3 || cmdn == 4)) {
+					uint32_t adr, cmd;
+					uint32_t rep = 0;
+					if(get_num_(1, adr) && get_num_(2, cmd) && (cmdn == 3 || get_num_(3, rep))
+						&& adr <= 255 && cmd <= 255 && rep <= 255) {
+						if(!ir_.send(utils::ir_frame::nec(adr, cmd), rep)) {
+							utils::format("IR busy\n");
+						}
+					} else {
+						error = true;
+					}
+				} else if(command_.cmp_word(0, "sony") && (cmdn == 3 || cmdn == 4)) {
+					uint32_t adr, cmd;
+					uint32_t bits = 12;
+					if(get_num_(1, adr) && get_num_(2, cmd) && (cmdn == 3 || get_num_(3, bits))
+						&& cmd <= 127 && (bits == 12 || bits == 15 || bits == 20)) {
+						// SONY は３回送るのが普通
+						if(!ir_.send(utils::ir_frame::sony(adr, cmd, bits), 2)) {
+							utils::format("IR busy\n");
+						}
+					} else {
+						error = true;
+					}
+				} else if(command_.cmp_word(0, "help")) {
+					utils::format("canon [delay]            Canon release (delay: 0/1)\n");
+					utils::format("nec ADR CMD [REPEAT]     NEC frame\n");
+					utils::format("sony ADR CMD [BITS]      SONY frame (12/15/20 bits)\n");
 				} else {
-					command_.get_word(0, sizeof(emsg), emsg);
 					error = true;
 				}
-				if(error) {					
+				if(error) {
+					command_.get_word(0, sizeof(emsg), emsg);
 					utils::format("Command error: '%s'\n") % emsg;
 				}
 			}
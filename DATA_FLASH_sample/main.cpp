@@ -71,6 +71,11 @@ extern "C" {
 		uart_.irecv();
 	}
 
+
+	void FLASH_READY_intr(void) {
+		flash_.itask();
+	}
+
 }
 
 
@@ -178,11 +183,15 @@ int main(int argc, char *argv[])
 
 		if(command_.service()) {
 			if(command_.cmp_word(0, "erase")) {
+				// 消去中も割り込みは有効（バックグラウンド消去）
+				uint8_t ir_level = 1;
 				bool f = false;
 				if(command_.cmp_word(1, "bank0")) {
-					f = flash_.erase(FLASH::DATA_AREA::BANK0);
+					f = flash_.start_erase(FLASH::DATA_AREA::BANK0, ir_level);
+					if(f) f = flash_.sync();
 				} else if(command_.cmp_word(1, "bank1")) {
-					f = flash_.erase(FLASH::DATA_AREA::BANK1);
+					f = flash_.start_erase(FLASH::DATA_AREA::BANK1, ir_level);
+					if(f) f = flash_.sync();
 				} else {
 					sci_puts("Erase bank error...\n");
 					f = true;
@@ -99,7 +99,8 @@ namespace {
 
 
 	void disp_time_(time_t t) {
-		struct tm *m = localtime(&t);
+		struct tm ts;
+		const struct tm *m = localtime_r(&t, &ts);
 		utils::format("%s %s %d %02d:%02d:%02d  %4d\n")
 			% wday_[m->tm_wday]
 			% mon_[m->tm_mon]
@@ -134,7 +135,8 @@ namespace {
 		time_t t = get_time_();
 		if(t == 0) return;
 
-		struct tm *m = gmtime(&t);
+		struct tm ts;
+		struct tm *m = gmtime_r(&t, &ts);
 		bool err = false;
 		if(command_.get_words() == 3) {
 			char buff[12];
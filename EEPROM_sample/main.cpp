@@ -14,7 +14,7 @@
 #include "common/uart_io.hpp"
 #include "common/trb_io.hpp"
 #include "chip/EEPROM.hpp"
-#include "common/command.hpp"
+#include "common/command_shell.hpp"
 #include "common/format.hpp"
 
 namespace {
@@ -38,7 +38,6 @@ namespace {
 	typedef chip::EEPROM<iica> eeprom;
 	eeprom eeprom_(i2c_);
 
-	utils::command<64> command_;
 }
 
 extern "C" {
@@ -82,64 +81,6 @@ extern "C" {
 
 namespace {
 
-	bool get_dec_(const char* text, uint32_t& val) {
-		val = 0;
-		char ch;
-		while((ch = *text++) != 0) {
-			if(ch >= '0' && ch <= '9') {
-				ch -= '0';
-			} else {
-				return false;
-			}
-			val *= 10;
-			val += ch;
-		}
-		return true;
-	}
-
-
-	bool get_hexadec_(const char* text, uint32_t& val) {
-		val = 0;
-		char ch;
-		while((ch = *text++) != 0) {
-			if(ch >= '0' && ch <= '9') {
-				ch -= '0';
-			} else if(ch >= 'A' && ch <= 'F') {
-				ch -= 'A' - 10;
-			} else if(ch >= 'a' && ch <= 'f') {
-				ch -= 'a' - 10;
-			} else {
-				return false;
-			}
-			val <<= 4;
-			val |= ch;
-		}
-		return true;
-	}
-
-
-	bool get_value_(uint8_t no, uint32_t& val) {
-		char buff[9];
-		if(command_.get_word(no, sizeof(buff), buff)) {
-			if(get_hexadec_(buff, val)) {
-				return true;
-			}
-		}
-		return false;
-	}
-
-
-	bool get_decimal_(uint8_t no, uint32_t& val) {
-		char buff[9];
-		if(command_.get_word(no, sizeof(buff), buff)) {
-			if(get_dec_(buff, val)) {
-				return true;
-			}
-		}
-		return false;
-	}
-
-
 	void dump_(uint32_t adr, const uint8_t* src, uint8_t len) {
 		utils::format("%05X:") % adr;
 		for(uint8_t i = 0; i < len; ++i) {
@@ -149,201 +90,138 @@ namespace {
 	}
 
 
-	bool help_(uint8_t cmdn) {
-		if(cmdn >= 1 && command_.cmp_word(0, "help")) {
-			sci_puts("speed KBPS (KBPS: 10 to 1000 [Kbps])\n");
-			sci_puts("type TYPE ID SIZE (TYPE: M256B/M64KB/M128KB, ID: 0 to 7, SIZE: 1 to 256)\n");
-			sci_puts("read ADDRESS [END-ADDRESS]\n");
-			sci_puts("write ADDRESS DATA ...\n");
-			sci_puts("fill ADDRESS LENGTH DATA ...\n");
-			return true;
+	void help_(const utils::command_arg* arg, uint8_t num);
+
+
+	void speed_(const utils::command_arg* arg, uint8_t num) {
+		int32_t val = arg[0].i;
+		if(val >= 10 && val <= 1000) {
+			uint8_t clock = 1000 / val;
+			if(clock & 1) ++clock;
+			clock >>= 1;
+			if(clock == 0) clock = 1;
+			i2c_.set_clock(clock);
+		} else {
+			sci_puts("Invalid SPEED renge.\n");
 		}
-		return false;
 	}
 
 
-	bool speed_(uint8_t cmdn) {
-		if(cmdn == 2 && command_.cmp_word(0, "speed")) {
-			uint32_t val;
-			if(get_decimal_(1, val)) {
-				if(val >= 10 && val <= 1000) {
-					uint8_t clock = 1000 / val;
-					if(clock & 1) ++clock;
-					clock >>= 1;
-					if(clock == 0) clock = 1;
-					i2c_.set_clock(clock);
-				} else {
-					sci_puts("Invalid SPEED renge.\n");
-				}
+	void type_(const utils::command_arg* arg, uint8_t num) {
+		int32_t id = arg[1].i;
+		int32_t pgs = arg[2].i;
+		if(pgs <= 0 || pgs > 256) {
+			sci_puts("Invalid Page-Size renge.\n");
+			return;
+		}
+		if(std::strcmp(arg[0].s, "M256B") == 0) {
+			if(id >= 0 && id <= 7) {
+				eeprom_.start(static_cast<eeprom::M256B>(id), pgs);
 			} else {
-				sci_puts("Invalid SPEED.\n");
+				sci_puts("Invalid ID renge.\n");
 			}
-			return true;
+		} else if(std::strcmp(arg[0].s, "M64KB") == 0) {
+			if(id >= 0 && id <= 7) {
+				eeprom_.start(static_cast<eeprom::M64KB>(id), pgs);
+			} else {
+				sci_puts("Invalid ID renge.\n");
+			}
+		} else if(std::strcmp(arg[0].s, "M128KB") == 0) {
+			if(id >= 0 && id <= 3) {
+				eeprom_.start(static_cast<eeprom::M128KB>(id), pgs);
+			} else {
+				sci_puts("Invalid ID renge.\n");
+			}
+		} else {
+			sci_puts("Invalid TYPE.\n");
 		}
-		return false;
 	}
 
 
-	bool type_(uint8_t cmdn) {
-		if(cmdn == 4 && command_.cmp_word(0, "type")) {
-			uint32_t id;
-			if(!get_decimal_(2, id)) {
-				sci_puts("Invalid ID.\n");
-				return true;
-			}
-			uint32_t pgs;
-			if(!get_decimal_(3, pgs)) {
-				sci_puts("Invalid Page-Size.\n");
-				return true;
-			}
-			if(pgs == 0 || pgs > 256) {
-				sci_puts("Invalid Page-Size renge.\n");
-				return true;
+	void read_(const utils::command_arg* arg, uint8_t num) {
+		uint32_t adr = arg[0].u;
+		uint32_t end = adr + 16;
+		if(num >= 2) {
+			end = arg[1].u + 1;
+		}
+		while(adr < end) {
+			uint8_t tmp[16];
+			uint16_t len = 16;
+			if(len > (end - adr)) {
+				len = end - adr;
 			}
-			if(command_.cmp_word(1, "M256B")) {
-				if(id >= 0 && id <= 7) {
-					eeprom_.start(static_cast<eeprom::M256B>(id), pgs);
-				} else {
-					sci_puts("Invalid ID renge.\n");
-				}
-				return true;
-			} else if(command_.cmp_word(1, "M64KB")) {
-				if(id >= 0 && id <= 7) {
-					eeprom_.start(static_cast<eeprom::M64KB>(id), pgs);
-				} else {
-					sci_puts("Invalid ID renge.\n");
-				}
-				return true;
-			} else if(command_.cmp_word(1, "M128KB")) {
-				if(id >= 0 && id <= 3) {
-					eeprom_.start(static_cast<eeprom::M128KB>(id), pgs);
-				} else {
-					sci_puts("Invalid ID renge.\n");
-				}
-				return true;
+			if(eeprom_.read(adr, tmp, len)) {
+				dump_(adr, tmp, len);
 			} else {
-				sci_puts("Invalid TYPE.\n");
-				return true;
+				sci_puts("Stall EEPROM read...\n");
 			}
+			adr += len;
 		}
-		return false;
 	}
 
 
-	bool read_(uint8_t cmdn) {
-		if(cmdn >= 2 && command_.cmp_word(0, "read")) {
-			uint32_t adr;
-			if(get_value_(1, adr)) {
-				uint32_t end = adr + 16;
-				if(cmdn >= 3) {
-					if(!get_value_(2, end)) {
-						sci_puts("Invalid ADDRESS.\n");
-						return true;
-					}
-					++end;
-				}
-				while(adr < end) {
-					uint8_t tmp[16];
-					uint16_t len = 16;
-					if(len > (end - adr)) {
-						len = end - adr;
-					}
-					if(eeprom_.read(adr, tmp, len)) {
-						dump_(adr, tmp, len);
-					} else {
-						sci_puts("Stall EEPROM read...\n");
-					}
-					adr += len;
-				}
-			} else {
-				sci_puts("Invalid ADDRESS.\n");
-			}
-			return true;
+	void write_(const utils::command_arg* arg, uint8_t num) {
+		if(num > 9) {
+			sci_puts("Too many data.\n");
+			return;
+		}
+		uint32_t adr = arg[0].u;
+		num -= 1;
+		uint8_t tmp[8];
+		for(uint8_t i = 0; i < num; ++i) {
+			tmp[i] = arg[1 + i].u;
+		}
+		if(!eeprom_.write(adr, tmp, num)) {
+			sci_puts("Stall EEPROM write...\n");
 		}
-		return false;
 	}
 
 
-	bool write_(uint8_t cmdn) {
-		if(cmdn >= 3 && command_.cmp_word(0, "write")) {
-			if(cmdn > 10) {
-				sci_puts("Too many data.\n");
-				return true;
+	void fill_(const utils::command_arg* arg, uint8_t num) {
+		uint32_t adr = arg[0].u;
+		uint32_t len = arg[1].u;
+		num -= 2;
+		uint8_t tmp[8];
+		for(uint8_t i = 0; i < num; ++i) {
+			tmp[i] = arg[2 + i].u;
+		}
+		while(len > 0) {
+			if(num > len) num = len;
+			if(!eeprom_.write(adr, tmp, num)) {
+				sci_puts("Stall EEPROM write...\n");
+				break;
+			} else {
+				sci_putch('.');
 			}
-
-			uint32_t adr;
-			if(get_value_(1, adr)) {
-				cmdn -= 2;
-				uint8_t tmp[8];
-				for(uint8_t i = 0; i < cmdn; ++i) {
-					uint32_t data;
-					if(get_value_(2 + i, data)) {
-						tmp[i] = data;
-					} else {
-						sci_puts("Invalid DATA.\n");
-						return true;
-					}
+			len -= num;
+			if(len > 0) {
+				if(!eeprom_.sync_write(adr)) {
+					sci_puts("Stall EEPROM write: 'write sync time out'\n");
 				}
-				if(!eeprom_.write(adr, tmp, cmdn)) {
-					sci_puts("Stall EEPROM write...\n");
-				}
-			} else {
-				sci_puts("Invalid ADDRESS.\n");
 			}
-			return true;
+			adr += num;
 		}
-		return false;
+		sci_putch('\n');
 	}
 
 
-	bool fill_(uint8_t cmdn) {
-		if(cmdn >= 4 && command_.cmp_word(0, "fill")) {
-			if(cmdn > 11) {
-				sci_puts("Too many data.\n");
-				return true;
-			}
+	// コマンド・テーブル（名前順）
+	constexpr utils::command_entry cmd_tbl_[] = {
+		{ "fill",  "xxx*", fill_,  "ADDRESS LENGTH DATA ..." },
+		{ "help",  "",     help_,  nullptr },
+		{ "read",  "x[x",  read_,  "ADDRESS [END-ADDRESS]" },
+		{ "speed", "d",    speed_, "KBPS (KBPS: 10 to 1000 [Kbps])" },
+		{ "type",  "sdd",  type_,  "TYPE ID SIZE (TYPE: M256B/M64KB/M128KB, ID: 0 to 7, SIZE: 1 to 256)" },
+		{ "write", "xx*",  write_, "ADDRESS DATA ..." },
+	};
+	static_assert(utils::command_sorted(cmd_tbl_), "cmd_tbl_ must be sorted by name");
 
-			uint32_t adr;
-			if(get_value_(1, adr)) {
-				uint32_t len = 0;
-				if(get_value_(2, len)) {
-					cmdn -= 3;
-					uint8_t tmp[8];
-					for(uint8_t i = 0; i < cmdn; ++i) {
-						uint32_t data;
-						if(get_value_(3 + i, data)) {
-							tmp[i] = data;
-						} else {
-							sci_puts("Invalid DATA.\n");
-							return true;
-						}
-					}
-					while(len > 0) {
-						if(cmdn > len) cmdn = len;
-						if(!eeprom_.write(adr, tmp, cmdn)) {
-							sci_puts("Stall EEPROM write...\n");
-							break;
-						} else {
-							sci_putch('.');
-						}
-						len -= cmdn;
-						if(len > 0) {
-							if(!eeprom_.sync_write(adr)) {
-								sci_puts("Stall EEPROM write: 'write sync time out'\n");
-							}
-						}
-						adr += cmdn;
-					}
-					sci_putch('\n');
-					return true;
-				} else {
-					sci_puts("Invalid LENGTH.\n");
-				}
-			} else {
-				sci_puts("Invalid ADDRESS.\n");
-			}
-		}
-		return false;
+	// コマンド名＋アドレス＋データ８個まで
+	utils::command_shell<64, 10> shell_(cmd_tbl_);
+
+
+	void help_(const utils::command_arg* arg, uint8_t num) {
+		shell_.list();
 	}
 }
 
@@ -398,7 +276,7 @@ int main(int argc, char *argv[])
 	}
 
 	sci_puts("Start R8C EEPROM monitor\n");
-	command_.set_prompt("# ");
+	shell_.set_prompt("# ");
 
 	uint8_t cnt = 0;
 	while(1) {
@@ -412,20 +290,6 @@ int main(int argc, char *argv[])
 		++cnt;
 
 		// コマンド入力と、コマンド解析
-		if(command_.service()) {
-			uint8_t cmdn = command_.get_words();
-			if(cmdn == 0) ;
-			else if(help_(cmdn)) ;
-			else if(speed_(cmdn)) ;
-			else if(type_(cmdn)) ;
-			else if(read_(cmdn)) ;
-			else if(write_(cmdn)) ;
-			else if(fill_(cmdn)) ;
-			else {
-				sci_puts("Command error: ");
-				sci_puts(command_.get_command());
-				sci_putch('\n');
-			}
-		}
+		shell_.service();
 	}
 }
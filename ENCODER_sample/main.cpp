@@ -32,8 +32,9 @@ namespace {
 	static const uint8_t TIMER_MULTI_NUM = 6;
 	typedef device::PORT<device::PORT1, device::bitpos::B0> PHA;
 	typedef device::PORT<device::PORT1, device::bitpos::B1> PHB;
-	// パラメーターを指定しない場合、DECODE::PHA_POS: A 相の立ち上がりのみでカウントとなる。
-	typedef chip::ENCODER<PHA, PHB, uint16_t> ENCODER; 
+	// DECODE::PHA_POS: A 相の立ち上がりのみでカウントとなる。
+	// 速度は 36 サンプル（0.1 秒）毎に更新
+	typedef chip::ENCODER<PHA, PHB, uint16_t, chip::ENCODER_BASE::DECODE::PHA_POS, 36> ENCODER;
 	ENCODER	encoder_;
 
 	class timer_t {
@@ -118,7 +119,7 @@ int main(int argc, char *argv[])
 
 	// エンコーダー関係の初期化
 	{
-		encoder_.start();
+		encoder_.start(60 * TIMER_MULTI_NUM);
 	}
 
 	// タイマーＢ初期化
@@ -144,9 +145,12 @@ int main(int argc, char *argv[])
 		timer_b_.task_.sync60();
 
 		auto count = encoder_.get_count();
-		if(count != value) {
+		bool upd = encoder_.update();
+		if(count != value || (upd && encoder_.get_velocity() != 0)) {
 			value = count;
-			utils::format("%05d\n") % value;
+			// 速度は小数点以下８ビットの固定小数点
+			utils::format("%05d, %6.1:8y [c/s] (%d)\n") % value
+				% encoder_.get_velocity() % encoder_.get_error();
 		}
 	}
 }
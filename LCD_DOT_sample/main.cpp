@@ -51,19 +51,32 @@ namespace {
 
 	class PLOT {
 	public:
-		typedef int8_t value_type;
+		typedef int16_t value_type;
 
-		static const int8_t WIDTH  = 128;
-		static const int8_t HEIGHT = 64;
+		static const int16_t WIDTH  = 128;
+		static const int16_t HEIGHT = 32;
+		static const bool PAGE_LAYOUT = true;	///< ページ構成のフレームバッファ
 
+	private:
+		uint8_t	fb_[WIDTH * HEIGHT / 8];
+
+	public:
 		void clear(uint8_t v = 0)
 		{
+			for(uint16_t i = 0; i < (WIDTH * HEIGHT / 8); ++i) {
+				fb_[i] = v;
+			}
 		} 
 
-		void operator() (int8_t x, int8_t y, bool val)
+		uint8_t* fb() { return fb_; }
+
+		void operator() (int16_t x, int16_t y, bool val)
 		{
 			if(x < 0 || x >= WIDTH) return;
 			if(y < 0 || y >= HEIGHT) return;
+			uint8_t& d = fb_[(y >> 3) * WIDTH + x];
+			if(val) d |= 1 << (y & 7);
+			else d &= ~(1 << (y & 7));
 		}
 	};
 
@@ -190,7 +203,7 @@ int main(int argc, char *argv[])
 	uint8_t loop = 20;
 	while(1) {
 		timer_b_.sync();
-///		lcd_.copy(bitmap_.fb(), bitmap_.page_num());
+		lcd_.flush_dirty(bitmap_);
 
 		if(loop >= 20) {
 			loop = 0;
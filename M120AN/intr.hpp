@@ -47,7 +47,7 @@ namespace device {
 		bits_rw_t<io_, bitpos::B0, 2> INT0F;
 		bits_rw_t<io_, bitpos::B2, 2> INT1F;
 		bits_rw_t<io_, bitpos::B4, 2> INT2F;
-		bits_rw_t<io_, bitpos::B5, 2> INT3F;
+		bits_rw_t<io_, bitpos::B6, 2> INT3F;
 	};
 	static intf0_t INTF0;
 
@@ -67,7 +67,7 @@ namespace device {
 		bits_rw_t<io_, bitpos::B0, 2> INT0S;
 		bits_rw_t<io_, bitpos::B2, 2> INT1S;
 		bits_rw_t<io_, bitpos::B4, 2> INT2S;
-		bits_rw_t<io_, bitpos::B5, 2> INT3S;
+		bits_rw_t<io_, bitpos::B6, 2> INT3S;
 	};
 	static iscr0_t ISCR0;
 
@@ -4,6 +4,8 @@
 			MCP2515(SCK)  ---> SPI_SCK (P1_1:19) @n
 			MCP2515(MOSI) ---> SPI_MOSI(P1_2:18) @n
 			MCP2515(MISO) ---> SPI_MISO(P1_3:17) @n
+			MCP2515(CS)   ---> MCP_CS  (P1_0:20) @n
+			MCP2515(INT)  ---> INT3    (P3_3) @n
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2017, 2021 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -38,8 +40,7 @@ namespace {
 	typedef device::PORT<device::PORT1, device::bitpos::B2> SPI_MOSI;
 	// P1_3(17):
 	typedef device::PORT<device::PORT1, device::bitpos::B3> SPI_MISO;
-	// P1_4(16)
-	typedef device::PORT<device::PORT1, device::bitpos::B4> MCP_INT;
+	// MCP2515 の INT は P3_3 (INT3) に接続
 
 	typedef device::spi_io<SPI_MISO, SPI_MOSI, SPI_SCK, device::soft_spi_mode::CK01_> SPI;
 	SPI		spi_;
@@ -83,6 +84,11 @@ extern "C" {
 	void UART0_RX_intr(void) {
 		uart_.irecv();
 	}
+
+
+	void INT3_intr(void) {
+		mcp_.notify();
+	}
 }
 
 
@@ -124,7 +130,7 @@ int main(int argc, char *argv[])
 		spi_.start(speed);
 	}
 
-	// MFRC522 開始 (send)
+	// MCP2515 開始
 	{
 		if(mcp_.start(MCP::ID_MODE::ANY, MCP::SPEED::BPS_500K)) {
 			utils::format("MCP2515 Start OK\n");
@@ -132,32 +138,52 @@ int main(int argc, char *argv[])
 			utils::format("MCP2515 Start NG\n");
 		}
 		mcp_.set_mode(MCP::MODE::NORMAL);
-		MCP_INT::DIR = 0;  // input
-		MCP_INT::PU = 1;
+		// INT (P3_3: INT3、立下りエッジ)
+		utils::PORT_MAP(utils::port_map::P33::INT3);
+		PUR3.B3 = 1;  // P3_3 プルアップ
+		ISCR0.INT3S = 0;
+		INTEN.INT3EN = 1;
+		ILVLD.B01 = 1;
+		mcp_.set_interrupt(true);
 	}
 
 	using namespace utils;
 
+	uint8_t cnt = 0;
+	uint8_t seq = 0;
 	while(1) {
 		timer_b_.sync();
 
-		const uint8_t data[8] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 };
-		// send data:  ID = 0x100, Standard CAN Frame, Data length = 8
-		// bytes, 'data' = array of data bytes to send
-		if(!mcp_.send(0x100, 0, data, 8)) {
-			utils::format("Send: NG\n");
+		// 0.5 秒毎に送信キューへ積む: ID = 0x100, 標準フレーム, ８バイト
+		++cnt;
+		if(cnt >= 30) {
+			cnt = 0;
+			const uint8_t data[8] = { seq, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 };
+			if(!mcp_.post(0x100, 0, data, 8)) {
+				utils::format("Send: queue full\n");
+			}
+			++seq;
 		}
 
-		if(!MCP_INT::P()) {
-			uint32_t id;
-			uint8_t ext;
-			uint8_t len;
-			uint8_t tmp[8];
-			if(mcp_.recv(id, ext, tmp, len)) {
-				utils::format("ID: %8X\n") % id;
+		mcp_.service();
+
+		MCP::frame_t f;
+		while(mcp_.get(f)) {
+			if(f.ext) utils::format("ID: %08X (%d):") % f.id % static_cast<uint16_t>(f.len);
+			else utils::format("ID: %03X (%d):") % f.id % static_cast<uint16_t>(f.len);
+			if(f.rtr) {
+				utils::format(" RTR");
 			} else {
-				utils::format("Recv fail\n");
+				for(uint8_t i = 0; i < f.len; ++i) {
+					utils::format(" %02X") % static_cast<uint16_t>(f.data[i]);
+				}
 			}
+			utils::format("\n");
+		}
+
+		if(cnt == 0 && seq == 0) {
+			utils::format("Lost: %u, Overrun: %u, Bus error: %u\n")
+				% mcp_.get_lost() % mcp_.get_overrun() % mcp_.get_bus_error();
 		}
 	}
 }
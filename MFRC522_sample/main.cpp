@@ -161,16 +161,17 @@ int main(int argc, char *argv[])
 
 		// Look for new cards
 		if(mfrc522_.detect_card()) {
-			utils::format("Card Detect !\n");
-#if 0
-	// Select one of the cards
-	if ( ! mfrc522.PICC_ReadCardSerial()) {
-		return;
-	}
-
-	// Dump debug info about the card; PICC_HaltA() is automatically called
-	mfrc522.PICC_DumpToSerial(&(mfrc522.uid));
-#endif
+			MFRC522::uid_t uid;
+			if(mfrc522_.select(uid) == MFRC522::status::OK) {
+				utils::format("Card UID:");
+				for(uint8_t i = 0; i < uid.size; ++i) {
+					utils::format(" %02X") % static_cast<uint16_t>(uid.uid_byte[i]);
+				}
+				utils::format(", SAK: %02X\n") % static_cast<uint16_t>(uid.sak);
+				mfrc522_.halt();
+			} else {
+				utils::format("Card Detect !\n");
+			}
 		}
 
 #if 0
@@ -13,6 +13,7 @@
 #include "common/uart_io.hpp"
 #include "common/trb_io.hpp"
 #include "chip/MPU6050.hpp"
+#include "common/imu_filter.hpp"
 #include "common/command.hpp"
 #include "common/format.hpp"
 
@@ -33,7 +34,12 @@ namespace {
 
 	typedef device::iica_io<sda_port, scl_port> iica;
 	iica i2c_;
-	chip::MPU6050<iica> mpu6050_(i2c_);
+	typedef chip::MPU6050<iica> mpu6050;
+	mpu6050 mpu6050_(i2c_);
+
+	// サンプル・レート 200Hz（FIFO で読み出す）
+	static const uint16_t imu_rate_ = 200;
+	utils::imu_filter<> imu_filter_;
 
 	utils::command<64> command_;
 }
@@ -117,6 +123,8 @@ int main(int argc, char *argv[])
 		if(!mpu6050_.start()) {
 			utils::format("Stall MPU6050 start (%d)\n") % static_cast<uint32_t>(i2c_.get_last_error());
 		}
+		mpu6050_.start_fifo(imu_rate_);
+		imu_filter_.start(imu_rate_);
 	}
 
 	sci_puts("Start R8C MPU6050 sample\n");
@@ -125,6 +133,10 @@ int main(int argc, char *argv[])
 	// LED シグナル用ポートを出力
 	PD1.B0 = 1;
 
+	// ジャイロのバイアス（静止状態の平均、64 サンプル）
+	int32_t bias[3] = { 0 };
+	uint8_t bias_n = 0;
+
 	uint8_t n = 0;
 	uint8_t cnt = 0;
 	while(1) {
@@ -137,18 +149,37 @@ int main(int argc, char *argv[])
 		else P1.B0 = 0;
 		++cnt;
 
+		// FIFO のフレームを読み出して、姿勢を更新
+		mpu6050_.service();
+		mpu6050::frame_t f;
+		while(mpu6050_.get(f)) {
+			if(bias_n < 64) {
+				bias[0] += f.gyro.x;
+				bias[1] += f.gyro.y;
+				bias[2] += f.gyro.z;
+				++bias_n;
+				if(bias_n == 64) {
+					mpu6050::int16_vec b;
+					b.x = bias[0] / 64;
+					b.y = bias[1] / 64;
+					b.z = bias[2] / 64;
+					imu_filter_.set_bias(b);
+				}
+			} else {
+				imu_filter_.update(f.accel, f.gyro);
+			}
+		}
+
 		++n;
 		if(n >= 60) {
 			n = 0;
 
-			auto a = mpu6050_.get_accel();
-			utils::format("ACCEL: %d, %d, %d\n") % a.x % a.y % a.z;
-
 			auto t = mpu6050_.get_temp();
 			utils::format("TEMP:  %d.%1d\n") % (t / 10) % (t % 10);
 
-			auto g = mpu6050_.get_gyro();
-			utils::format("GYRO:  %d, %d, %d\n") % g.x % g.y % g.z;
+			utils::format("ROLL: %d, PITCH: %d, YAW: %d (x0.01), OVF: %d\n")
+				% imu_filter_.get_roll() % imu_filter_.get_pitch() % imu_filter_.get_yaw()
+				% mpu6050_.get_overflow();
 		}
 
 		// コマンド入力と、コマンド解析
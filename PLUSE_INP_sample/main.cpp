@@ -67,7 +67,7 @@ extern "C" {
 
 
 	void TIMER_RJ_intr(void) {
-		timer_j_.iinp();
+		timer_j_.ifreq();
 	}
 
 }
@@ -103,36 +103,34 @@ int main(int argc, char *argv[])
 		uart_.start(57600, ir_level);
 	}
 
-	// TRJ のパルス周期測定
+	// TRJ のパルス周期測定（レシプロカル方式、ゲート時間 200ms）
 	auto srcclk = TIMER_J::source::f1;
-	uint32_t master = F_CLK;
 	{
 		utils::PORT_MAP(utils::port_map::P17::TRJIO);
 		device::PINSR.TRJIOSEL = 0;	// TRJIO を選択
-		// uint8_t ir_level = 2;
-		timer_j_.pluse_inp(TIMER_J::measurement::freq, srcclk);
+		uint8_t ir_level = 2;
+		timer_j_.start_freq(srcclk, 200, ir_level);
 	}
 
 	sci_puts("Start R8C PLUSE input sample\n");
 
 	uint8_t n = 0;
+	uint8_t id = timer_j_.get_freq_id();
 	while(1) {
 		timer_b_.sync();
 		++n;
 		if(n >= interval) {
-			uint16_t cnt;
-			bool f = timer_j_.get_count(cnt);
-			if(!f) {
-				utils::format("Range error.\n");
-			} else if(cnt == 0) {
-				utils::format("Terminate error.\n");
+			n = 0;
+			uint32_t frq;
+			if(id == timer_j_.get_freq_id()) {
+				utils::format("Wait gate...\n");
+			} else if(!timer_j_.get_freq(srcclk, frq, 8)) {
+				utils::format("No input.\n");
 			} else {
-				uint32_t frq = master / static_cast<uint32_t>(cnt + 1);
-				utils::format("Freq: %d Hz (%d, %d)\n") % frq %
-					static_cast<uint32_t>(cnt) % static_cast<uint32_t>(master);
+				// 小数点以下８ビットの固定小数点
+				utils::format("Freq: %10.3:8y Hz\n") % frq;
 			}
-			timer_j_.restart_inp(srcclk);
-			n = 0;
+			id = timer_j_.get_freq_id();
 		}
 	}
 }
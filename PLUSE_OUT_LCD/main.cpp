@@ -17,6 +17,7 @@
 #include "common/command.hpp"
 #include "common/format.hpp"
 #include "common/trb_io.hpp"
+#include "common/scheduler.hpp"
 #include "common/trj_io.hpp"
 #include "common/spi_io.hpp"
 #include "chip/ST7565.hpp"
@@ -129,6 +130,7 @@ namespace {
 
 		static const int16_t WIDTH  = 128;
 		static const int16_t HEIGHT = 32;
+		static const bool PAGE_LAYOUT = true;	///< ページ構成のフレームバッファ
 
 	private:
 		uint8_t	fb_[WIDTH * HEIGHT / 8];
@@ -147,6 +149,9 @@ namespace {
 		{
 			if(x < 0 || x >= WIDTH) return;
 			if(y < 0 || y >= HEIGHT) return;
+			uint8_t& d = fb_[(y >> 3) * WIDTH + x];
+			if(val) d |= 1 << (y & 7);
+			else d &= ~(1 << (y & 7));
 		}
 	};
 
@@ -155,6 +160,90 @@ namespace {
 
 	typedef device::trj_io<utils::null_task> timer_j;
 	timer_j timer_j_;
+
+	typedef utils::scheduler<device::trb_io<encoder, uint8_t>, 2> SCHEDULER;
+	SCHEDULER	scheduler_(timer_b_);
+
+	uint32_t count_ = 20;
+	uint32_t value_ = 0;
+	uint8_t disp_[6] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+
+	// エンコーダー値の増減と、出力周波数の更新（240Hz）
+	void encoder_task_()
+	{
+		int32_t d = 0;
+		if(enc_cnt_ >= 4) {
+			enc_cnt_ = 0;
+			d = 1;
+		} else if(enc_cnt_ <= -4) { 
+			enc_cnt_ = 0;
+			d = -1;
+		}
+		if(d) {
+			if(count_ < 100) {
+				d *= 1;
+			} else if(count_ < 1000) { // 1KHz
+				d *= 10; // 10Hz step
+			} else if(count_ < 10000) { // 10KHz
+				d *= 100; // 100Hz step
+			} else if(count_ < 100000) { // 100KHz
+				d *= 1000; // 1KHz step
+			} else if(count_ < 1000000) { // 1MHz
+				d *= 10000; // 10KHz step
+			} else {
+				d *= 100000; // 100KHz step
+			}
+			count_ += static_cast<uint32_t>(d);
+			if(count_ < 20) count_ = 20;
+			else if(count_ > 10000000) count_ = 10000000;
+		}
+
+		if(value_ != count_) {
+			value_ = count_;
+
+			timer_j_.set_cycle(count_);
+
+			if(count_ > 99999) {
+				utils::format("%dKHz\n") % (count_ / 1000);
+			} else {
+				utils::format("%dHz\n") % count_;
+			}
+		}
+	}
+
+	// 表示（1/15 sec）
+	// 変化した桁だけを描画して、更新された領域だけを転送する
+	void lcd_task_()
+	{
+		uint32_t n = count_;
+		bool khz = false;
+		if(n > 99999) {
+			n /= 1000;
+			khz = true;
+		}
+		for(uint8_t i = 0; i < 5; ++i) {
+			uint8_t d = n % 10;
+			n /= 10;
+			uint8_t pos = 4 - i;
+			if(disp_[pos] != d) {
+				disp_[pos] = d;
+				bitmap_.fill(20 * pos, 0, 20, 32, 0);
+				bitmap_.draw_mobj(20 * pos, 0, nmbs_[d]);
+			}
+		}
+		uint8_t unit = khz ? 11 : 10;
+		if(disp_[5] != unit) {
+			disp_[5] = unit;
+			bitmap_.fill(20 * 5, 0, 128 - 20 * 5, 32, 0);
+			if(khz) {
+				bitmap_.draw_mobj(20 * 5, 0, nmbs_[11]);
+				bitmap_.draw_mobj(20 * 5 + 11, 0, nmbs_[10]);
+			} else {
+				bitmap_.draw_mobj(20 * 5, 0, nmbs_[10]);
+			}
+		}
+		lcd_.flush_dirty(bitmap_);
+	}
 }
 
 extern "C" {
@@ -254,13 +343,11 @@ int main(int argc, char *argv[])
 		bitmap_.clear(0);
 	}
 
-	uint32_t count = 20;
-
 	// TRJ のパルス出力設定
 	{
 		utils::PORT_MAP(utils::port_map::P17::TRJIO);
 		uint8_t ir_level = 1;
-		if(!timer_j_.pluse_out(count, ir_level)) {
+		if(!timer_j_.pluse_out(count_, ir_level)) {
 			sci_puts("TRJ out of range.\n");
 		}
 	}
@@ -268,78 +355,7 @@ int main(int argc, char *argv[])
 	sci_puts("Start R8C PLUSE OUT/LCD\n");
 	command_.set_prompt("# ");
 
-	uint8_t cnt = 0;
-	uint32_t value = 0;
-	while(1) {
-		timer_b_.sync();
-
-		// エンコーダー値の増減
-		int32_t d = 0;
-		if(enc_cnt_ >= 4) {
-			enc_cnt_ = 0;
-			d = 1;
-		} else if(enc_cnt_ <= -4) { 
-			enc_cnt_ = 0;
-			d = -1;
-		}
-		if(d) {
-			if(count < 100) {
-				d *= 1;
-			} else if(count < 1000) { // 1KHz
-				d *= 10; // 10Hz step
-			} else if(count < 10000) { // 10KHz
-				d *= 100; // 100Hz step
-			} else if(count < 100000) { // 100KHz
-				d *= 1000; // 1KHz step
-			} else if(count < 1000000) { // 1MHz
-				d *= 10000; // 10KHz step
-			} else {
-				d *= 100000; // 100KHz step
-			}
-			count += static_cast<uint32_t>(d);
-			if(count < 20) count = 20;
-			else if(count > 10000000) count = 10000000;
-		}
-
-		if(value != count) {
-			value = count;
-
-			timer_j_.set_cycle(count);
-
-			if(count > 99999) {
-				utils::format("%dKHz\n") % (count / 1000);
-			} else {
-				utils::format("%dHz\n") % count;
-			}
-		}
-
-		// 1/15 sec
-		if((cnt & 15) == 0) {
-			bitmap_.clear(0);
-			uint32_t n = count;
-			bool khz = false;
-			if(n > 99999) {
-				n /= 1000;
-				khz = true;
-			}
-			bitmap_.draw_mobj(20 * 4, 0, nmbs_[n % 10]);
-			n /= 10;
-			bitmap_.draw_mobj(20 * 3, 0, nmbs_[n % 10]);
-			n /= 10;
-			bitmap_.draw_mobj(20 * 2, 0, nmbs_[n % 10]);
-			n /= 10;
-			bitmap_.draw_mobj(20 * 1, 0, nmbs_[n % 10]);
-			n /= 10;
-			bitmap_.draw_mobj(20 * 0, 0, nmbs_[n % 10]);
-			if(khz) {
-				bitmap_.draw_mobj(20 * 5, 0, nmbs_[11]);
-				bitmap_.draw_mobj(20 * 5 + 11, 0, nmbs_[10]);
-			} else {
-				bitmap_.draw_mobj(20 * 5, 0, nmbs_[10]);
-			}
-			lcd_.copy(bitmap_.at_plot().fb(), 4);
-		}
-
-		++cnt;
-	}
+	scheduler_.add(encoder_task_, 1, 0);
+	scheduler_.add(lcd_task_, 16, 1);
+	scheduler_.run();
 }
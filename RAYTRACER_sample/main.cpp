@@ -148,7 +148,7 @@ int main(int argc, char *argv[])
 
 	uart_.puts("Start R8C RAYTRACER sample\n");
 
-	doRaytrace();
+	doRaytrace<fixed>();
 
 	command_.set_prompt("# ");
 
@@ -159,7 +159,15 @@ int main(int argc, char *argv[])
 			uint8_t cmdn = command_.get_words();
 			if(cmdn >= 1) {
 				char tmp[32];
-				if(command_.get_word(0, sizeof(tmp), tmp)) {
+				if(command_.cmp_word(0, "float")) {  // float 版の描画時間
+					uint32_t t = millis();
+					doRaytrace<float>();
+					utils::format("float: %u [ms]\n") % (millis() - t);
+				} else if(command_.cmp_word(0, "fixed")) {  // 固定小数点版の描画時間
+					uint32_t t = millis();
+					doRaytrace<fixed>();
+					utils::format("fixed: %u [ms]\n") % (millis() - t);
+				} else if(command_.get_word(0, sizeof(tmp), tmp)) {
 					int a = 0;
 					int n = (utils::input("%d", tmp) % a).num();
 					if(n == 1) {
@@ -5,12 +5,16 @@
 
   I modified it a lot adding colors/materials, arbitrary sphere
   positions, etc.
-  
+
   I also added some comments and made it readable. The original
   code was designed to be small enough to print on the back of
   a business card (hence the name) so it was very hard to read.
-  
+
   FTB.
+
+  The engine is a template over the scalar type: 'float' is the
+  reference, 'fixed' (Q20.12 in an int32_t) uses integer math only,
+  so on R8C no soft-float routine is called while rendering.
 ------------------------------------------------------------------------*/
 #include <cmath>
 #include <cstdint>
@@ -51,36 +55,154 @@ static inline float sqrtf_(float x) { return sqrtf(x); }
 static inline int ceilf_(float x) { return ceilf(x); }
 #endif
 
+static inline float rsqrtf_(float x) { return 1.0f / sqrtf_(x); }
+
+/*------------------------------------------------------------------------
+  Q20.12 fixed point scalar
+
+  Construction from float is 'constexpr' and is meant for constants
+  only (it is folded at compile time). Only 32 bit integer operations
+  are used (no 64 bit libgcc helpers on R8C): products of two values
+  that fit in 16 bits take a single 16x16->32 multiply, larger ones
+  are split or pre-shifted, quotients are built by long division and
+  saturate. The range (+-524288) covers the squared distances of this
+  scene as long as hits are kept within 'fixed::FAR' (see 'far_').
+------------------------------------------------------------------------*/
+struct fixed {
+  int32_t v;
+
+  static const int8_t FRAC = 12;
+  static const int32_t ONE = static_cast<int32_t>(1) << FRAC;
+  static const int16_t FAR = 256;
+
+  fixed() {}
+  constexpr fixed(int i) : v(static_cast<int32_t>(i) * ONE) {}
+  constexpr fixed(float f) : v(static_cast<int32_t>(f * static_cast<float>(ONE))) {}
+
+  static fixed raw(int32_t r) { fixed t; t.v = r; return t; }
+
+  // (a * b) >> FRAC
+  static int32_t mul(int32_t a, int32_t b) {
+    if (a == static_cast<int16_t>(a) && b == static_cast<int16_t>(b)) {
+      return (static_cast<int32_t>(static_cast<int16_t>(a)) * static_cast<int16_t>(b)) >> FRAC;
+    }
+    const bool neg = (a < 0) != (b < 0);
+    uint32_t ua = a < 0 ? -static_cast<uint32_t>(a) : a;
+    uint32_t ub = b < 0 ? -static_cast<uint32_t>(b) : b;
+    if (ua < ub) { uint32_t t = ua; ua = ub; ub = t; }
+    uint32_t r;
+    if (ub < 0x10000) {
+      // small operand (< 16.0): integer and fraction part of the larger one
+      r = (ua >> FRAC) * ub + (((ua & (ONE - 1)) * ub) >> FRAC);
+    } else {
+      // both >= 16.0 (then ub < 2^22 for a result in range):
+      // fraction part of the larger one with pre-shifted operands
+      r = (ua >> FRAC) * ub + ((((ua & (ONE - 1)) >> 2) * (ub >> 2)) >> (FRAC - 4));
+    }
+    return neg ? -static_cast<int32_t>(r) : static_cast<int32_t>(r);
+  }
+
+  // (a << FRAC) / b (saturated)
+  static int32_t div(int32_t a, int32_t b) {
+    const bool neg = (a < 0) != (b < 0);
+    uint32_t ua = a < 0 ? -static_cast<uint32_t>(a) : a;
+    uint32_t ub = b < 0 ? -static_cast<uint32_t>(b) : b;
+    uint32_t q = 0x7fffffff;
+    if (ub != 0 && (ua / ub) < (static_cast<uint32_t>(1) << (31 - FRAC))) {
+      q = ua / ub;
+      uint32_t r = ua % ub;
+      for (uint8_t i = 0; i < FRAC; ++i) {
+        r <<= 1;
+        q <<= 1;
+        if (r >= ub) { r -= ub; q |= 1; }
+      }
+    }
+    return neg ? -static_cast<int32_t>(q) : static_cast<int32_t>(q);
+  }
+
+  fixed operator+(fixed b) const { return raw(v + b.v); }
+  fixed operator-(fixed b) const { return raw(v - b.v); }
+  fixed operator-() const { return raw(-v); }
+  fixed operator*(fixed b) const { return raw(mul(v, b.v)); }
+  fixed operator/(fixed b) const { return raw(div(v, b.v)); }
+  void operator+=(fixed b) { v += b.v; }
+  void operator*=(fixed b) { v = mul(v, b.v); }
+
+  bool operator<(fixed b)  const { return v <  b.v; }
+  bool operator>(fixed b)  const { return v >  b.v; }
+  bool operator<=(fixed b) const { return v <= b.v; }
+  bool operator>=(fixed b) const { return v >= b.v; }
+
+  explicit operator int() const { return v >> FRAC; }
+};
+
+// Integer square root of a 32 bit value (bit by bit, no multiply/divide)
+static inline uint32_t isqrt32_(uint32_t x)
+{
+  uint32_t r = 0;
+  uint32_t b = static_cast<uint32_t>(1) << 30;
+  while (b > x) b >>= 2;
+  while (b != 0) {
+    if (x >= r + b) {
+      x -= r + b;
+      r = (r >> 1) + b;
+    } else {
+      r >>= 1;
+    }
+    b >>= 2;
+  }
+  return r;
+}
+
+// sqrt(x) = sqrt(x.v << 12): shift as much of the 12 bits in as fits
+static inline fixed sqrtf_(fixed x)
+{
+  if (x.v <= 0) return fixed::raw(0);
+  uint32_t u = x.v;
+  uint8_t s = 0;
+  while (s < (fixed::FRAC / 2) && u < 0x40000000) {
+    u <<= 2;
+    ++s;
+  }
+  return fixed::raw(isqrt32_(u) << ((fixed::FRAC / 2) - s));
+}
+
+static inline int ceilf_(fixed x) { return (x.v + (fixed::ONE - 1)) >> fixed::FRAC; }
+
+// Far clip for hits, so that squared distances stay in range
+static inline float far_(float d) { return d; }
+static inline fixed far_(fixed d) { return d > fixed(fixed::FAR) ? fixed(fixed::FAR) : d; }
+
 /*------------------------------------------------------------------------
   Values you can play with...
 ------------------------------------------------------------------------*/
 
 // Position of the camera (nb. 'Z' is up/down)
-static const float cameraX = 0.0f;
-static const float cameraY = 0.0f;
-static const float cameraZ = 3.0f;
+static constexpr float cameraX = 0.0f;
+static constexpr float cameraY = 0.0f;
+static constexpr float cameraZ = 3.0f;
 
 // What the camera is pointing at
-static const float targetX = 1.0f;
-static const float targetY = 8.0f;
-static const float targetZ = 4.0f;
+static constexpr float targetX = 1.0f;
+static constexpr float targetY = 8.0f;
+static constexpr float targetZ = 4.0f;
 
-// We cast this many rays per pixel for stochastic antialiasing and soft-shadows. 
+// We cast this many rays per pixel for stochastic antialiasing and soft-shadows.
 //
 // Large numbers produce a nicer image but it runs a lot slower
 //static const int raysPerPixel = 4;
 
 // The camera's field of view, smaller=>zoom, larger=>wide angle
-static const float fov = 0.45f;
+static constexpr float fov = 0.45f;
 
 // The size of the soft shadow, larger=>wider area
-static const float shadowRegion = 0.125f;
+static constexpr float shadowRegion = 0.125f;
 
 /*------------------------------------------------------------------------
   Materials
 ------------------------------------------------------------------------*/
-static const float ambient = 0.05f;
-static const float materials[] = {
+static constexpr float ambient = 0.05f;
+static constexpr float materials[] = {
 // R,    G,    B,   REFLECTIVITY
   0.8f, 0.8f, 0.8f,   0.5f,    // Mirror
 //  1.0f, 0.0f, 0.0f,   0.3f,    // Red
@@ -93,7 +215,7 @@ static const float materials[] = {
   The spheres in the world
 ------------------------------------------------------------------------*/
 #define NUM_SPHERES 4
-static const float spheres[] = {
+static constexpr float spheres[] = {
 // center  radius material
    5,15,8,   5,     0,
   -6,12,4,   3,     0,
@@ -104,26 +226,71 @@ static const float spheres[] = {
 /*------------------------------------------------------------------------
   A 3D vector class
 ------------------------------------------------------------------------*/
-struct vec3 {
-  float x,y,z;  // Vector has three float attributes.
-  vec3(){}
-  vec3(float a, float b, float c){x=a;y=b;z=c;}
-  vec3 operator+(const vec3& v) const { return vec3(x+v.x,y+v.y,z+v.z);  }    // Vector add
-  vec3 operator-(const vec3& v) const { return (*this)+(v*-1);           }    // Vector subtract
-  vec3 operator*(float s)       const { return vec3(x*s,y*s,z*s);        }    // Vector scale
-  float operator%(const vec3& v)const { return x*v.x+y*v.y+z*v.z;        }    // Scalar product
-  vec3 operator^(const vec3& v) const { return vec3(y*v.z-z*v.y, z*v.x-x*v.z, x*v.y-y*v.x);  } // Vector product
-  vec3 operator!()              const { return *this*(1.0f/sqrtf_(*this%*this));  }  // Normalized vector
-  void operator+=(const vec3& v)      { x+=v.x;  y+=v.y;  z+=v.z;        }
-  void operator*=(float s)            { x*=s;    y*=s;    z*=s;          }
+template <typename T>
+struct vec3_t {
+  T x,y,z;  // Vector has three scalar attributes.
+  vec3_t(){}
+  constexpr vec3_t(T a, T b, T c) : x(a), y(b), z(c) {}
+  vec3_t operator+(const vec3_t& v) const { return vec3_t(x+v.x,y+v.y,z+v.z);  }    // Vector add
+  vec3_t operator-(const vec3_t& v) const { return vec3_t(x-v.x,y-v.y,z-v.z);  }    // Vector subtract
+  vec3_t operator*(T s)             const { return vec3_t(x*s,y*s,z*s);        }    // Vector scale
+  T operator%(const vec3_t& v)      const { return x*v.x+y*v.y+z*v.z;          }    // Scalar product
+  vec3_t operator^(const vec3_t& v) const { return vec3_t(y*v.z-z*v.y, z*v.x-x*v.z, x*v.y-y*v.x);  } // Vector product
+  vec3_t operator!()                const { return normalize_(*this);          }    // Normalized vector
+  void operator+=(const vec3_t& v)        { x+=v.x;  y+=v.y;  z+=v.z;          }
+  void operator*=(T s)                    { x*=s;    y*=s;    z*=s;            }
 };
 
+typedef vec3_t<float> vec3;
+
+static inline vec3_t<float> normalize_(const vec3_t<float>& v)
+{
+  return v*rsqrtf_(v%v);
+}
+
+// Normalize with a power of two pre-scale (largest component in
+// [2, 4)), so that |v|^2 and 1/|v| (Q15) fit 32 and 16 bits
+static inline vec3_t<fixed> normalize_(const vec3_t<fixed>& v)
+{
+  int32_t x = v.x.v, y = v.y.v, z = v.z.v;
+  uint32_t m = x < 0 ? -x : x;
+  uint32_t t = y < 0 ? -y : y;  if (t > m) m = t;
+  t = z < 0 ? -z : z;  if (t > m) m = t;
+  if (m == 0) return v;
+  while (m >= 0x4000) { x >>= 1;  y >>= 1;  z >>= 1;  m >>= 1; }
+  while (m <  0x2000) { x <<= 1;  y <<= 1;  z <<= 1;  m <<= 1; }
+  const int16_t sx = x, sy = y, sz = z;
+  const uint32_t l2 = static_cast<int32_t>(sx)*sx + static_cast<int32_t>(sy)*sy + static_cast<int32_t>(sz)*sz;
+  const int16_t r = (static_cast<uint32_t>(1) << 27) / isqrt32_(l2);  // 1/|v| (Q15)
+  return vec3_t<fixed>(fixed::raw((static_cast<int32_t>(sx) * r) >> 15),
+    fixed::raw((static_cast<int32_t>(sy) * r) >> 15), fixed::raw((static_cast<int32_t>(sz) * r) >> 15));
+}
+
 // A ray...
-struct ray {
+template <typename T>
+struct ray_t {
   // This occupies 24 bytes - you could only fit 20 of these into
   // a Tiny85 even if you could use the entire RAM (which you can't...)
-  vec3 o;  // Origin
-  vec3 d;  // Direction
+  vec3_t<T> o;  // Origin
+  vec3_t<T> d;  // Direction
+};
+
+/*------------------------------------------------------------------------
+  Scene constants converted to the scalar type at compile time,
+  with the squared radius precomputed for the intersection test
+------------------------------------------------------------------------*/
+template <typename T>
+struct scene_t {
+  struct sphere { vec3_t<T> c; T r2; uint8_t mat; };
+  struct material { T r, g, b, reflect; };
+
+  static constexpr sphere sp(uint8_t i) {
+    return sphere { vec3_t<T>(T(spheres[i*5+0]), T(spheres[i*5+1]), T(spheres[i*5+2])),
+      T(spheres[i*5+3] * spheres[i*5+3]), static_cast<uint8_t>(spheres[i*5+4]) };
+  }
+  static constexpr material mt(uint8_t i) {
+    return material { T(materials[i*4+0]), T(materials[i*4+1]), T(materials[i*4+2]), T(materials[i*4+3]) };
+  }
 };
 
 /*------------------------------------------------------------------------
@@ -132,64 +299,66 @@ struct ray {
   Return 'FLOOR' if no hit was found but ray goes downward towards the floor
   Return a material index if a hit was found
 
-  Distance to the hit is returned in 'distance'. 
+  Distance to the hit is returned in 'distance'.
   The surface normal at the hit is returned in 'normal'
 ------------------------------------------------------------------------*/
 // Values for 'SKY' and 'FLOOR'
 static const uint8_t SKY=255;
 static const uint8_t FLOOR=254;
 
+template <typename T>
 __attribute__ ((section (".exttext")))
-uint8_t trace(const ray& r, float& distance, vec3& normal)
+uint8_t trace(const ray_t<T>& r, T& distance, vec3_t<T>& normal)
 {
+  static constexpr typename scene_t<T>::sphere sph[NUM_SPHERES] = {
+    scene_t<T>::sp(0), scene_t<T>::sp(1), scene_t<T>::sp(2), scene_t<T>::sp(3)
+  };
+  constexpr T eps(0.01f);
+  constexpr T zero(0);
+
   // Assume we didn't hit anything
   uint8_t result = SKY;
 
   // Does the ray go downwards?
-  float d = -r.o.z/r.d.z;
-  if (d > 0.01f) {
+  T d = zero;
+  if (r.d.z < zero) d = far_(-r.o.z/r.d.z);
+  if (d > eps) {
     // Yes, assume it hits the floor
-    result = true;
     distance = d;
     result = FLOOR;
-    normal = vec3(0,0,1);
+    normal = vec3_t<T>(zero, zero, T(1));
   }
 
   // Test the objects in the scene to see if there's anything in the way
   for (uint8_t i=0; i<NUM_SPHERES; ++i) {
-    vec3 oc = r.o;
-    // Read a sphere from progmem, calculate vector 'oc'
-    const float* n = spheres+(i*5);
-    oc.x -= *n++;
-    oc.y -= *n++;
-    oc.z -= *n++;
-    d = *n++;  // Radius
+    const vec3_t<T> oc = r.o - sph[i].c;
 
     // Ray-sphere intersection test
     // Math is here: http://en.wikipedia.org/wiki/Line%E2%80%93sphere_intersection
-    const float b = r.d%oc;        // I.(o-c)
-    const float c = (oc%oc)-(d*d); // (o-c).(o-c) - r^2
+    const T b = r.d%oc;             // I.(o-c)
+    const T c = (oc%oc)-sph[i].r2;  // (o-c).(o-c) - r^2
 
     // Does the ray hit the sphere?
     d = (b*b)-c;
-    if (d > 0) {
+    if (d > zero) {
       // Yes, compute the distance to the hit
       d = (-b)-sqrtf_(d);
 
       // Is it the closest hit so far?
-      if ((d > 0.01f) and ((result==SKY) or (d<distance))) {
+      if ((d > eps) and ((result==SKY) or (d<distance))) {
         // Yes, save results
         distance = d;
         normal = !(oc+r.d*d);
-        result = static_cast<uint8_t>(*n);  // The sphere's material
+        result = sph[i].mat;  // The sphere's material
       }
     }
   }
   return result;
 }
 
+template <typename T>
 __attribute__ ((section (".exttext")))
-float raise(float p, uint8_t n)
+T raise(T p, uint8_t n)
 {
   while (n--) {
     p = p*p;
@@ -199,181 +368,184 @@ float raise(float p, uint8_t n)
 
 /*----------------------------------------------------------
   Small, fast pseudo-random number generator
-  
+
   I found this in a forum and I'm not sure who originally
   wrote it. It works very well though....
- 
+
   If you wrote this then get in touch and I'll put
   your name here. :-)                              FTB.
 ----------------------------------------------------------*/
+struct rng_state { uint8_t a, b, c, x; };
+static rng_state rng_;
+
+// Restart the sequence, so that float and fixed frames use the same noise
+static inline void randomReset() { rng_ = rng_state { 0, 0, 0, 0 }; }
+
 __attribute__ ((section (".exttext")))
-uint8_t randomByte()
+inline uint8_t randomByte()
 {
-  static uint8_t rngA, rngB, rngC, rngX;
+  uint8_t& rngA = rng_.a;
+  uint8_t& rngB = rng_.b;
+  uint8_t& rngC = rng_.c;
+  uint8_t& rngX = rng_.x;
   ++rngX;                        // X is incremented every round and is not affected by any other variable
   rngA = (rngA ^ rngC ^ rngX);       // note the mix of addition and XOR
   rngB = (rngB + rngA);            // And the use of very few instructions
-  rngC = ((rngC + (rngB >> 1)) ^ rngA);  // the right shift is to ensure that high-order bits from B can affect  
+  rngC = ((rngC + (rngB >> 1)) ^ rngA);  // the right shift is to ensure that high-order bits from B can affect
   return rngC;
 }
 
-// A random float in the range [-0.5 ... 0.5]  (more or less)
-__attribute__ ((section (".exttext")))
-float randomFloat()
+// A random value in the range [-0.5 ... 0.5]  (more or less)
+static inline float randomScalar(float)
 {
-  char r = char(randomByte());
+  int8_t r = static_cast<int8_t>(randomByte());
   return float(r)/256.0f;
 }
-#define RF randomFloat()
-#define SH (RF*shadowRegion)
+
+static inline fixed randomScalar(fixed)
+{
+  int8_t r = static_cast<int8_t>(randomByte());
+  return fixed::raw(static_cast<int32_t>(r) << (fixed::FRAC - 8));
+}
 
 /*------------------------------------------------------------------------
   Sample the world and return the pixel color for a ray
 ------------------------------------------------------------------------*/
+template <typename T>
 __attribute__ ((section (".exttext")))
-float sample(ray& r, vec3& color)
+T sample(ray_t<T>& r, vec3_t<T>& color)
 {
+  const T zero(0);
+
   // See if the ray hits anything in the world
-  float t;  vec3& n = color;      // RAM is tight, use 'color' as temp workspace
+  T t;  vec3_t<T>& n = color;      // RAM is tight, use 'color' as temp workspace
   const uint8_t hit = trace(r,t,n);
 
   // Did we hit anything
   if (hit == SKY) {
     // Generate a sky color if the ray goes upwards without hitting anything
-    color = vec3(0.1f,0.0f,0.3f) + vec3(.7f,.2f,0.5f)*raise(1.0-r.d.z,2);
-    return 0.0f;
+    color = vec3_t<T>(T(0.1f),zero,T(0.3f)) + vec3_t<T>(T(.7f),T(.2f),T(0.5f))*raise(T(1)-r.d.z,2);
+    return zero;
   }
 
   // New ray origin
   r.o += r.d*t;
 
   // Half vector
-  const vec3 half = !(r.d+n*((n%r.d)*-2));
+  const vec3_t<T> half = !(r.d+n*((n%r.d)*T(-2)));
 
-// Vector that points towards the light
-  r.d = vec3(9+SH, 6+SH,16); // Where the light is
+  // Vector that points towards the light
+  const T sh(shadowRegion);
+  r.d = vec3_t<T>(T(9)+randomScalar(zero)*sh, T(6)+randomScalar(zero)*sh, T(16)); // Where the light is
   r.d = !(r.d-r.o);          // Normalized light vector
 
   // Lambertian factor
-  float d = r.d%n;    // Light vector % surface normal
+  T d = r.d%n;    // Light vector % surface normal
 
   // See if we're in shadow
-  if ((d<0) or (trace(r,t,n)!=SKY)) {
-    d = 0;
+  if ((d<zero) or (trace(r,t,n)!=SKY)) {
+    d = zero;
   }
 
   // Did we hit the floor?
   if (hit == FLOOR) {
     // Yes, generate a floor color
-    d=(d*0.2f)+0.1f;   t=d*3.0f;  // d=dark, t=light
-    color = vec3(t,t,t);       // Assume grey color
-    t = 1.0f/5.0f;     // Floor tiles are 5m across
-//    int fx = int(ceil(r.o.x*t));
-//    int fy = int(ceil(r.o.y*t));
-//    bool dark = ((fx+fy)&1)!=0;  // Light or dark color?
-    bool dark = (((int)(ceilf_(r.o.x*t)+ceilf_(r.o.y*t)))&1);  // Light or dark color? -> fix for AVR compiler
+    d=(d*T(0.2f))+T(0.1f);   t=d*T(3);  // d=dark, t=light
+    color = vec3_t<T>(t,t,t);       // Assume grey color
+    t = T(1.0f/5.0f);     // Floor tiles are 5m across
+    bool dark = ((ceilf_(r.o.x*t)+ceilf_(r.o.y*t))&1);  // Light or dark color?
     if (dark) { color.y = color.z = d; }        // g+b => dark => 'red'
-    return 0;
+    return zero;
   }
 
-  // No, we hit the scene, read material color from progmem
-  const float* mat = materials+(hit*4);
-  color.x = *mat++;
-  color.y = *mat++;
-  color.z = *mat++;
- 
+  // No, we hit the scene, read material color
+  static constexpr typename scene_t<T>::material mats[] = {
+    scene_t<T>::mt(0), scene_t<T>::mt(1), scene_t<T>::mt(2)
+  };
+  const typename scene_t<T>::material& mat = mats[hit];
+  color.x = mat.r;
+  color.y = mat.g;
+  color.z = mat.b;
+
   // Specular light in 't'
   t = d;
-  if (t > 0) {
+  if (t > zero) {
     t = raise(r.d%half,5);
   }
 
   // Calculate total color using diffuse and specular components
-  color *= d*d+ambient;  // Ambient+diffuse
-  color += vec3(t,t,t);  // Specular
+  color *= d*d+T(ambient);  // Ambient+diffuse
+  color += vec3_t<T>(t,t,t);  // Specular
 
   // We need to trace a reflection ray...need to modify 'r' for the recursion
   r.d = half;
-  return *mat;    // Reflectivity of this material
+  return mat.reflect;    // Reflectivity of this material
 }
 
 /*------------------------------------------------------------------------
   Raytrace the entire image
+  (T = float: reference, T = fixed: integer only)
 ------------------------------------------------------------------------*/
+template <typename T>
 __attribute__ ((section (".exttext")))
 void doRaytrace(int raysPerPixel = 4, int dw = 320, int dh = 240, int q = 1)
 {
+  const T zero(0);
+
+  randomReset();
+
   // Trace it
   int dw2=dw/2;;
   int dh2=dh/2;
-  const float pixel =  fov/float(dh2);    // Size of one pixel on screen
 
   // Position/target of camera
-  const vec3 camera = vec3(cameraX,cameraY,cameraZ);
-  const vec3 target = vec3(targetX,targetY,targetZ);
-  
-  auto t = millis();
+  const vec3_t<T> camera = vec3_t<T>(T(cameraX),T(cameraY),T(cameraZ));
+  const vec3_t<T> target = vec3_t<T>(T(targetX),T(targetY),T(targetZ));
+
+  // The camera frame is the same for every ray
+  // (the forward vector is scaled by 1/pixel size instead of scaling
+  //  'right' and 'up' by the tiny pixel size, which Q20.12 can't hold)
+  const vec3_t<T> dir = !(target-camera);
+  const vec3_t<T> right = !(dir^vec3_t<T>(zero,zero,T(1)));
+  const vec3_t<T> up = !(right^dir);
+  const vec3_t<T> fwd = dir*(T(dh2)/T(fov));
 
   for (int y=0; y<dh; y+=q) {
     for (int x=0; x<dw; x+=q) {
-      vec3 acc(0,0,0);     // Color accumulator
+      vec3_t<T> acc(zero,zero,zero);     // Color accumulator
       for (int p=raysPerPixel; p--;) {
-        ray r;  vec3 temp;
-        float xpos = float(x-dw2), ypos=float(dh2-y);
-        if (raysPerPixel>1) { xpos+=RF; ypos+=RF; }       // Stochastic antialiasing when RPP > 1
+        ray_t<T> r;  vec3_t<T> temp;
+        T xpos = T(x-dw2), ypos=T(dh2-y);
+        if (raysPerPixel>1) { xpos+=randomScalar(zero); ypos+=randomScalar(zero); }       // Stochastic antialiasing when RPP > 1
 
         // Calculate a ray through this pixel
-        temp = !(target-camera);
-        vec3& right = r.o;   right = !(temp^vec3(0,0,1));
-        vec3& up = r.d;      up = !(right^temp);
-        r.d = !(temp + ((right*xpos)+(up*ypos))*pixel);  // Ray direction
+        r.d = !(fwd + (right*xpos)+(up*ypos));  // Ray direction
         r.o = camera;                                    // Ray starts at the camera
-        
+
         // Sample the world, accumulate the color returned
-        vec3& color = temp;
-        float reflect1 = sample(r,color);
+        vec3_t<T>& color = temp;
+        T reflect1 = sample(r,color);
         acc += color;
         // 'sample()' would normally be recursive but there's not enough RAM to do that on a Tiny85...
-        if (reflect1 > 0) {
+        if (reflect1 > zero) {
           // ...so we do the 'recursion' manually
-          float reflect2 = sample(r,color);
+          T reflect2 = sample(r,color);
           acc += color*reflect1;
-          if (reflect2 > 0) {
+          if (reflect2 > zero) {
             // ...3 levels deep
             sample(r,color);
             acc += color*(reflect1*reflect2);
           }
         }
       }
-#ifndef NO_DRAW      
+#ifndef NO_DRAW
       // Output the pixel
-      acc = acc*(255.0f/float(raysPerPixel));
-      int r = acc.x;    if (r>255) { r=255; }
-      int g = acc.y;    if (g>255) { g=255; }
-      int b = acc.z;    if (b>255) { b=255; }
+      acc = acc*(T(255)/T(raysPerPixel));
+      int r = static_cast<int>(acc.x);    if (r>255) { r=255; } else if (r<0) { r=0; }
+      int g = static_cast<int>(acc.y);    if (g>255) { g=255; } else if (g<0) { g=0; }
+      int b = static_cast<int>(acc.z);    if (b>255) { b=255; } else if (b<0) { b=0; }
 	  draw_pixel(x, y, r, g, b);
 #endif
-///      if(q==1) display.drawPixel(x, y, RGBTO565(r,g,b));
-///      else display.fillRect(x, y, q, q, RGBTO565(r,g,b));
     }
-// workaround for ESP8266 which reboots after staying too long in the loops (WTF-watchdog?)
-// #ifdef ESP8266
-//    delay(1);
-// #endif
-#ifndef NO_DRAW
-#if 0
-    char buf[50];
-	auto tm = (millis() - t) / 100;
-///    snprintf(buf,100,"%3d%% %3ds", (y+q)*100/dh, (millis()-t)/1000);
-	utils::sformat("%3d%% %3d.%ds", buf, sizeof(buf)) % ((y+q)*100/dh) % (tm / 10) % (t % 10);
-///    display.setCursor(8,0);
-///    display.println(buf);
-	draw_text(8, 0, buf);
-#endif
-#endif
-  }
-  {
-//	auto tm = (millis() - t) / 100;
-//	utils::format("Render time: %3d.%ds\n") % (tm / 10) % (t % 10);
   }
 }
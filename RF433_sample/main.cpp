@@ -27,36 +27,38 @@ namespace {
 	// P1_1(19):
 	typedef device::PORT<device::PORT1, device::bitpos::B1> RF_RX;
 
+	// スロット 1000Hz（500 bps）、受信は８倍のオーバーサンプル
+	static const uint16_t SLOT_FREQ = 1000;
+	static const uint8_t RX_OVS = 8;
+
 	typedef chip::TX_MOD<RF_TX> TX;
-	typedef chip::RX_MOD<RF_RX> RX;
+	typedef chip::RX_MOD<RF_RX, 4, 4, RX_OVS> RX;
 
 	class rf_task {
 
 		TX		tx_;
 		RX		rx_;
 
-		bool	flag_;
-
-		volatile uint8_t	recv_;
+		uint8_t	div_;
 
 	public:
-		rf_task() : flag_(0), recv_(0) {
-			RF_TX::DIR = 1;  // out
-			RF_RX::DIR = 0;  // inp
-		}
-
-		void task() {
-			RF_TX::P = flag_;
-			flag_ = !flag_;
+		rf_task() : div_(0) { }
 
-			recv_ <<= 1;
-			if(RF_RX::P()) ++recv_;
+		void start() {
+			tx_.start();
+			rx_.start();
 		}
 
-		uint8_t get() const { return recv_; }
+		TX& at_tx() { return tx_; }
+		RX& at_rx() { return rx_; }
 
 		void operator() () {
-			task();
+			rx_.service();
+			++div_;
+			if(div_ >= RX_OVS) {
+				div_ = 0;
+				tx_.service();
+			}
 		}
 	};
 
@@ -126,8 +128,9 @@ int main(int argc, char *argv[])
 	// タイマーＢ初期化
 	// ※無線データ変調で利用するので、優先順位は最大にする。
 	{
+		TRB::task_.start();
 		uint8_t ir_level = 2;
-		trb_.start(2000, ir_level);
+		trb_.start(SLOT_FREQ * RX_OVS, ir_level);
 	}
 
 	// UART の設定 (P1_4: TXD0[out], P1_5: RXD0[in])
@@ -144,15 +147,30 @@ int main(int argc, char *argv[])
 	using namespace utils;
 
 	uint16_t cnt = 0;
-
+	uint8_t seq = 0;
 	while(1) {
 		trb_.sync();
 
+		// 0.25 秒毎に送信
 		++cnt;
-		if(cnt >= 500) {
-			uint8_t d = TRB::task_.get();
-			utils::format("%02X\n") % static_cast<uint32_t>(d);
+		if(cnt >= (SLOT_FREQ * RX_OVS / 4)) {
 			cnt = 0;
+			uint8_t d[4] = { seq, 0x55, 0xAA, 0x00 };
+			if(TRB::task_.at_tx().send(d, sizeof(d))) {
+				++seq;
+			}
+		}
+
+		auto& rx = TRB::task_.at_rx();
+		if(rx.probe()) {
+			uint8_t d[4];
+			auto n = rx.get(d);
+			utils::format("Recv(%d):") % static_cast<uint16_t>(n);
+			for(uint8_t i = 0; i < n; ++i) {
+				utils::format(" %02X") % static_cast<uint16_t>(d[i]);
+			}
+			utils::format(" (error: %u, lost: %u)\n")
+				% rx.get_error_count() % rx.get_lost_count();
 		}
 	}
 }
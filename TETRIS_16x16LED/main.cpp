@@ -38,6 +38,7 @@
 #include "common/uart_io.hpp"
 #include "common/format.hpp"
 #include "common/trb_io.hpp"
+#include "common/scheduler.hpp"
 #include "common/spi_io.hpp"
 #include "chip/MAX7219.hpp"
 #include "common/monograph.hpp"
@@ -119,6 +120,18 @@ namespace {
 
 	typedef app::tetris<MONOG> TETRIS;
 	TETRIS	tetris_(monog_);
+
+	typedef utils::scheduler<TIMER_B, 2> SCHEDULER;
+	SCHEDULER	scheduler_(timer_b_);
+
+	// ゲームの更新と表示（60Hz）
+	void game_task_()
+	{
+		monog_.clear(0);
+		tetris_.service();
+
+		max7219_.service();
+	}
 }
 
 extern "C" {
@@ -212,12 +225,6 @@ int main(int argc, char *argv[])
 
 	tetris_.init();
 
-	while(1) {
-		timer_b_.sync();
-
-		monog_.clear(0);
-		tetris_.service();
-
-		max7219_.service();
-	}
+	scheduler_.add(game_task_, 1);
+	scheduler_.run();
 }
@@ -142,7 +142,11 @@ int main(int argc, char *argv[])
 					% static_cast<uint16_t>(((v + 1) * VCC) / (1024 * 10 / 256))
 					% v;
 
-				utils::format("温度： %5.2f [度]\n") % thmister_(v);
+				// 0.01 度単位の整数
+				int16_t t = thmister_(v);
+				char sign = ' ';
+				if(t < 0) { sign = '-'; t = -t; }
+				utils::format("温度： %c%d.%02d [度]\n") % sign % (t / 100) % (t % 100);
 			}
 
 			++nnn;
@@ -1,7 +1,12 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	チェッカー・クラス
+	@brief	チェッカー・クラス @n
+			電流、電圧は、タイマーＢ割り込み内で SAMPLE_RATE 毎に A/D 変換し、@n
+			電力量（mWh）、電荷量（mAh）を整数で積算する。@n
+			表示は、画面（128x48）の半分のフレームバッファを共有し、テキストは変化した文字だけ、@n
+			グラフは記録毎にその範囲だけを描き直し、描いた範囲だけを LCD へ転送する。@n
+			※RAM が足りないので、グラフは列のスクロールでは無く、範囲全体を描き直す。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -25,36 +30,145 @@ namespace app {
 
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
     /*!
-        @brief  タイマーＢ、割り込みタスク
+        @brief  タイマーＢ、割り込みタスク @n
+				AN0（電流）、AN1（電圧）を SAMPLE_RATE でサンプリングし、@n
+				フレーム（FRAME_RATE）毎に AN2、AN3（USB D-, D+）を変換する。@n
+				・電流 [mA] = i * 2750 / 1023 @n
+				・電圧 [mV] = v * 19800 / 1023 @n
+				・電力 [mW] = i * v * 50 / 961 @n
+				の関係から、電力量、電荷量は、剰余を持ち越す整数積算で誤差無く求める。
     */
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	class trb_task {
+	public:
+		static const uint16_t SAMPLE_RATE = 1000;	///< A/D サンプリング周波数
+		static const uint8_t  FRAME_RATE  = 50;		///< フレーム周波数
+		static const uint8_t  FRAME_SUB   = SAMPLE_RATE / FRAME_RATE;	///< フレーム当たりのサンプル数
+
+		/// 1mWh 当たりの「i * v」積算値（3600 * 961 * SAMPLE_RATE / 50）
+		static const uint32_t E_UNIT = 961UL * 72 * SAMPLE_RATE;
+		/// 1mAh 当たりの「i * 5」積算値（3600 * 1023 * SAMPLE_RATE / 550）
+		static const uint32_t Q_UNIT = 6696UL * SAMPLE_RATE;
+
+		static_assert((SAMPLE_RATE % FRAME_RATE) == 0, "FRAME_RATE must divide SAMPLE_RATE");
+		static_assert((E_UNIT % 100) == 0 && (Q_UNIT % 1000) == 0, "E_UNIT/Q_UNIT fraction digits");
+
+		enum class type : uint8_t {
+			SW_A = 0x20,	///< SW-A
+			SW_B = 0x10		///< SW-B
+		};
+
+		/// フレーム毎の積算値
+		struct frame_t {
+			uint16_t	sum_i;	///< 電流 A/D 値の合計（FRAME_SUB 個）
+			uint16_t	sum_v;	///< 電圧 A/D 値の合計（FRAME_SUB 個）
+			uint32_t	sum_p;	///< 「i * v」の合計（FRAME_SUB 個）
+			uint16_t	usb_m;	///< USB D- の A/D 値
+			uint16_t	usb_p;	///< USB D+ の A/D 値
+		};
+
+		/// 電力量、電荷量
+		struct accum_t {
+			uint32_t	mwh;	///< 電力量 [mWh]
+			uint32_t	e_acc;	///< 電力量の端数（0 to E_UNIT-1）
+			uint32_t	mah;	///< 電荷量 [mAh]
+			uint32_t	q_acc;	///< 電荷量の端数（0 to Q_UNIT-1）
+		};
+
+	private:
+		typedef device::adc_io<utils::null_task> ADC;
+		ADC			adc_;
+
 		uint32_t	time_;
 		uint8_t		val_;
 		uint8_t		lvl_;
 		uint8_t		pos_;
 		uint8_t		neg_;
 
-	public:
-		enum class type : uint8_t {
-			SW_A = 0x20,	///< SW-A
-			SW_B = 0x10		///< SW-B
-		};
+		uint8_t		sub_;
+		bool		usb_;
+		uint16_t	i_;
+		uint16_t	v_;
+
+		uint16_t	sum_i_;
+		uint16_t	sum_v_;
+		uint32_t	sum_p_;
+
+		frame_t		frame_;
+		accum_t		acc_;
+
+		volatile uint8_t	frame_cnt_;
 
-		trb_task() : time_(0), val_(0), lvl_(0), pos_(0), neg_(0) { }
+		void start_scan_() {
+			adc_.start(ADC::CH_TYPE::CH0_CH1, usb_ ? ADC::CH_GROUP::AN2_AN3 : ADC::CH_GROUP::AN0_AN1, false);
+			adc_.scan();
+		}
+
+	public:
+		trb_task() : adc_(), time_(0), val_(0), lvl_(0), pos_(0), neg_(0),
+			sub_(0), usb_(false), i_(0), v_(0), sum_i_(0), sum_v_(0), sum_p_(0),
+			frame_{ 0 }, acc_{ 0 }, frame_cnt_(0) { }
 
-		void init() const {
+		void init() {
 			utils::PORT_MAP(utils::port_map::P34::PORT);
 			utils::PORT_MAP(utils::port_map::P35::PORT);
 			device::PD3.B4 = 0;
 			device::PD3.B5 = 0;
 			device::PUR3.B4 = 1;	///< プルアップ
 			device::PUR3.B5 = 1;	///< プルアップ
+
+			utils::PORT_MAP(utils::port_map::P10::AN0);
+			utils::PORT_MAP(utils::port_map::P11::AN1);
+			utils::PORT_MAP(utils::port_map::P12::AN2);
+			utils::PORT_MAP(utils::port_map::P13::AN3);
+			start_scan_();
 		}
 
 		void operator() () {
 			++time_;
-			val_ = ~device::P3();
+
+			// 前回開始した A/D 変換の結果（変換時間は、サンプリング周期より十分短い）
+			if(usb_) {
+				// USB 信号電圧の変換中は、電流、電圧を前値保持とする
+				frame_.usb_m = adc_.get_value(0);
+				frame_.usb_p = adc_.get_value(1);
+			} else {
+				i_ = adc_.get_value(0);
+				v_ = adc_.get_value(1);
+				if(i_ <= 3) i_ = 0;  // noise bias
+			}
+
+			++sub_;
+			if(sub_ >= FRAME_SUB) sub_ = 0;
+			usb_ = (sub_ == (FRAME_SUB - 1));
+			start_scan_();
+
+			uint32_t p = static_cast<uint32_t>(i_) * v_;
+			sum_i_ += i_;
+			sum_v_ += v_;
+			sum_p_ += p;
+
+			acc_.e_acc += p;
+			if(acc_.e_acc >= E_UNIT) {
+				acc_.e_acc -= E_UNIT;
+				++acc_.mwh;
+			}
+			acc_.q_acc += i_ * 5;
+			if(acc_.q_acc >= Q_UNIT) {
+				acc_.q_acc -= Q_UNIT;
+				++acc_.mah;
+			}
+
+			if(sub_ == 0) {
+				frame_.sum_i = sum_i_;
+				frame_.sum_v = sum_v_;
+				frame_.sum_p = sum_p_;
+				sum_i_ = 0;
+				sum_v_ = 0;
+				sum_p_ = 0;
+				val_ = ~device::P3();
+				++frame_cnt_;
+			}
 		}
 
 		void service()
@@ -68,9 +182,50 @@ namespace app {
 		bool positive(type t) const { return pos_ & static_cast<uint8_t>(t); }
 		bool negative(type t) const { return neg_ & static_cast<uint8_t>(t); }
 
-		void set_time(uint32_t v) { time_ = v; }
 
-		uint32_t get_time() const { return time_; }
+		//-------------------------------------------------------------//
+		/*!
+			@brief  フレーム・カウンターの取得
+			@return フレーム・カウンター（FRAME_RATE で進む）
+		*/
+		//-------------------------------------------------------------//
+		uint8_t get_frame() const { return frame_cnt_; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief  最新フレームの積算値を取得
+			@param[out]	f	積算値
+		*/
+		//-------------------------------------------------------------//
+		void get_frame_sum(frame_t& f) const { di(); f = frame_; ei(); }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief  電力量、電荷量を取得
+			@param[out]	a	電力量、電荷量
+		*/
+		//-------------------------------------------------------------//
+		void get_accum(accum_t& a) const { di(); a = acc_; ei(); }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief  経過時間、電力量、電荷量をリセット
+		*/
+		//-------------------------------------------------------------//
+		void reset_accum()
+		{
+			di();
+			time_ = 0;
+			acc_ = accum_t{ 0 };
+			ei();
+		}
+
+		void set_time(uint32_t v) { di(); time_ = v; ei(); }
+
+		uint32_t get_time() const { di(); auto t = time_; ei(); return t; }
 	};
 
 
@@ -92,9 +247,6 @@ namespace app {
 #endif
 
 	private:
-		typedef device::adc_io<utils::null_task> ADC;
-		ADC		adc_;
-
 		// LCD SCL: P4_2(1)
 		typedef device::PORT<device::PORT4, device::bitpos::B2> SPI_SCL;
 		// LCD SDA: P4_5(12)
@@ -119,8 +271,8 @@ namespace app {
 			typedef int16_t value_type;
 
 			static const int16_t WIDTH  = 128;
-			static const int16_t HEIGHT = 24;
-			static const int8_t PAGE_NUM = 2;
+			static const int16_t HEIGHT = 24;	///< 画面の半分
+			static const bool PAGE_LAYOUT = true;	///< ページ構成のフレームバッファ
 
 		private:
 			uint8_t		fb_[WIDTH * HEIGHT / 8];
@@ -131,7 +283,7 @@ namespace app {
 				for(uint16_t i = 0; i < (WIDTH * HEIGHT / 8); ++i) {
 					fb_[i] = v;
 				}
-			} 
+			}
 
 			uint8_t* fb() { return fb_; }
 
@@ -139,9 +291,9 @@ namespace app {
 			{
 				if(x < 0 || x >= WIDTH) return;
 				if(y < 0 || y >= HEIGHT) return;
-
-				if(val) { fb_[(x >> 3) * y] |= 1 << (x & 7); }
-				else { fb_[(x >> 3) * y] &= ~(1 << (x & 7)); }
+				uint8_t& d = fb_[(y >> 3) * WIDTH + x];
+				if(val) d |= 1 << (y & 7);
+				else d &= ~(1 << (y & 7));
 			}
 		};
 
@@ -150,19 +302,27 @@ namespace app {
 		graphics::monograph<PLOT, afont> bitmap_;
 		graphics::kfont_null kfont_;
 
-		uint8_t		loop_;
-		uint8_t		page_;
+		static const uint8_t DISP_FRAMES = 5;	///< 数値表示の更新間隔（フレーム数）
+		static const uint8_t TEXT_NUM = 14;		///< 表示テキストの最大文字数（終端含む）
+		static const uint8_t PAGE_NUM = PLOT::HEIGHT / 8;	///< 半分のページ数
 
-		float		volt_;
-		float		current_;
-		float		watt_;
+		uint8_t		frame_;
+		uint8_t		disp_cnt_;
+		uint32_t	disp_i_;
+		uint32_t	disp_v_;
 
-		char		str_[32];
+		uint16_t	volt_;		///< 電圧 [mV]
+		uint16_t	current_;	///< 電流 [mA]
+		uint16_t	usb_m_;		///< USB D- [mV]
+		uint16_t	usb_p_;		///< USB D+ [mV]
+
+		char		str_[16];
+		char		text_[2][TEXT_NUM];	///< 表示中のテキスト（上段、下段）
 
 		enum class TASK : uint8_t {
 			MAIN,		///< 電圧、電流、表示
-			WATT_M,		///< 時間、電力(分）、表示
-			WATT_H,		///< 時間、電力(時）、表示
+			CHARGE,		///< 時間、電荷量(mAh）、表示
+			WATT_H,		///< 時間、電力量(Wh）、表示
 			GRAPH,		///< グラフ表示
 			USB_REF,	///< USB D-, D+ 差動信号電圧表示
 			SETUP,		///< 設定
@@ -171,35 +331,124 @@ namespace app {
 		};
 
 		TASK		task_;
+		bool		redraw_;
+
+		uint8_t		full_;		///< 全体の描画が必要な半分（bit0: 上、bit1: 下）
+		uint8_t		dirty_;		///< グラフの描画が必要な半分（bit0: 上、bit1: 下）
+		uint8_t		half_;		///< 次に描画する半分
+		uint8_t		graph_o_;	///< グラフの表示オフセット
+		uint8_t		graph_w_;	///< グラフの表示範囲（０なら表示しない）
 
 		uint8_t		log_;
 		uint8_t		log_itv_;
+		uint8_t		log_n_;
+		uint32_t	log_p_;
 		uint8_t		gain_idx_;
 		uint8_t		interval_;
 
-		float		usb_m_;
-		float		usb_p_;
-
 #ifdef UART
 		uint8_t		list_cnt_;
 #endif
 
 		uint8_t		buff_[128];
 
+
+		// 固定ピッチで、変化した文字だけを描画して転送（半分全体を描く場合は描かない） @n
+		// 文字の下のページの残り（フォントの高さから８の倍数まで）も消す
+		void text_line_(uint8_t line, const char* str)
+		{
+			char* t = text_[line];
+			bool draw = (full_ & (1 << line)) == 0;
+			int16_t x = 0;
+			char ch = 0;
+			for(uint8_t i = 0; i < (TEXT_NUM - 1); ++i) {
+				if(i == 0 || ch != 0) ch = str[i];
+				if(t[i] != ch) {
+					if(draw) {
+						bitmap_.fill(x, 0, afont::WIDTH, (afont::HEIGHT + 7) & ~7, false);
+						if(ch != 0) bitmap_.draw_font(x, 0, ch);
+					}
+					t[i] = ch;
+				}
+				x += afont::WIDTH;
+			}
+			if(draw) lcd_.flush_dirty(bitmap_, line * PAGE_NUM);
+		}
+
+
+		int16_t gain_() const
+		{
+			static const int8_t gain_tbl[] = { 1, 2, 3, 4, 6, 8, 12, 16 };
+			return gain_tbl[gain_idx_];
+		}
+
+
+		int16_t graph_y_(uint8_t v) const
+		{
+			return (PLOT::HEIGHT * 2 - 1) - static_cast<int16_t>(v) * 3 / gain_();
+		}
+
+
+		// 一つ前の値から pos の値までを、縦線で結ぶ（link が false なら点だけ）
+		void graph_column_(int16_t x, int16_t ofs, uint8_t pos, bool link)
+		{
+			int16_t y1 = graph_y_(buff_[pos & 127]) - ofs;
+			int16_t y0 = link ? graph_y_(buff_[(pos - 1) & 127]) - ofs : y1;
+			if(y0 > y1) { auto t = y0; y0 = y1; y1 = t; }
+			bitmap_.fill(x, y0, 1, y1 - y0 + 1, true);
+		}
+
+
+		void graph_bar_(uint8_t o, uint8_t w)
+		{
+			int16_t v = w - gain_() * w / 16;
+			bitmap_.fill(o, 0, w, 2, false);
+			if(v > 0) bitmap_.fill(o, 0, v, 2, true);
+		}
+
+
+		// 描画が必要な半分を、フレーム毎に一つ描画して転送する @n
+		// 全体（テキストとグラフ）、又はグラフの範囲だけ
+		void render_()
+		{
+			uint8_t req = full_ | dirty_;
+			if(req == 0) return;
+			if((req & (1 << half_)) == 0) half_ ^= 1;
+			uint8_t h = half_;
+			half_ ^= 1;
+			uint8_t m = 1 << h;
+
+			if(full_ & m) {
+				bitmap_.clear(0);
+				bitmap_.draw_text(0, 0, text_[h]);
+				if(graph_w_ != 0) graph(h);
+				bitmap_.mark_dirty(0, 0, PLOT::WIDTH, PLOT::HEIGHT);
+			} else {
+				bitmap_.reset_dirty();
+				graph(h);
+			}
+			full_ &= ~m;
+			dirty_ &= ~m;
+			lcd_.flush_dirty(bitmap_, h * PAGE_NUM);
+		}
+
 	public:
         //-------------------------------------------------------------//
         /*!
             @brief  コンストラクター
         */
         //-------------------------------------------------------------//
-		checker() : lcd_(spi_), bitmap_(kfont_), loop_(0), page_(0),
-					volt_(0.0f), current_(0.0f), watt_(0.0f),
-					task_(TASK::MAIN),
-					log_(0), log_itv_(0), gain_idx_(0), interval_(12),
-					usb_m_(0.0f), usb_p_(0.0f)
+		checker() : lcd_(spi_), bitmap_(kfont_), frame_(0),
+					disp_cnt_(0), disp_i_(0), disp_v_(0),
+					volt_(0), current_(0), usb_m_(0), usb_p_(0),
+					text_{ { 0 } },
+					task_(TASK::MAIN), redraw_(true),
+					full_(0), dirty_(0), half_(0), graph_o_(0), graph_w_(0),
+					log_(0), log_itv_(0), log_n_(0), log_p_(0), gain_idx_(0), interval_(12),
 #ifdef UART
-					, list_cnt_(0)
+					list_cnt_(0),
 #endif
+					buff_{ 0 }
 			{ }
 
 
@@ -210,11 +459,11 @@ namespace app {
         //-------------------------------------------------------------//
 		void init()
 		{
-			// タイマーＢ初期化
+			// タイマーＢ初期化（A/D 変換の設定を含む）
 			{
 		   		timer_b::task_.init();
 				uint8_t ir_level = 2;
-				timer_b_.start(50, ir_level);
+				timer_b_.start(trb_task::SAMPLE_RATE, ir_level);
 			}
 #ifdef UART
 			// UART の設定 (P1_4: TXD0[out], P1_5: RXD0[in])
@@ -227,14 +476,6 @@ namespace app {
 			}
 #endif
 
-			// ADC の設定
-			{
-				utils::PORT_MAP(utils::port_map::P10::AN0);
-				utils::PORT_MAP(utils::port_map::P11::AN1);
-				utils::PORT_MAP(utils::port_map::P12::AN2);
-				utils::PORT_MAP(utils::port_map::P13::AN3);
-			}
-
 			// SPI を開始
 			{
 				spi_.start(10000000);
@@ -248,6 +489,8 @@ namespace app {
 ///				bitmap_.enable_2x();
 			}
 
+			frame_ = timer_b::task_.get_frame();
+
 #ifdef UART
 			utils::format("Start USB Checker\n");
 #endif
@@ -262,77 +505,57 @@ namespace app {
 		void vc()
 		{
 			// 400mV/A * 3
-			if(page_ == 0) {
-				utils::sformat("%3.2fV", str_, sizeof(str_)) % volt_;
-				bitmap_.draw_text(0, 0, str_);
-			} else {
-				utils::sformat("%3.2fA", str_, sizeof(str_)) % current_;
-				bitmap_.draw_text(0, 0, str_);
-			}
+			utils::sformat("%d.%02dV", str_, sizeof(str_)) % (volt_ / 1000) % ((volt_ % 1000) / 10);
+			text_line_(0, str_);
+			utils::sformat("%d.%02dA", str_, sizeof(str_)) % (current_ / 1000) % ((current_ % 1000) / 10);
+			text_line_(1, str_);
 		}
 
 
         //-------------------------------------------------------------//
         /*!
-            @brief  経過時間、電力
-			@param[in]	ch		表示単位
-			@param[in]	wdiv	積算電力の母数
+            @brief  経過時間、積算値（電荷量、電力量）
+			@param[in]	wh	電力量の場合「true」、電荷量の場合「false」
         */
         //-------------------------------------------------------------//
-		void watt(const char* form, float watt)
+		void accum(bool wh)
 		{
-			if(page_ == 0) {
-				auto s = timer_b::task_.get_time() / 50;
-				auto m = s / 60;
-				auto h = m / 60;
-				utils::sformat("%02d:%02d:%02d", str_, sizeof(str_)) % (h % 24) % (m % 60) % (s % 60);
-				bitmap_.draw_text(0, 0, str_);
+			auto s = timer_b::task_.get_time() / trb_task::SAMPLE_RATE;
+			auto m = s / 60;
+			auto h = m / 60;
+			utils::sformat("%02d:%02d:%02d", str_, sizeof(str_)) % (h % 24) % (m % 60) % (s % 60);
+			text_line_(0, str_);
+
+			trb_task::accum_t a;
+			timer_b::task_.get_accum(a);
+			if(wh) {
+				uint32_t f = (a.mwh % 1000) * 100 + a.e_acc / (trb_task::E_UNIT / 100);
+				utils::sformat("%d.%05dWh", str_, sizeof(str_)) % (a.mwh / 1000) % f;
 			} else {
-				utils::sformat(form, str_, sizeof(str_)) % watt;
-				bitmap_.draw_text(0, 0, str_);
+				uint32_t f = a.q_acc / (trb_task::Q_UNIT / 1000);
+				utils::sformat("%d.%03dmAh", str_, sizeof(str_)) % a.mah % f;
 			}
+			text_line_(1, str_);
 		}
 
 
         //-------------------------------------------------------------//
         /*!
-            @brief  グラフ表示
-			@param[in]	o	表示オフセット
-			@param[in]	w	表示範囲
+            @brief  グラフ表示（graph_o_、graph_w_ の範囲の半分を消して描画）
+			@param[in]	h	上（０）、下（１）
         */
         //-------------------------------------------------------------//
-		void graph(uint8_t o = 0, uint8_t w = 127)
+		void graph(uint8_t h)
 		{
-			static const int8_t gain_tbl[] = { 1, 2, 3, 4, 6, 8, 12, 16 };
-			int16_t gain = gain_tbl[gain_idx_];
-			if(page_ == 0) {
- 				int16_t v = w - gain * w / 16;
-				bitmap_.line(o, 0, o + v, 0, true);
-				bitmap_.line(o, 1, o + v, 1, true);
-			}
-
-			uint8_t pos = log_ - w - 1;
-			pos &= 127;
-			int16_t v0 = static_cast<int16_t>(buff_[pos]);
-			v0 *= 3;
-			v0 /= gain;
-			for(uint8_t x = 0; x < w; ++x) {
+			int16_t ofs = h * PLOT::HEIGHT;
+			bitmap_.fill(graph_o_, 0, graph_w_, PLOT::HEIGHT, false);
+			uint8_t pos = log_ - graph_w_;
+			for(uint8_t x = 0; x < graph_w_; ++x) {
+				// 全幅の場合、左端の一つ前は最新値になるので結ばない
+				graph_column_(graph_o_ + x, ofs, pos, x > 0 || graph_w_ < 128);
 				++pos;
-				pos &= 127;
-				int16_t y0 = 47 - v0;
-				int16_t v1 = static_cast<int16_t>(buff_[pos]);
-				v1 *= 3;
-				v1 /= gain;
-				int16_t y1 = 47 - v1;
-				if(page_) {
-					y0 -= 24;
-					y1 -= 24;
-				}
-				int16_t x0 = static_cast<int16_t>(x) + o;
-				int16_t x1 = x0 + 1;
-				bitmap_.line(x0, y0, x1, y1, true);
-				v0 = v1;
 			}
+			if(h == 0) graph_bar_(graph_o_, graph_w_);
 		}
 
 
@@ -343,13 +566,10 @@ namespace app {
         //-------------------------------------------------------------//
 		void usb_ref()
 		{
-			if(page_ == 0) {
-				utils::sformat("-D: %3.2fV", str_, sizeof(str_)) % usb_m_;
-				bitmap_.draw_text(0, 0, str_);
-			} else {
-				utils::sformat("+D: %3.2fV", str_, sizeof(str_)) % usb_p_;
-				bitmap_.draw_text(0, 0, str_);
-			}
+			utils::sformat("-D: %d.%02dV", str_, sizeof(str_)) % (usb_m_ / 1000) % ((usb_m_ % 1000) / 10);
+			text_line_(0, str_);
+			utils::sformat("+D: %d.%02dV", str_, sizeof(str_)) % (usb_p_ / 1000) % ((usb_p_ % 1000) / 10);
+			text_line_(1, str_);
 		}
 
 
@@ -360,40 +580,38 @@ namespace app {
         //-------------------------------------------------------------//
 		void setup()
 		{
-			if(page_ == 0) {
-
-			} else {
-
-			}
 		}
 
 
         //-------------------------------------------------------------//
         /*!
-            @brief  サービス
+            @brief  サービス（フレーム周期に同期）
         */
         //-------------------------------------------------------------//
 		void service()
 		{
-			timer_b_.sync();
+			while(frame_ == timer_b::task_.get_frame()) {
+				asm("nop");
+			}
+			frame_ = timer_b::task_.get_frame();
 
-			timer_b_.task_.service();
+			trb_task::frame_t f;
+			timer_b::task_.get_frame_sum(f);
 
-			adc_.start(ADC::CH_TYPE::CH0_CH1, ADC::CH_GROUP::AN0_AN1, false);
-			adc_.scan(); // AN0, AN1 A/D scan start
+			timer_b_.task_.service();
 
 			if(timer_b::task_.positive(timer_b::task_type::type::SW_A)) {
 				auto n = static_cast<uint8_t>(task_) + 1;
 				if(n >= static_cast<uint8_t>(TASK::limit)) n = 0;
 				task_ = static_cast<TASK>(n);
+				redraw_ = true;
 			}
 
 			switch(task_) {
-			case TASK::WATT_M:
+			case TASK::CHARGE:
 			case TASK::WATT_H:
 				if(timer_b::task_.positive(timer_b::task_type::type::SW_B)) {
-					timer_b::task_.set_time(0);
-					watt_ = 0;
+					timer_b::task_.reset_accum();
 				}
 				break;
 			case TASK::MAIN:
@@ -401,6 +619,7 @@ namespace app {
 				if(timer_b::task_.positive(timer_b::task_type::type::SW_B)) {
 					++gain_idx_;
 					if(gain_idx_ >= 8) gain_idx_ = 0;  // 0 to 7
+					redraw_ = true;
 				}
 				break;
 			case TASK::SETUP:
@@ -411,84 +630,98 @@ namespace app {
 				break;
 			}
 
-			adc_.sync(); // A/D scan sync
-			{
-				uint32_t i = adc_.get_value(0);
-				uint32_t v = adc_.get_value(1);
-
-				adc_.start(ADC::CH_TYPE::CH0_CH1, ADC::CH_GROUP::AN2_AN3, false);
-				adc_.scan(); // AN2, AN3 A/D scan start
-
-				if(i <= 3) i = 0;  // noise bias
-				if(log_itv_ == 0) {
-					buff_[log_] = (i * v) >> 12;
-					++log_;
-					log_ &= 127;
-					log_itv_ = interval_;
-				} else {
-					--log_itv_;
-				}
-				current_ = static_cast<float>(i) / 1023.0f * 3.3f / (0.4f * 3.0f);
-				volt_    = static_cast<float>(v) / 1023.0f * 3.3f * 6.0f;
-				watt_ += volt_ * current_ / 50.0f;
+			// グラフ用ログ（記録間隔内の平均電力）
+			bool scroll = false;
+			log_p_ += f.sum_p;
+			++log_n_;
+			if(log_itv_ == 0) {
+				buff_[log_] = (log_p_ / (static_cast<uint16_t>(log_n_) * trb_task::FRAME_SUB)) >> 12;
+				++log_;
+				log_ &= 127;
+				log_itv_ = interval_;
+				log_p_ = 0;
+				log_n_ = 0;
+				scroll = true;
+			} else {
+				--log_itv_;
 			}
 
-			{
-				adc_.sync(); // A/D scan sync
-				usb_m_ = static_cast<float>(adc_.get_value(0)) / 1023.0f * 3.3f;
-				usb_p_ = static_cast<float>(adc_.get_value(1)) / 1023.0f * 3.3f;
+			// 数値表示用の平均
+			disp_i_ += f.sum_i;
+			disp_v_ += f.sum_v;
+			++disp_cnt_;
+			bool update = false;
+			if(disp_cnt_ >= DISP_FRAMES) {
+				static const uint32_t n = 1023UL * DISP_FRAMES * trb_task::FRAME_SUB;
+				current_ = disp_i_ * 2750 / n;
+				volt_    = disp_v_ * 19800 / n;
+				usb_m_ = static_cast<uint32_t>(f.usb_m) * 3300 / 1023;
+				usb_p_ = static_cast<uint32_t>(f.usb_p) * 3300 / 1023;
+				disp_i_ = 0;
+				disp_v_ = 0;
+				disp_cnt_ = 0;
+				update = true;
 			}
 
 #ifdef UART
 			++list_cnt_;
-			if(list_cnt_ >= 50) {
+			if(list_cnt_ >= trb_task::FRAME_RATE) {
 				list_cnt_ = 0;
-				utils::format("Vol: %3.2f [V], Cur: %3.2f [A]\n") % volt_ % current_;
-				utils::format("Watt: %8.5f [Wh]\n") % (watt_ / 3600.0f);
+				utils::format("Vol: %d.%02d [V], Cur: %d.%02d [A]\n")
+					% (volt_ / 1000) % ((volt_ % 1000) / 10)
+					% (current_ / 1000) % ((current_ % 1000) / 10);
+				trb_task::accum_t a;
+				timer_b::task_.get_accum(a);
+				utils::format("Watt: %d.%05d [Wh]\n") % (a.mwh / 1000)
+					% ((a.mwh % 1000) * 100 + a.e_acc / (trb_task::E_UNIT / 100));
 			}
 #endif
 
-			if(loop_ == 0) {
-				bitmap_.clear(0);
-			} else if(loop_ == 1) {
-				switch(task_) {
-				case TASK::MAIN:
-					vc();
-					graph(64, 64 - 1);
-					break;
-
-				case TASK::WATT_M:
-					watt("%8.3fWm", watt_ / 60.0f);
-					break;
-				case TASK::WATT_H:
-					watt("%8.5fWh", watt_ / 3600.0f);
-					break;
-
-				case TASK::GRAPH:
-					graph();
-					break;
-
-				case TASK::USB_REF:
-					usb_ref();
-					break;
-
-				case TASK::SETUP:
-					setup();
-					break;
-
-				default:
-					break;
+			if(redraw_) {
+				for(uint8_t i = 0; i < TEXT_NUM; ++i) {
+					text_[0][i] = 0;
+					text_[1][i] = 0;
 				}
-			} else if(loop_ == 2) {
-				lcd_.copy(bitmap_.at_plot().fb(), PLOT::PAGE_NUM, page_ * 3);
-				++page_;
-				page_ &= 1;
+				full_ = 3;
+				dirty_ = 0;
+				update = true;
 			}
 
-			++loop_;
-			if(loop_ >= 3) {
-				loop_ = 0;
+			graph_o_ = 0;
+			graph_w_ = 0;
+			switch(task_) {
+			case TASK::MAIN:
+				if(update) vc();
+				graph_o_ = 64;
+				graph_w_ = 64;
+				break;
+
+			case TASK::CHARGE:
+				if(update) accum(false);
+				break;
+			case TASK::WATT_H:
+				if(update) accum(true);
+				break;
+
+			case TASK::GRAPH:
+				graph_w_ = 128;
+				break;
+
+			case TASK::USB_REF:
+				if(update) usb_ref();
+				break;
+
+			case TASK::SETUP:
+				setup();
+				break;
+
+			default:
+				break;
 			}
+			if(graph_w_ != 0 && scroll) dirty_ = 3;
+			redraw_ = false;
+
+			render_();
 		}
 	};
 }
@@ -37,6 +37,9 @@ namespace {
 	typedef chip::VL53L0X<I2C> VLX;
 	VLX		vlx_(i2c_);
 
+	// GPIO1 を P3_3 (INT3) に接続する場合「true」
+	static const bool use_gpio1_ = true;
+
 	utils::command<64> command_;
 }
 
@@ -76,6 +79,10 @@ extern "C" {
 		uart_.irecv();
 	}
 
+
+	void INT3_intr(void) {
+		vlx_.notify();
+	}
 }
 
 
@@ -124,8 +131,18 @@ int main(int argc, char *argv[])
 	if(!vlx_.start()) {
 		utils::format("VL53L0X start fail\n");
 	} else {
-		// 20ms
+		// 200ms
 		vlx_.set_measurement_timing_budget(200000);
+		// GPIO1 (P3_3: INT3、立下りエッジ)
+		if(use_gpio1_) {
+			utils::PORT_MAP(utils::port_map::P33::INT3);
+			ISCR0.INT3S = 0;
+			INTEN.INT3EN = 1;
+			ILVLD.B01 = 1;
+			vlx_.set_interrupt(true);
+		}
+		// 連続モード（back-to-back）
+		vlx_.start_continuous(0);
 	}
 
 	sci_puts("Start R8C VL53L0X monitor\n");
@@ -135,7 +152,6 @@ int main(int argc, char *argv[])
 	PD1.B0 = 1;
 
 	uint8_t cnt = 0;
-	uint8_t itv = 0;
 	while(1) {
 		timer_b_.sync();
 
@@ -146,15 +162,15 @@ int main(int argc, char *argv[])
 		else P1.B0 = 0;
 		++cnt;
 
-		++itv;
-		if(itv >= 50) {
-			auto len = vlx_.read_range_single_millimeters();
-			if(vlx_.timeout_occurred()) {
-				utils::format("Length: timeout\n");
+		// 計測の完了を確認（待たない）
+		vlx_.poll();
+		VLX::result_t res;
+		while(vlx_.get(res)) {
+			if(res.status == 0x0B) {
+				utils::format("Length: %d [mm]\n") % (res.range - 50);
 			} else {
-				utils::format("Length: %d [mm]\n") % (len - 50);
+				utils::format("Length: --- (%d)\n") % res.status;
 			}
-			itv = 0;
 		}
 
 #if 0
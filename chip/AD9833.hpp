@@ -3,7 +3,9 @@
 /*!	@file
 	@brief	AD9833 class @n
 			ANALOG DEVICES @n
-			Interface: SPI, Vcc: 3.3V to 5V
+			Interface: SPI, Vcc: 3.3V to 5V @n
+			「freq_word」「phase_word」は整数演算でワードを求め、「load」で書き込む。 @n
+			（utils::dds_sweep から割り込みで使う）
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -39,6 +41,9 @@ namespace chip {
 		};
 
 
+		static const uint32_t PHASE_FLAG = 0x80000000;	///< 「load」でフェーズ・ワードを示すビット
+
+
 		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 		/*!
 			@brief  波形型
@@ -159,7 +164,37 @@ namespace chip {
 			return 0;
 		}
 
+		// 周波数ワードの係数（2^28 / REFCLK、小数点以下３２ビット）
+		static constexpr uint64_t FREQ_K = ((1ULL << 60) + REFCLK / 2) / REFCLK;
+
 	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	周波数ワードを計算（整数演算）
+			@param[in]	hz	周波数 [Hz]（０＜＝１２．５ＭＨｚ）
+			@return 周波数ワード（２８ビット）
+		 */
+		//-----------------------------------------------------------------//
+		static uint32_t freq_word(uint32_t hz) noexcept
+		{
+			if(hz > 12500000) hz = 12500000;
+			return (static_cast<uint64_t>(hz) * FREQ_K + (1UL << 31)) >> 32;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	フェーズ・ワードを計算（「load」で出力ソースのフェーズ・レジスタに書く）
+			@param[in]	deg	フェーズ [度]
+			@return フェーズ・ワード
+		 */
+		//-----------------------------------------------------------------//
+		static uint32_t phase_word(uint16_t deg) noexcept
+		{
+			return PHASE_FLAG | (((static_cast<uint32_t>(deg % 360) * 4096 + 180) / 360) & 0x0FFF);
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	コンストラクタ
@@ -233,6 +268,37 @@ namespace chip {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ワードの書き込み @n
+					周波数ワードは、出力していない周波数レジスタに書き、 @n
+					FSELECT で切り替える（書き込み途中の周波数が出ない）。 @n
+					フェーズ・ワードは、出力ソースのフェーズ・レジスタに書く。
+			@param[in]	word	「freq_word」「phase_word」で求めたワード
+		 */
+		//-----------------------------------------------------------------//
+		void load(uint32_t word) noexcept
+		{
+			if(word & PHASE_FLAG) {
+				uint16_t reg = (active_phase_ == REGISTERS::REG0) ? 0 : PHASE1_WRITE_REG;
+				write_(PHASE_WRITE_CMD | reg | (word & 0x0FFF));
+				return;
+			}
+			bool r1 = (active_freq_ == REGISTERS::REG0);
+			uint16_t reg = r1 ? FREQ1_WRITE_REG : FREQ0_WRITE_REG;
+			write_(reg | (word & 0x3FFF));
+			write_(reg | ((word >> 14) & 0x3FFF));
+			if(r1) {
+				wave_form1_ = wave_form0_;
+				active_freq_ = REGISTERS::REG1;
+			} else {
+				wave_form0_ = wave_form1_;
+				active_freq_ = REGISTERS::REG0;
+			}
+			write_ctrl_();
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	フェーズを設定
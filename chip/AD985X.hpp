@@ -8,7 +8,10 @@
 			  Vcc: 3.3V ---> MAX 125MHz @n
 			  Vcc: 5.0V ---> MAX 180MHz @n
 			AD9850: Up to 125MHz @n
-			AD9851: Up to 180MHz
+			AD9851: Up to 180MHz @n
+			「freq_word」「phase_word」は整数演算でワードを求め、「load」で書き込む。 @n
+			（utils::dds_sweep から割り込みで使う） @n
+			※W_CLK、FQ_UD のパルス幅は数ナノ秒なので、ポートの操作に待ちは入れない
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2019 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -32,25 +35,74 @@ namespace chip {
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	template <class D7, class W_CLK, class FQ_UD, class RESET, uint32_t BASEC>
 	class AD985X {
+	public:
+
+		static const uint32_t PHASE_FLAG = 0x80000000;	///< 「load」でフェーズ・ワードを示すビット
+
+	private:
+		// 周波数ワードの係数（2^32 / (BASEC * 10^6)、小数点以下２８ビット）
+		static constexpr uint64_t FREQ_K = ((1ULL << 60) + BASEC * 500000ULL) / (BASEC * 1000000ULL);
+
+		uint8_t		w0_;
+		uint32_t	word_;
 
 		void write_byte_(uint8_t d) {
 			for(uint8_t i = 0; i < 8; ++i) {
 				D7::P = d & 1;
 				d >>= 1;
 				W_CLK::P = 1;
-				utils::delay::micro_second(1);
 				W_CLK::P = 0;
-				utils::delay::micro_second(1);
 			}
 		}
 
+		void write_(uint8_t w0, uint32_t word) {
+			write_byte_(word);
+			write_byte_(word >> 8);
+			write_byte_(word >> 16);
+			write_byte_(word >> 24);
+			write_byte_(w0);
+
+			FQ_UD::P = 1;
+			FQ_UD::P = 0;
+		}
+
 	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	周波数ワードを計算（整数演算）
+			@param[in]	hz	周波数 [Hz]（ベースクロックの半分未満）
+			@return 周波数ワード（PHASE_FLAG - 1 まで）
+		 */
+		//-----------------------------------------------------------------//
+		static uint32_t freq_word(uint32_t hz) noexcept
+		{
+			if(hz > BASEC * 500000UL) hz = BASEC * 500000UL;
+			uint32_t w = (static_cast<uint64_t>(hz) * FREQ_K + (1UL << 27)) >> 28;
+			// ベースクロックの半分は 0x80000000（PHASE_FLAG）になるので、その手前に制限
+			if(w >= PHASE_FLAG) w = PHASE_FLAG - 1;
+			return w;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	フェーズ・ワードを計算（「load」で W0 のフェーズを変える）
+			@param[in]	deg	フェーズ [度]（１１．２５度単位）
+			@return フェーズ・ワード
+		 */
+		//-----------------------------------------------------------------//
+		static uint32_t phase_word(uint16_t deg) noexcept
+		{
+			return PHASE_FLAG | (((static_cast<uint32_t>(deg % 360) * 32 + 180) / 360) & 0x1F);
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	コンストラクタ
 		 */
 		//-----------------------------------------------------------------//
-		AD985X() noexcept
+		AD985X() noexcept : w0_(0), word_(0)
 		{ }
 
 
@@ -115,19 +167,42 @@ namespace chip {
 			double x = 4294967295.0 / static_cast<double>(BASEC);
 			double frequence = static_cast<double>(freq) / 1000000.0;
 			uint32_t y = static_cast<uint32_t>(frequence * x);
+			set_word(w0, y);
+		}
 
-			write_byte_(y);
-			y >>= 8;
-			write_byte_(y);
-			y >>= 8;
-			write_byte_(y);
-			y >>= 8;
-			write_byte_(y);
-			write_byte_(w0);
 
-			FQ_UD::P = 1;
-			utils::delay::micro_second(1);
-			FQ_UD::P = 0;
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	レジスターを設定（ワード）
+			@param[in]	w0		W0 レジスター値
+			@param[in]	word	周波数ワード
+		 */
+		//-----------------------------------------------------------------//
+		void set_word(uint8_t w0, uint32_t word)
+		{
+			w0_ = w0;
+			word_ = word;
+			write_(w0, word);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ワードの書き込み @n
+					周波数ワードは、W0 を保ったまま書き込む。 @n
+					フェーズ・ワードは、W0 のフェーズ（ビット 7-3）を変えて、 @n
+					周波数ワードと共に書き込む。
+			@param[in]	word	「freq_word」「phase_word」で求めたワード
+		 */
+		//-----------------------------------------------------------------//
+		void load(uint32_t word) noexcept
+		{
+			if(word & PHASE_FLAG) {
+				w0_ = (w0_ & 0x07) | ((word & 0x1F) << 3);
+			} else {
+				word_ = word;
+			}
+			write_(w0_, word_);
 		}
 	};
 }
@@ -85,7 +85,8 @@ namespace chip {
 		bool set_time(time_t t) const {
 			if(!start_) return false;
 
-			const tm* tp = gmtime(&t);
+			tm ts;
+			const tm* tp = gmtime_r(&t, &ts);
 			uint8_t reg[7];
 			reg[0] = ((tp->tm_sec  / 10) << 4) | (tp->tm_sec  % 10);  // 0 to 59
 			reg[1] = ((tp->tm_min  / 10) << 4) | (tp->tm_min  % 10);  // 0 to 59
@@ -6,6 +6,7 @@
 */
 //=====================================================================//
 #include <cstdint>
+#include <cstring>
 #include "common/iica_io.hpp"
 #include "common/delay.hpp"
 
@@ -144,6 +145,15 @@ namespace chip {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ページサイズの取得
+			@return ページサイズ
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t get_page_size() const { return pagen_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	書き込み状態の検査
@@ -243,4 +253,241 @@ namespace chip {
 			return true;
 		}
 	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  EEPROM ページ・キャッシュ・テンプレートクラス @n
+				小さな書き込みをページ単位でまとめ、遅延書き込みを行う。@n
+				書き込みサイクル終了の確認は「service」で１回ずつポーリング
+		@param[in]	EEP		EEPROM クラス
+		@param[in]	PAGEN	ページサイズ（EEPROM::start で指定した値と同じ）
+		@param[in]	LINES	キャッシュするページ数
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class EEP, uint16_t PAGEN, uint8_t LINES = 2>
+	class EEPROM_CACHE {
+
+		static_assert((PAGEN & (PAGEN - 1)) == 0, "PAGEN must be a power of 2");
+
+		struct line_t {
+			uint32_t	adr;	///< ページ先頭アドレス
+			uint16_t	lo;		///< 有効範囲（開始）
+			uint16_t	hi;		///< 有効範囲（終端＋１）
+			uint16_t	age;	///< 最後の書き込みからの service 回数
+			bool		dirty;
+			uint8_t		data[PAGEN];
+		};
+
+		EEP&		eep_;
+
+		line_t		line_[LINES];
+		uint8_t		next_;
+
+		bool		busy_;		///< 書き込みサイクル中
+		uint32_t	busy_adr_;
+		uint16_t	delay_;
+		bool		flush_;
+
+		static uint32_t page_(uint32_t adr) { return adr & ~static_cast<uint32_t>(PAGEN - 1); }
+
+		line_t* find_(uint32_t pg) {
+			for(uint8_t i = 0; i < LINES; ++i) {
+				if(line_[i].lo < line_[i].hi && line_[i].adr == pg) return &line_[i];
+			}
+			return nullptr;
+		}
+
+		bool wait_ready_() {
+			if(!busy_) return true;
+			if(!eep_.sync_write(busy_adr_)) return false;
+			busy_ = false;
+			return true;
+		}
+
+		bool flush_line_(line_t& l) {
+			if(!wait_ready_()) return false;
+			if(!eep_.write(l.adr + l.lo, &l.data[l.lo], l.hi - l.lo)) {
+				return false;
+			}
+			l.dirty = false;
+			busy_ = true;
+			busy_adr_ = l.adr;
+			return true;
+		}
+
+		line_t* alloc_(uint32_t pg) {
+			line_t* l = &line_[next_];
+			++next_;
+			if(next_ >= LINES) next_ = 0;
+			if(l->dirty) {
+				if(!flush_line_(*l)) return nullptr;
+			}
+			l->adr = pg;
+			l->lo = 0;
+			l->hi = 0;
+			l->age = 0;
+			return l;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	eep		EEPROM クラスを参照で渡す
+			@param[in]	delay	遅延書き込みまでの service 回数
+		 */
+		//-----------------------------------------------------------------//
+		EEPROM_CACHE(EEP& eep, uint16_t delay = 60) : eep_(eep), line_(), next_(0),
+			busy_(false), busy_adr_(0), delay_(delay), flush_(false) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	EEPROM 読み出し（キャッシュ上のデータを優先）
+			@param[in]	adr	読み出しアドレス
+			@param[out]	dst	先
+			@param[in]	len	長さ
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool read(uint32_t adr, uint8_t* dst, uint16_t len) {
+			while(len > 0) {
+				uint32_t pg = page_(adr);
+				uint16_t ofs = adr - pg;
+				uint16_t l = PAGEN - ofs;
+				if(len < l) l = len;
+				line_t* c = find_(pg);
+				if(c != nullptr && ofs >= c->lo && (ofs + l) <= c->hi) {
+					std::memcpy(dst, &c->data[ofs], l);
+				} else {
+					if(!wait_ready_()) return false;
+					if(!eep_.read(adr, dst, l)) return false;
+					if(c != nullptr) {  // キャッシュ上のデータで上書き
+						uint16_t lo = c->lo > ofs ? c->lo : ofs;
+						uint16_t hi = c->hi < (ofs + l) ? c->hi : (ofs + l);
+						if(lo < hi) {
+							std::memcpy(dst + (lo - ofs), &c->data[lo], hi - lo);
+						}
+					}
+				}
+				dst += l;
+				len -= l;
+				adr += l;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	EEPROM 書き込み（キャッシュへ書き込み）
+			@param[in]	adr	書き込みアドレス
+			@param[in]	src	元
+			@param[in]	len	長さ
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool write(uint32_t adr, const uint8_t* src, uint16_t len) {
+			while(len > 0) {
+				uint32_t pg = page_(adr);
+				uint16_t ofs = adr - pg;
+				uint16_t l = PAGEN - ofs;
+				if(len < l) l = len;
+				line_t* c = find_(pg);
+				if(c == nullptr) {
+					c = alloc_(pg);
+					if(c == nullptr) return false;
+					c->lo = ofs;
+					c->hi = ofs;
+				}
+				// 有効範囲と離れている場合、隙間を読み込んで連続させる
+				if((ofs + l) < c->lo) {
+					if(!wait_ready_()) return false;
+					if(!eep_.read(pg + ofs + l, &c->data[ofs + l], c->lo - (ofs + l))) return false;
+				} else if(ofs > c->hi) {
+					if(!wait_ready_()) return false;
+					if(!eep_.read(pg + c->hi, &c->data[c->hi], ofs - c->hi)) return false;
+				}
+				std::memcpy(&c->data[ofs], src, l);
+				if(ofs < c->lo) c->lo = ofs;
+				if((ofs + l) > c->hi) c->hi = ofs + l;
+				c->dirty = true;
+				c->age = 0;
+				src += l;
+				len -= l;
+				adr += l;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	全てのダーティーページの書き出しを要求 @n
+					※実際の書き出しは「service」で行う
+		 */
+		//-----------------------------------------------------------------//
+		void flush() { flush_ = true; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ダーティーページが無く、書き込みサイクルも終了しているか
+			@return 全て書き込み済みなら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool get_clean() const {
+			if(busy_) return false;
+			for(uint8_t i = 0; i < LINES; ++i) {
+				if(line_[i].dirty) return false;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	サービス（定期的に呼ぶ） @n
+					書き込みサイクル中は１回だけポーリングして直ちに戻る
+			@return デバイスエラーなら「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool service() {
+			if(busy_) {
+				if(!eep_.get_write_state(busy_adr_)) return true;
+				busy_ = false;
+			}
+
+			line_t* c = nullptr;
+			for(uint8_t i = 0; i < LINES; ++i) {
+				line_t& l = line_[i];
+				if(!l.dirty) continue;
+				if(l.age < delay_) ++l.age;
+				if(c == nullptr && (flush_ || l.age >= delay_)) c = &l;
+			}
+			if(c != nullptr) {
+				return flush_line_(*c);
+			}
+			flush_ = false;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	全てのページを書き出して、書き込み終了を待つ
+			@return デバイスエラーなら「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool sync() {
+			for(uint8_t i = 0; i < LINES; ++i) {
+				if(line_[i].dirty) {
+					if(!flush_line_(line_[i])) return false;
+				}
+			}
+			flush_ = false;
+			return wait_ready_();
+		}
+	};
 }
@@ -35,33 +35,140 @@ namespace chip {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
-		@brief  ロータリー・エンコーダー テンプレートクラス
+		@brief  ロータリー・エンコーダー テンプレートクラス @n
+				前回と今回の入力（４ビット）で状態遷移テーブルを引いてカウントする。@n
+				Ａ、Ｂ両相が同時に変化した場合は、取りこぼしとしてエラーを数える。@n
+				速度は、WINDOW 回のサンプル毎に、窓内のカウント数と、 @n
+				窓内のエッジ間隔の合計（エッジ時間）から求める（M/T 法）。
 		@param[in]	PHA		Ａ相入力
 		@param[in]	PHB		Ｂ相入力
 		@param[in]	VTYPE	カウンターの型
 		@param[in]	decode	デコードの仕様
+		@param[in]	WINDOW	速度計測の窓（サンプル数）
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class PHA, class PHB, typename VTYPE = uint32_t, ENCODER_BASE::DECODE decode = ENCODER_BASE::DECODE::PHA_POS>
+	template <class PHA, class PHB, typename VTYPE = uint32_t, ENCODER_BASE::DECODE decode = ENCODER_BASE::DECODE::PHA_POS,
+		uint16_t WINDOW = 256>
 	class ENCODER : public ENCODER_BASE {
 
+		static constexpr int8_t INVALID = 2;
+
+		// 遷移（前回 << 2 | 今回）に対するカウント値
+		static constexpr int8_t delta_(uint8_t idx)
+		{
+			uint8_t prev = idx >> 2;
+			uint8_t lvl = idx & 3;
+			uint8_t ch = prev ^ lvl;
+			if(ch == 0b11) return INVALID;
+			if(ch == 0b01) {  // A 相のエッジ
+				if((lvl & 0b01) != 0) {  // 立ち上がり
+					return (lvl & 0b10) != 0 ? -1 : 1;
+				} else if(decode != DECODE::PHA_POS) {  // 立ち下がり
+					return (lvl & 0b10) != 0 ? 1 : -1;
+				}
+			} else if(ch == 0b10 && decode == DECODE::ALL) {  // B 相のエッジ
+				if((lvl & 0b10) != 0) {  // 立ち上がり
+					return (lvl & 0b01) != 0 ? 1 : -1;
+				} else {  // 立ち下がり
+					return (lvl & 0b01) != 0 ? -1 : 1;
+				}
+			}
+			return 0;
+		}
+
+		struct table_t {
+			int8_t	d[16];
+		};
+
+		static constexpr table_t make_table_()
+		{
+			table_t t { };
+			for(uint8_t i = 0; i < 16; ++i) t.d[i] = delta_(i);
+			return t;
+		}
+
+		static constexpr table_t table_ = make_table_();
+
 		volatile VTYPE	count_;
 		uint8_t	lvl_;
+		volatile uint16_t	error_;
+
+		// 割り込み側（速度計測）
+		uint16_t	since_;		///< 最後のエッジからのサンプル数
+		uint16_t	win_cnt_;
+		int16_t		win_n_;
+		uint32_t	win_t_;
+
+		// 窓毎に確定した値
+		volatile int16_t	pub_n_;
+		volatile uint32_t	pub_t_;
+		volatile uint16_t	pub_since_;
+		volatile uint8_t	pub_id_;
+
+		// メイン側
+		uint16_t	rate_;
+		uint8_t		id_;
+		int32_t		vel_;
+		int32_t		acc_;
 
 		uint8_t input_() { return static_cast<uint8_t>(PHA::P()) | (static_cast<uint8_t>(PHB::P()) << 1); }
 
+		// a * b / c（切り捨て）を 32 ビット演算だけで求める（64 ビット除算ライブラリを使わない）
+		static uint32_t mul_div_(uint32_t a, uint16_t b, uint32_t c) noexcept
+		{
+			uint32_t mh = (a >> 16) * b;
+			uint32_t lo = (a & 0xffff) * b;
+			uint32_t hi = mh >> 16;
+			mh <<= 16;
+			lo += mh;
+			if(lo < mh) ++hi;
+			uint32_t q = 0;
+			uint32_t r = 0;
+			uint8_t i = 0;
+			if(hi < c) {  // 上位 16 ビットの商は０
+				r = hi;
+				i = 16;
+			}
+			for( ; i < 48; ++i) {
+				bool cy = r & 0x80000000;
+				r <<= 1;
+				if(i < 16) r |= (hi >> (15 - i)) & 1;
+				else r |= (lo >> (47 - i)) & 1;
+				q <<= 1;
+				if(cy || r >= c) {
+					r -= c;
+					q |= 1;
+				}
+			}
+			return q;
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	開始
+			@param[in]	rate	service を呼ぶ周期（Hz）、速度計測しない場合「０」
 		 */
 		//-----------------------------------------------------------------//
-		void start() noexcept
+		void start(uint16_t rate = 0) noexcept
 		{
 			PHA::DIR = 0;
 			PHB::DIR = 0;
 			count_ = 0;
 			lvl_ = input_();
+			error_ = 0;
+			since_ = 0;
+			win_cnt_ = 0;
+			win_n_ = 0;
+			win_t_ = 0;
+			pub_n_ = 0;
+			pub_t_ = 0;
+			pub_since_ = 0xffff;
+			pub_id_ = 0;
+			rate_ = rate;
+			id_ = 0;
+			vel_ = 0;
+			acc_ = 0;
 		}
 
 
@@ -75,29 +182,28 @@ namespace chip {
 		void service() noexcept
 		{
 			uint8_t lvl = input_();
-			uint8_t pos = ~lvl_ &  lvl;
-			uint8_t neg =  lvl_ & ~lvl; 
+			int8_t d = table_.d[(lvl_ << 2) | lvl];
 			lvl_ = lvl;
 
-			if((pos & 0b01) != 0) {  // A 相の立ち上がり
-				if((lvl & 0b10) != 0) count_--;
-				else count_++;
+			if(since_ < 0xffff) ++since_;
+			if(d == INVALID) {
+				++error_;
+			} else if(d != 0) {
+				count_ += d;
+				win_n_ += d;
+				win_t_ += since_;
+				since_ = 0;
 			}
-			if(decode == DECODE::PHA_POS_NEG || decode == DECODE::ALL) {
-				if((neg & 0b01) != 0) {  // A 相の立ち下がり
-					if((lvl & 0b10) != 0) count_++;
-					else count_--;
-				}
-			}
-			if(decode == DECODE::ALL) {
-				if((pos & 0b10) != 0) {  // B 相の立ち上がり
-					if((lvl & 0b01) != 0) count_++;
-					else count_--;
-				}
-				if((neg & 0b10) != 0) {  // B 相の立ち下がり
-					if((lvl & 0b01) != 0) count_--;
-					else count_++;
-				}
+
+			++win_cnt_;
+			if(win_cnt_ >= WINDOW) {
+				pub_n_ = win_n_;
+				pub_t_ = win_t_;
+				pub_since_ = since_;
+				++pub_id_;
+				win_cnt_ = 0;
+				win_n_ = 0;
+				win_t_ = 0;
 			}
 		}
 
@@ -111,6 +217,83 @@ namespace chip {
 		auto get_count() const noexcept { return count_; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	不正な遷移（取りこぼし）の回数を取得
+			@return 不正な遷移の回数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_error() const noexcept { return error_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	速度、加速度の更新（メインループから呼ぶ） @n
+					窓内にエッジが無い場合、最後のエッジからの時間で @n
+					速度の上限を決め、低速時に滑らかに零に近づける。
+			@return 新しい窓があれば「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool update() noexcept
+		{
+			if(rate_ == 0) return false;
+
+			uint8_t id;
+			int16_t n;
+			uint32_t t;
+			uint16_t since;
+			do {  // 割り込みと競合したら読み直す
+				id = pub_id_;
+				n = pub_n_;
+				t = pub_t_;
+				since = pub_since_;
+			} while(id != pub_id_) ;
+
+			uint8_t dw = id - id_;
+			if(dw == 0) return false;
+			id_ = id;
+
+			int32_t v;
+			if(n != 0) {
+				uint32_t un = n < 0 ? -static_cast<int32_t>(n) : n;
+				v = static_cast<int32_t>(mul_div_(un << 8, rate_, t));
+				if(n < 0) v = -v;
+			} else if(vel_ == 0 || since == 0xffff) {
+				v = 0;
+			} else {
+				int32_t lim = (static_cast<int32_t>(rate_) << 8) / since;
+				v = vel_;
+				if(v >  lim) v =  lim;
+				if(v < -lim) v = -lim;
+			}
+
+			uint32_t dv = static_cast<uint32_t>(v) - static_cast<uint32_t>(vel_);
+			if(v < vel_) dv = -dv;
+			int32_t a = static_cast<int32_t>(mul_div_(dv, rate_, static_cast<uint32_t>(WINDOW) * dw));
+			acc_ = v < vel_ ? -a : a;
+			vel_ = v;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	速度の取得（update で更新）
+			@return 速度（カウント／秒、小数点以下８ビット）
+		 */
+		//-----------------------------------------------------------------//
+		int32_t get_velocity() const noexcept { return vel_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	加速度の取得（update で更新）
+			@return 加速度（カウント／秒^2、小数点以下８ビット）
+		 */
+		//-----------------------------------------------------------------//
+		int32_t get_accel() const noexcept { return acc_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	() オペレーター
@@ -120,4 +303,7 @@ namespace chip {
 			service();
 		}
 	};
+
+	template <class PHA, class PHB, typename VTYPE, ENCODER_BASE::DECODE decode, uint16_t WINDOW>
+	constexpr typename ENCODER<PHA, PHB, VTYPE, decode, WINDOW>::table_t ENCODER<PHA, PHB, VTYPE, decode, WINDOW>::table_;
 }
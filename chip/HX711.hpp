@@ -2,9 +2,16 @@
 //=====================================================================//
 /*!	@file
 	@brief	HX711 ドライバー @n
-			※ロードセル用２４ビットＡ／Ｄコンバーター
+			※ロードセル用２４ビットＡ／Ｄコンバーター @n
+			同期読み出し「read()」と、タイマー割り込みによる非同期読み出しを持つ。 @n
+			非同期： @n
+			・タイマー割り込みから「itask()」を呼ぶ、DAT の変換完了を調べ、 @n
+			  ２４ビットとゲイン選択のパルスを、SLICE パルスずつ送る。 @n
+			  （80SPS の場合、1KHz 程度で呼べば、１回の割り込みは 10us 程度） @n
+			・「service()」で、メディアン、移動平均、風袋、スケールを適用し、 @n
+			  結果をリングに積む。
     @author 平松邦仁 (hira@rvf-rc45.net)
-	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+	@copyright	Copyright (C) 2017, 2021 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/R8C/blob/master/LICENSE
 */
@@ -12,6 +19,7 @@
 #include <cstdint>
 #include <cstring>
 #include "common/delay.hpp"
+#include "common/vect.h"
 
 namespace chip {
 
@@ -20,11 +28,121 @@ namespace chip {
 		@brief  HX711 テンプレートクラス
 		@param[in]	SCK		クロック・ポート
 		@param[in]	DAT		データ・ポート
+		@param[in]	MEDN	メディアン・フィルターの長さ（奇数、１で無し）
+		@param[in]	AVGN	移動平均の長さ（１で無し）
+		@param[in]	RING	結果リングの大きさ
+		@param[in]	SLICE	割り込み１回で送るパルス数
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class SCK, class DAT>
+	template <class SCK, class DAT, uint8_t MEDN = 3, uint8_t AVGN = 4, uint8_t RING = 4, uint8_t SLICE = 9>
 	class HX711 {
 
+		static_assert((MEDN & 1) != 0 && MEDN <= 7, "MEDN must be 1, 3, 5 or 7");
+		static_assert(AVGN >= 1 && AVGN <= 32, "AVGN must be 1 to 32");
+		static_assert(RING >= 2, "RING must be 2 or more");
+		static_assert(SLICE >= 1, "SLICE must be 1 or more");
+
+	public:
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  入力とゲイン（２４ビットの後のパルス数）
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class MODE : uint8_t {
+			A128 = 1,	///< チャネルＡ、ゲイン１２８
+			B32  = 2,	///< チャネルＢ、ゲイン３２
+			A64  = 3,	///< チャネルＡ、ゲイン６４
+		};
+
+	private:
+		static constexpr uint8_t RAWN = 4;
+
+		MODE		mode_;
+		volatile uint8_t	skip_;	// 設定変更後に捨てる変換数
+
+		// 割り込み内の読み出し
+		volatile bool		run_;
+		uint8_t				pos_;
+		uint32_t			data_;
+		volatile int32_t	raw_[RAWN];
+		volatile uint8_t	raw_put_;
+		volatile uint8_t	raw_get_;
+
+		// フィルター
+		int32_t		med_[MEDN];
+		uint8_t		med_pos_;
+		int32_t		avg_[AVGN];
+		uint8_t		avg_pos_;
+		int32_t		sum_;
+		bool		init_;
+		int32_t		count_;		// フィルター後の値
+
+		int32_t		tare_;
+		int32_t		scale_;		// 小数点以下１６ビット
+
+		int32_t		ring_[RING];
+		uint8_t		put_;
+		uint8_t		get_;
+		uint16_t	lost_;
+
+		// PD_SCK の High は 0.2us 以上 50us 以下（60us で、パワーダウン）
+		static bool clock_() {
+			SCK::P = 1;
+			utils::delay::nano_second<200>();
+			bool b = DAT::P();
+			SCK::P = 0;
+			return b;
+		}
+
+		static int32_t sign_(uint32_t v) {
+			if(v & 0x800000) v |= 0xff000000;
+			return static_cast<int32_t>(v);
+		}
+
+		int32_t median_(int32_t v) {
+			med_[med_pos_] = v;
+			++med_pos_;
+			if(med_pos_ >= MEDN) med_pos_ = 0;
+			int32_t t[MEDN];
+			for(uint8_t i = 0; i < MEDN; ++i) {  // 挿入ソート
+				int32_t a = med_[i];
+				uint8_t j = i;
+				while(j > 0 && t[j - 1] > a) {
+					t[j] = t[j - 1];
+					--j;
+				}
+				t[j] = a;
+			}
+			return t[MEDN / 2];
+		}
+
+		int32_t average_(int32_t v) {
+			sum_ += v - avg_[avg_pos_];
+			avg_[avg_pos_] = v;
+			++avg_pos_;
+			if(avg_pos_ >= AVGN) avg_pos_ = 0;
+			return sum_ / AVGN;
+		}
+
+		void filter_(int32_t v) {
+			if(!init_) {  // 最初の値で埋めて、すぐに安定させる
+				for(uint8_t i = 0; i < MEDN; ++i) med_[i] = v;
+				for(uint8_t i = 0; i < AVGN; ++i) avg_[i] = v;
+				sum_ = v * static_cast<int32_t>(AVGN);
+				init_ = true;
+			}
+			count_ = average_(median_(v));
+
+			uint8_t next = put_ + 1;
+			if(next >= RING) next = 0;
+			if(next == get_) {  // 一杯なら古い結果を捨てる
+				++get_;
+				if(get_ >= RING) get_ = 0;
+				++lost_;
+			}
+			ring_[put_] = get_value();
+			put_ = next;
+		}
 
 	public:
 		//-----------------------------------------------------------------//
@@ -32,10 +150,276 @@ namespace chip {
 			@brief	コンストラクター
 		 */
 		//-----------------------------------------------------------------//
-		HX711() noexcept { }
+		HX711() noexcept : mode_(MODE::A128), skip_(0), run_(false), pos_(0), data_(0),
+			raw_{ 0 }, raw_put_(0), raw_get_(0),
+			med_{ 0 }, med_pos_(0), avg_{ 0 }, avg_pos_(0), sum_(0), init_(false), count_(0),
+			tare_(0), scale_(1L << 16), ring_{ 0 }, put_(0), get_(0), lost_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	開始
+			@param[in]	mode	入力とゲイン
+			@param[in]	async	「itask()」で読み出す場合「true」
+		 */
+		//-----------------------------------------------------------------//
+		void start(MODE mode = MODE::A128, bool async = true) noexcept
+		{
+			run_ = false;
+			SCK::DIR = 1;
+			SCK::P = 0;
+			DAT::DIR = 0;
+
+			mode_ = mode;
+			skip_ = mode == MODE::A128 ? 0 : 1;  // パワーオン後は A128
+			pos_ = 0;
+			data_ = 0;
+			raw_put_ = raw_get_ = 0;
+			init_ = false;
+			put_ = get_ = 0;
+			run_ = async;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	入力とゲインを変更（次の変換から、最初の変換は捨てる）
+			@param[in]	mode	入力とゲイン
+		 */
+		//-----------------------------------------------------------------//
+		void set_mode(MODE mode) noexcept
+		{
+			if(mode == mode_) return;
+			di();
+			mode_ = mode;
+			skip_ = 1;  // 次の変換は前の設定
+			raw_get_ = raw_put_;
+			ei();
+			init_ = false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	変換完了か検査
+			@return 変換完了なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool ready() const noexcept { return !DAT::P(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	同期読み出し（変換完了まで待つ）@n
+					非同期で使っている場合は使わない事。
+			@return 変換値
+		 */
+		//-----------------------------------------------------------------//
+		int32_t read() noexcept
+		{
+			while(!ready()) ;
+			uint32_t v = 0;
+			for(uint8_t i = 0; i < 24 + static_cast<uint8_t>(mode_); ++i) {
+				di();  // 割り込みで High が伸びるとパワーダウンする
+				bool b = clock_();
+				ei();
+				if(i < 24) v = (v << 1) | b;
+			}
+			return sign_(v);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	パワーダウン
+		 */
+		//-----------------------------------------------------------------//
+		void power_down() noexcept
+		{
+			di();
+			run_ = false;
+			pos_ = 0;
+			data_ = 0;
+			ei();
+			SCK::P = 1;
+			utils::delay::micro_second(80);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	パワーダウンからの復帰 @n
+					復帰後の最初の変換は A128 なので、他の設定の場合は捨てる。
+			@param[in]	async	「itask()」で読み出す場合「true」
+		 */
+		//-----------------------------------------------------------------//
+		void power_up(bool async = true) noexcept
+		{
+			start(mode_, async);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	割り込みタスク（タイマー割り込みから呼ぶ）
+		 */
+		//-----------------------------------------------------------------//
+		void itask() noexcept
+		{
+			if(!run_) return;
+			if(pos_ == 0 && DAT::P()) return;  // 変換中
+
+			uint8_t end = 24 + static_cast<uint8_t>(mode_);
+			uint8_t n = SLICE;
+			while(n > 0 && pos_ < end) {
+				bool b = clock_();
+				if(pos_ < 24) data_ = (data_ << 1) | b;
+				++pos_;
+				--n;
+			}
+			if(pos_ < end) return;
+
+			pos_ = 0;
+			if(skip_ > 0) {
+				--skip_;
+			} else {
+				uint8_t next = raw_put_ + 1;
+				if(next >= RAWN) next = 0;
+				if(next != raw_get_) {
+					raw_[raw_put_] = sign_(data_);
+					raw_put_ = next;
+				}
+			}
+			data_ = 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	サービス（メイン・ループから呼ぶ）@n
+					変換値をフィルターに通し、結果をリングに積む。@n
+					リングが一杯の場合は、古い結果を捨てる（get_lost で数を確認）。
+		 */
+		//-----------------------------------------------------------------//
+		void service() noexcept
+		{
+			while(raw_get_ != raw_put_) {
+				int32_t v = raw_[raw_get_];
+				uint8_t next = raw_get_ + 1;
+				if(next >= RAWN) next = 0;
+				raw_get_ = next;
+				filter_(v);
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	変換値をフィルターに通す（同期読み出しの場合）
+			@param[in]	raw	変換値
+		 */
+		//-----------------------------------------------------------------//
+		void put(int32_t raw) noexcept { filter_(raw); }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	フィルター後の変換値を取得
+			@return フィルター後の変換値
+		 */
+		//-----------------------------------------------------------------//
+		int32_t get_count() const noexcept { return count_; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	現在の値を風袋（ゼロ点）にする
+		 */
+		//-----------------------------------------------------------------//
+		void tare() noexcept { tare_ = count_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	スケールを設定
+			@param[in]	scale	１カウント当たりの値（小数点以下１６ビット）
+		 */
+		//-----------------------------------------------------------------//
+		void set_scale(int32_t scale) noexcept { scale_ = scale; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	スケールを取得
+			@return １カウント当たりの値（小数点以下１６ビット）
+		 */
+		//-----------------------------------------------------------------//
+		int32_t get_scale() const noexcept { return scale_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	校正（既知の重さを載せた状態で呼ぶ）
+			@param[in]	known	載せた重さ（結果の単位）
+			@return ゼロ点と変わらない、又は範囲外なら「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool calibrate(int32_t known) noexcept
+		{
+			int32_t d = count_ - tare_;
+			if(d == 0) return false;
+			int64_t s = (static_cast<int64_t>(known) << 16) / d;
+			if(s == 0 || s > 0x7fffffffLL || s < -0x7fffffffLL) return false;
+			scale_ = s;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	現在の値を取得（風袋とスケールを適用）
+			@return 値
+		 */
+		//-----------------------------------------------------------------//
+		int32_t get_value() const noexcept
+		{
+			int64_t v = static_cast<int64_t>(count_ - tare_) * scale_;
+			return (v + 0x8000) >> 16;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リングの結果の数を取得
+			@return 結果の数
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t length() const noexcept { return (put_ + RING - get_) % RING; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リングから結果を取得
+			@param[out]	value	値（風袋とスケールを適用）
+			@return 結果が無い場合「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool get(int32_t& value) noexcept
+		{
+			if(put_ == get_) return false;
+			value = ring_[get_];
+			++get_;
+			if(get_ >= RING) get_ = 0;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リングが一杯で捨てた結果の数を取得
+			@return 捨てた結果の数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_lost() const noexcept { return lost_; }
 	};
 }
@@ -5,7 +5,8 @@
 			LED Display Driver (VCC: 4V to 5.5V) @n
 			※輝度を大きく設定すると、消費電流が大きくなるので注意が必要。 @n
 			※初期化前は、レジスター値が不定なので、大きな消費電流が流れる恐れがある @n
-			※デージーチェイン接続した場合のバッファ配置に注意
+			※デージーチェイン接続した場合のバッファ配置に注意 @n
+			※送信済みの内容を保持し、変化した桁だけを転送する
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2017, 2021 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -13,6 +14,7 @@
 */
 //=========================================================================//
 #include <cstdint>
+#include <cstring>
 
 namespace chip {
 
@@ -30,6 +32,9 @@ namespace chip {
 		SPI&		spi_;
 
 		uint8_t		fb_[8 * CHAIN];
+		uint8_t		shadow_[8 * CHAIN];	///< 最後に送信した内容
+		bool		force_;				///< 次の service で全桁を送信
+		uint8_t		inten_;
 
 		enum class COMMAND : uint8_t {
 			NO_OP        = 0x00,
@@ -63,15 +68,29 @@ namespace chip {
 		}
 
 
-		void out_digit_(COMMAND cmd, uint8_t idx) noexcept
+		// 桁（行）の転送、変化の無いデバイスには NO_OP を送り、
+		// チェーン全体を１回のシフトで送る
+		void out_digit_(uint8_t idx) noexcept
 		{
-			SELECT::P = 0;
-			uint8_t tmp[2];
-			tmp[0] = static_cast<uint8_t>(cmd);
+			uint8_t tmp[2 * CHAIN];
+			bool out = false;
 			for(uint8_t i = 0; i < CHAIN; ++i) {
-				tmp[1] = fb_[8 * (CHAIN - i - 1) + idx];
-				spi_.send(tmp, 2);
+				uint8_t pos = 8 * (CHAIN - i - 1) + idx;
+				uint8_t d = fb_[pos];
+				if(force_ || d != shadow_[pos]) {
+					tmp[i * 2 + 0] = static_cast<uint8_t>(COMMAND::DIGIT_0) + idx;
+					tmp[i * 2 + 1] = d;
+					shadow_[pos] = d;
+					out = true;
+				} else {
+					tmp[i * 2 + 0] = static_cast<uint8_t>(COMMAND::NO_OP);
+					tmp[i * 2 + 1] = 0x00;
+				}
 			}
+			if(!out) return;
+
+			SELECT::P = 0;
+			spi_.send(tmp, sizeof(tmp));
 			SELECT::P = 1;  // load
 		}
 
@@ -82,7 +101,7 @@ namespace chip {
 			@param[in]	spi	SPI クラスを参照で渡す
 		 */
 		//-----------------------------------------------------------------//
-		MAX7219(SPI& spi) noexcept : spi_(spi), fb_{ 0 } { }
+		MAX7219(SPI& spi) noexcept : spi_(spi), fb_{ 0 }, shadow_{ 0 }, force_(true), inten_(0xff) { }
 
 
 		//-----------------------------------------------------------------//
@@ -103,8 +122,10 @@ namespace chip {
 			out_(COMMAND::DECODE_MODE, 0x00);  // デコード・モード
 			out_(COMMAND::SCAN_LIMIT, 7);  // 表示桁設定
 
+			inten_ = 0xff;
 			set_intensity(0);  // 輝度（最低）
 
+			force_ = true;
 			service();
 
 			return true;
@@ -120,6 +141,8 @@ namespace chip {
 		//-----------------------------------------------------------------//
 		bool set_intensity(uint8_t inten) noexcept
 		{
+			if(inten == inten_) return true;  // 変化が無ければ送らない
+			inten_ = inten;
 			out_(COMMAND::INTENSITY, inten);
 			return true;
 		}
@@ -128,19 +151,27 @@ namespace chip {
 		//-----------------------------------------------------------------//
 		/*!
 			@brief サービス @n
-				   フレームバッファを転送
+				   フレームバッファの変化した桁だけを転送
 		 */
 		//-----------------------------------------------------------------//
 		void service() noexcept
 		{
-			auto cmd = COMMAND::DIGIT_0;
 			for(uint8_t i = 0; i < 8; ++i) {
-				out_digit_(cmd, i);
-				cmd = static_cast<COMMAND>(static_cast<uint8_t>(cmd) + 1);					
+				out_digit_(i);
 			}
+			force_ = false;
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief 次の service で全桁を転送する @n
+				   ※ノイズ等でデバイス側の内容が壊れた場合など
+		 */
+		//-----------------------------------------------------------------//
+		void invalidate() noexcept { force_ = true; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief 値の設定
@@ -346,7 +377,7 @@ namespace chip {
 		//-----------------------------------------------------------------//
 		uint8_t shift_top(uint8_t fill = 0) noexcept
 		{
-			uint8_t full = fb_[0];
+			uint8_t full = fb_[CHAIN * 8 - 1];
 			std::memmove(&fb_[1], &fb_[0], CHAIN * 8 - 1);
 			fb_[0] = fill;
 			return full;
@@ -362,13 +393,37 @@ namespace chip {
 		//-----------------------------------------------------------------//
 		uint8_t shift_end(uint8_t fill = 0) noexcept
 		{
-			uint8_t full = fb_[CHAIN * 8 - 1];
+			uint8_t full = fb_[0];
 			std::memmove(&fb_[0], &fb_[1], CHAIN * 8 - 1);
 			fb_[CHAIN * 8 - 1] = fill;
 			return full;
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief マーキー（流れる表示） @n
+				   列データ src を pos から切り出してバッファに設定する。@n
+				   バッファの終端側から、src[pos], src[pos + 1], ... を並べ、 @n
+				   src の終端を越えた所は先頭に戻る。@n
+				   pos を１つずつ進めて service を呼ぶと、変化した列だけが転送される。
+			@param[in]	src	列データ
+			@param[in]	len	列データの長さ
+			@param[in]	pos	表示開始位置
+		 */
+		//-----------------------------------------------------------------//
+		void marquee(const uint8_t* src, uint16_t len, uint16_t pos) noexcept
+		{
+			if(src == nullptr || len == 0) return;
+			pos %= len;
+			for(uint8_t i = 0; i < (CHAIN * 8); ++i) {
+				fb_[CHAIN * 8 - 1 - i] = src[pos];
+				++pos;
+				if(pos >= len) pos = 0;
+			}
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief [] オペレーター
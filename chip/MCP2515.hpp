@@ -3,9 +3,14 @@
 /*!	@file
 	@brief	MCP2515 CAN ドライバー @n
 			※MCP2515 の電源は２．７Ｖ～５．５Ｖ（３．３Ｖ、５Ｖが可能）@n
-			※ドライバーの電源は通常５Ｖなので、電源が分離されていない場合は５Ｖ駆動
+			※ドライバーの電源は通常５Ｖなので、電源が分離されていない場合は５Ｖ駆動 @n
+			INT 端子を外部割り込みに接続し、割り込みで「notify」を呼ぶと、 @n
+			「service」は割り込みがあった時だけ、フラグを読み、受信バッファを @n
+			受信リングに移す（READ RX BUFFER）。 @n
+			送信は「post」でキューに積み、「service」が空いている送信バッファ @n
+			（３つ）に LOAD TX BUFFER で書き込み、RTS で送信を要求する。
     @author 平松邦仁 (hira@rvf-rc45.net)
-	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+	@copyright	Copyright (C) 2017, 2021 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/R8C/blob/master/LICENSE
 */
@@ -34,12 +39,28 @@ namespace chip {
 		@param[in]	SPI	SPI クラス
 		@param[in]	SEL	選択クラス
 		@param[in]	OSC	発信周波数型
+		@param[in]	RXN	受信リングの大きさ
+		@param[in]	TXN	送信キューの大きさ
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class SPI, class SEL, MCP2515_OSC OSC = MCP2515_OSC::OSC_8MHZ>
+	template <class SPI, class SEL, MCP2515_OSC OSC = MCP2515_OSC::OSC_8MHZ,
+		uint8_t RXN = 8, uint8_t TXN = 4>
 	class MCP2515 {
 	public:
 
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  CAN フレーム
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct frame_t {
+			uint32_t	id;			///< ID（標準 11 ビット、拡張 29 ビット）
+			uint8_t		ext;		///< 拡張 ID なら「1」
+			uint8_t		rtr;		///< リモート・フレームなら「1」
+			uint8_t		len;		///< データ長（DLC、0 to 8）
+			uint8_t		data[8];	///< データ
+		};
+
 		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 		/*!
 			@brief  動作モード
@@ -180,6 +201,9 @@ namespace chip {
 		static const uint8_t MCP_BITMOD  = 0x05;
 		static const uint8_t MCP_STATUS  = 0xA0;
 		static const uint8_t MCP_RESET   = 0xC0;
+		static const uint8_t MCP_READ_RX = 0x90;  // | (n << 2)
+		static const uint8_t MCP_LOAD_TX = 0x40;  // | (n << 1)
+		static const uint8_t MCP_RTS     = 0x80;  // | (1 << n)
 
 		static const uint8_t MCP_RX0IF   = 0x01;
 		static const uint8_t MCP_RX1IF   = 0x02;
@@ -242,6 +266,31 @@ namespace chip {
 		uint8_t		recv_ext_;
 		uint8_t		recv_len_;
 
+		struct tx_t {
+			frame_t		frame;
+			uint8_t		prio;
+		};
+
+		frame_t		rx_[RXN];
+		uint8_t		rx_put_;
+		uint8_t		rx_get_;
+		tx_t		tx_[TXN];
+		uint8_t		tx_put_;
+		uint8_t		tx_get_;
+		uint8_t		tx_busy_;	// 送信中のバッファ（ビット 0 to 2）
+		uint8_t		txp_[3];	// 送信バッファに設定した優先度
+
+		uint16_t	lost_;
+		uint16_t	overrun_;
+		uint16_t	bus_error_;
+		uint8_t		eflg_;
+
+		bool		use_irq_;
+		volatile bool	irq_;
+
+		static_assert(RXN >= 2, "RXN must be 2 or more");
+		static_assert(TXN >= 2, "TXN must be 2 or more");
+
 
 		uint8_t read_(REGA adrs) noexcept
 		{
@@ -476,7 +525,7 @@ namespace chip {
 				/* 1000K    at 20MHz */	0x00, 0xD9, 0x82,
 			};
 
-			uint8_t idx = static_cast<uint8_t>(speed) * 3 * static_cast<uint8_t>(OSC);
+			uint8_t idx = (static_cast<uint8_t>(speed) * 3 + static_cast<uint8_t>(OSC)) * 3;
 			auto cfg1 = cfg123[idx + 0];
 			auto cfg2 = cfg123[idx + 1];
 			auto cfg3 = cfg123[idx + 2];
@@ -550,13 +599,129 @@ namespace chip {
 		}
 
 
+		void clear_queue_() noexcept
+		{
+			rx_put_ = 0;
+			rx_get_ = 0;
+			tx_put_ = 0;
+			tx_get_ = 0;
+			tx_busy_ = 0;
+			txp_[0] = txp_[1] = txp_[2] = 0;
+			eflg_ = 0;
+		}
+
+
+		// 受信バッファ n を受信リングへ（CS の解除で RXnIF はクリアされる）
+		void read_rx_buffer_(uint8_t n) noexcept
+		{
+			uint8_t next = rx_put_ + 1;
+			if(next >= RXN) next = 0;
+			if(next == rx_get_) {  // 一杯なら古いフレームを捨てる
+				++rx_get_;
+				if(rx_get_ >= RXN) rx_get_ = 0;
+				++lost_;
+			}
+			frame_t& f = rx_[rx_put_];
+
+			uint8_t h[5];  // SIDH, SIDL, EID8, EID0, DLC
+			SEL::P = 0;
+			spi_.xchg(MCP_READ_RX | (n << 2));
+			spi_.recv(h, sizeof(h));
+			if(h[MCP_SIDL] & MCP_TXB_EXIDE_M) {
+				f.id = (static_cast<uint32_t>(h[MCP_SIDH]) << 21)
+					| (static_cast<uint32_t>(h[MCP_SIDL] & 0xE0) << 13)
+					| (static_cast<uint32_t>(h[MCP_SIDL] & 0x03) << 16)
+					| (static_cast<uint16_t>(h[MCP_EID8]) << 8) | h[MCP_EID0];
+				f.ext = 1;
+				f.rtr = (h[4] & 0x40) != 0;
+			} else {
+				f.id = (static_cast<uint16_t>(h[MCP_SIDH]) << 3) | (h[MCP_SIDL] >> 5);
+				f.ext = 0;
+				f.rtr = (h[MCP_SIDL] & 0x10) != 0;  // SRR
+			}
+			f.len = h[4] & MCP_DLC_MASK;
+			if(f.len > 8) f.len = 8;
+			if(!f.rtr && f.len > 0) {
+				spi_.recv(f.data, f.len);
+			}
+			SEL::P = 1;
+
+			rx_put_ = next;
+		}
+
+
+		// 番号の小さいバッファに、同じ優先度の送信待ちがあるか
+		bool tx_pending_below_(uint8_t n, uint8_t prio) const noexcept
+		{
+			for(uint8_t i = 0; i < n; ++i) {
+				if((tx_busy_ & (1 << i)) != 0 && txp_[i] == prio) return true;
+			}
+			return false;
+		}
+
+		// 空いている送信バッファにキューから書き込み、まとめて送信要求
+		void load_tx_buffers_() noexcept
+		{
+			uint8_t rts = 0;
+			// 同じ優先度では番号の大きいバッファが先に送信されるので、TXB2 から使う @n
+			// 番号の小さいバッファに同じ優先度の送信待ちがある場合、追い越すので使わない
+			for(uint8_t n = 3; n > 0; ) {
+				--n;
+				if(tx_get_ == tx_put_) break;
+				uint8_t m = 1 << n;
+				if(tx_busy_ & m) continue;
+
+				const tx_t& t = tx_[tx_get_];
+				if(tx_pending_below_(n, t.prio)) continue;
+				if(txp_[n] != t.prio) {
+					write_(static_cast<REGA>(static_cast<uint8_t>(REGA::TXB0CTRL) + (n << 4)), t.prio);
+					txp_[n] = t.prio;
+				}
+
+				const frame_t& f = t.frame;
+				uint8_t h[5];
+				if(f.ext) {
+					h[MCP_SIDH] = f.id >> 21;
+					h[MCP_SIDL] = ((f.id >> 13) & 0xE0) | MCP_TXB_EXIDE_M | ((f.id >> 16) & 0x03);
+					h[MCP_EID8] = f.id >> 8;
+					h[MCP_EID0] = f.id;
+				} else {
+					h[MCP_SIDH] = f.id >> 3;
+					h[MCP_SIDL] = (f.id & 0x07) << 5;
+					h[MCP_EID8] = 0;
+					h[MCP_EID0] = 0;
+				}
+				h[4] = f.len | (f.rtr ? 0x40 : 0x00);
+				SEL::P = 0;
+				spi_.xchg(MCP_LOAD_TX | (n << 1));
+				spi_.send(h, sizeof(h));
+				if(!f.rtr && f.len > 0) {
+					spi_.send(f.data, f.len);
+				}
+				SEL::P = 1;
+
+				tx_busy_ |= m;
+				rts |= m;
+				++tx_get_;
+				if(tx_get_ >= TXN) tx_get_ = 0;
+			}
+			if(rts != 0) {
+				SEL::P = 0;
+				spi_.xchg(MCP_RTS | rts);
+				SEL::P = 1;
+			}
+		}
+
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	コンストラクタ
 		 */
 		//-----------------------------------------------------------------//
-		MCP2515(SPI& spi) noexcept : spi_(spi), mode_(MODE::NORMAL) { }
+		MCP2515(SPI& spi) noexcept : spi_(spi), mode_(MODE::NORMAL),
+			rx_{ }, rx_put_(0), rx_get_(0), tx_{ }, tx_put_(0), tx_get_(0), tx_busy_(0), txp_{ 0 },
+			lost_(0), overrun_(0), bus_error_(0), eflg_(0), use_irq_(false), irq_(false) { }
 
 
 		//-----------------------------------------------------------------//
@@ -578,10 +743,11 @@ namespace chip {
 			}
 
 			init_buffers_();
+			clear_queue_();
 
-			// interrupt mode
-		
-	        write_(REGA::CANINTE, MCP_RX0IF | MCP_RX1IF);
+			// interrupt mode（受信、送信完了、エラー）
+			write_(REGA::CANINTE, MCP_RX0IF | MCP_RX1IF | MCP_TX0IF | MCP_TX1IF | MCP_TX2IF
+				| MCP_ERRIF | MCP_MERRF);
 
 			// Sets BF pins as GPO
 			write_(REGA::BFPCTRL, MCP_BxBFS_MASK | MCP_BxBFE_MASK);
@@ -623,7 +789,8 @@ namespace chip {
 				return false;
 			}
 
-        	return set_ctrl_mode_(MODE::LOOPBACK);
+			mode_ = MODE::LOOPBACK;
+			return set_ctrl_mode_(MODE::LOOPBACK);
 		}
 
 
@@ -681,7 +848,7 @@ namespace chip {
 				ret = false;
 			}
     
-			if(!set_ctrl_mode(mode_)) {
+			if(!set_ctrl_mode_(mode_)) {
 				return false;
 			}
 
@@ -738,7 +905,7 @@ namespace chip {
 				ret = false;
 			}
 
-			if(!set_ctrl_mode(mode_)) {
+			if(!set_ctrl_mode_(mode_)) {
 				return false;
 			}
     
@@ -759,7 +926,7 @@ namespace chip {
 		//-----------------------------------------------------------------//
 		bool set_msg(uint32_t id, uint8_t rtr, uint8_t ext, const void* src, uint8_t len) noexcept
 		{
-			if(len >= sizeof(send_msg_)) {
+			if(len > sizeof(send_msg_)) {
 				return false;
 			}
 			send_id_  = id;
@@ -850,7 +1017,9 @@ namespace chip {
 		//-----------------------------------------------------------------//
 		bool send(uint32_t id, uint8_t ext, const void* src, uint8_t len) noexcept
 		{
-			set_msg(id, 0, ext, src, len);
+			if(!set_msg(id, 0, ext, src, len)) {
+				return false;
+			}
 			return send_msg();
     	}
 
@@ -867,7 +1036,7 @@ namespace chip {
 		//-----------------------------------------------------------------//
 		bool recv(uint32_t& id, uint8_t& ext, void* dst, uint8_t& len) noexcept
 		{
-			if(recv_msg()) {
+			if(!recv_msg()) {
 				return false;
 			}
 
@@ -951,7 +1120,7 @@ namespace chip {
 		{
 			static const uint8_t MODE_ONESHOT = 0x08;
 			modify_(REGA::CANCTRL, MODE_ONESHOT, ena ? MODE_ONESHOT : 0);
-			bool f = (read_(REGA::CANCTRL) & MODE_ONESHOT) != MODE_ONESHOT;
+			bool f = (read_(REGA::CANCTRL) & MODE_ONESHOT) == MODE_ONESHOT;
 			return f == ena;
 		}
 
@@ -983,5 +1152,218 @@ namespace chip {
 			data = res >> 3;
 			return true;
 		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	INT 端子の割り込みを使うか設定 @n
+					使う場合、INT（アクティブ Low）の立下りで「notify」を呼ぶ事。
+			@param[in]	ena	使う場合「true」
+		 */
+		//-----------------------------------------------------------------//
+		void set_interrupt(bool ena) noexcept
+		{
+			use_irq_ = ena;
+			irq_ = ena;  // 取りこぼしを防ぐため、最初の「service」は確認する
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	INT 端子の割り込みの通知（割り込みから呼ぶ）
+		 */
+		//-----------------------------------------------------------------//
+		void notify() noexcept { irq_ = true; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	サービス（メインループから呼ぶ）@n
+					・受信バッファ（RXB0、RXB1）を受信リングに移す @n
+					・送信完了したバッファに、送信キューから次のフレームを書く @n
+					・オーバーラン、バス・エラーを数える @n
+					割り込みを使う場合、割り込みが無く、送信するフレームも無ければ、 @n
+					SPI にアクセスしないで戻る。 @n
+					※「send」「recv」（待つ送受信）と同時に使わない事
+			@return 受信したら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool service() noexcept
+		{
+			if(use_irq_ && !irq_) {
+				if(tx_busy_ != 0x07 && tx_get_ != tx_put_) load_tx_buffers_();
+				return false;
+			}
+			irq_ = false;
+
+			bool rx = false;
+			// INT はレベル出力なので、フラグが無くなるまで処理する（エッジの取りこぼし対策）
+			uint8_t intf = 0;
+			for(uint8_t i = 0; i < 4; ++i) {
+				uint8_t tmp[2];  // CANINTF, EFLG
+				read_(REGA::CANINTF, tmp, sizeof(tmp));
+				intf = tmp[0];
+				if(intf == 0) break;
+
+				if(intf & MCP_RX0IF) {
+					read_rx_buffer_(0);
+					rx = true;
+				}
+				if(intf & MCP_RX1IF) {
+					read_rx_buffer_(1);
+					rx = true;
+				}
+				if(intf & MCP_ERRIF) {
+					eflg_ = tmp[1];
+					uint8_t ovr = tmp[1] & (MCP_EFLG_RX0OVR | MCP_EFLG_RX1OVR);
+					if(ovr != 0) {
+						if(ovr & MCP_EFLG_RX0OVR) ++overrun_;
+						if(ovr & MCP_EFLG_RX1OVR) ++overrun_;
+						modify_(REGA::EFLG, ovr, 0);
+					}
+				}
+				if(intf & MCP_MERRF) ++bus_error_;
+
+				tx_busy_ &= ~((intf >> 2) & 0x07);  // TX0IF, TX1IF, TX2IF
+				uint8_t clr = intf & ~(MCP_RX0IF | MCP_RX1IF);
+				if(clr != 0) modify_(REGA::CANINTF, clr, 0);
+			}
+			// フラグが残っている（INT が Low のまま）場合、次の立下りは来ないので、
+			// 次の「service」でも確認する
+			if(intf != 0) irq_ = true;
+
+			if(tx_busy_ != 0x07 && tx_get_ != tx_put_) load_tx_buffers_();
+
+			return rx;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信キューにフレームを積む @n
+					優先度は送信バッファの TXP に設定され、MCP2515 が送信待ちの @n
+					バッファから優先度の高い順に送信する。@n
+					※同じ優先度のフレームは、キューに積んだ順に送信される
+			@param[in]	frame	フレーム
+			@param[in]	prio	優先度（0 to 3、3 が最も高い）
+			@return キューが一杯なら「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool post(const frame_t& frame, uint8_t prio = 0) noexcept
+		{
+			uint8_t next = tx_put_ + 1;
+			if(next >= TXN) next = 0;
+			if(next == tx_get_) return false;
+			tx_t& t = tx_[tx_put_];
+			t.frame = frame;
+			if(t.frame.len > 8) t.frame.len = 8;
+			t.prio = prio & MCP_TXB_TXP10_M;
+			tx_put_ = next;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信キューにフレームを積む
+			@param[in]	id		ID
+			@param[in]	ext		拡張フラグ
+			@param[in]	src		ソース
+			@param[in]	len		送信バイト数（最大８バイト）
+			@param[in]	prio	優先度（0 to 3、3 が最も高い）
+			@return キューが一杯なら「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool post(uint32_t id, uint8_t ext, const void* src, uint8_t len, uint8_t prio = 0) noexcept
+		{
+			if(len > 8) return false;
+			frame_t f;
+			f.id = id;
+			f.ext = ext;
+			f.rtr = 0;
+			f.len = len;
+			std::memcpy(f.data, src, len);
+			return post(f, prio);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信キューにあるフレームの数（送信バッファにある物は含まない）
+			@return フレームの数
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t tx_length() const noexcept { return (tx_put_ + TXN - tx_get_) % TXN; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信中（送信バッファにある）のフレームがあるか
+			@return 送信中なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool tx_busy() const noexcept { return tx_busy_ != 0; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信リングにあるフレームの数を取得
+			@return フレームの数
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t length() const noexcept { return (rx_put_ + RXN - rx_get_) % RXN; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信リングからフレームを取得
+			@param[out]	frame	フレーム
+			@return フレームが無い場合「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool get(frame_t& frame) noexcept
+		{
+			if(rx_put_ == rx_get_) return false;
+			frame = rx_[rx_get_];
+			++rx_get_;
+			if(rx_get_ >= RXN) rx_get_ = 0;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信リングから捨てたフレームの数を取得
+			@return 捨てた数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_lost() const noexcept { return lost_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信バッファのオーバーラン（RX0OVR、RX1OVR）の回数を取得
+			@return 回数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_overrun() const noexcept { return overrun_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	バス・エラー（MERRF、送受信中のエラー）の回数を取得
+			@return 回数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_bus_error() const noexcept { return bus_error_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	最後のエラー割り込み（ERRIF）での EFLG を取得
+			@return EFLG
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t get_eflg() const noexcept { return eflg_; }
 	};
 }
@@ -3,9 +3,10 @@
 /*!	@file
 	@brief	MFRC522 クラス @n
 			NXP Semiconductors @n
-			Interface: SPI, Vcc: 3.3V
+			Interface: SPI, Vcc: 3.3V @n
+			CRC_A はホストで計算し、チップの CRC コプロセッサは使わない。
     @author 平松邦仁 (hira@rvf-rc45.net)
-	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+	@copyright	Copyright (C) 2017, 2021 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/R8C/blob/master/LICENSE
 */
@@ -91,6 +92,8 @@ namespace chip {
 	private:
 		SPI&	spi_;
 
+		uint8_t	coll_;	// 最後の送受信での CollReg
+
 		enum class reg_adr : uint8_t {
 			// Page 0: Command and status
 			//            0x00
@@ -297,40 +300,36 @@ namespace chip {
 		}
 
 
-		status calculate_CRC_(const void* data, uint8_t size, uint16_t& result)
+		// 複数のレジスタを１回の選択で読む（次のアドレスを送りながら、前のデータを受け取る）
+		void read_regs_(const reg_adr* regs, uint8_t* dst, uint8_t num) noexcept
 		{
-			write_reg_(reg_adr::Command, Command::Idle);	// Stop any active command.
-			write_reg_(reg_adr::DivIrq,  0x04);				// Clear the CRCIRq interrupt request bit
-			set_reg_bit_(reg_adr::FIFOLevel, 0x80);			// FlushBuffer = 1, FIFO initialization
-			write_reg_(reg_adr::FIFOData, data, size);		// Write data to the FIFO
-			write_reg_(reg_adr::Command, Command::CalcCRC);	// Start the calculation
-
-			// Wait for the CRC calculation to complete. Each iteration of the while-loop takes 17.73μs.
-			// TODO check/modify for other architectures than Arduino Uno 16bit
-			uint16_t loop = 5000;
-			while(1) {
-				// DivIrqReg[7..0] bits are:
-				//     Set2 reserved reserved MfinActIRq reserved CRCIRq reserved reserved
-				auto n = read_reg_(reg_adr::DivIrq);
-				if(n & 0x04) {  // CRCIRq bit set - calculation done
-					break;
-				}
-				--loop;
-				// The emergency break.
-				// We will eventually terminate on this one after 89ms.
-				// Communication with the MFRC522 might be down.
-				if(loop == 0) {
-					return status::TIMEOUT;
-				}
+			SEL::P = 0;  // enable device
+			spi_.xchg(0x80 | (static_cast<uint8_t>(regs[0]) & 0x7E));
+			for(uint8_t i = 1; i < num; ++i) {
+				dst[i - 1] = spi_.xchg(0x80 | (static_cast<uint8_t>(regs[i]) & 0x7E));
 			}
-			// Stop calculating CRC for new content in the FIFO.
-			write_reg_(reg_adr::Command, Command::Idle);
+			dst[num - 1] = spi_.xchg(0);
+			SEL::P = 1;  // disable device
+		}
 
-			// Transfer the result from the registers to the result buffer
-			uint16_t d = static_cast<uint16_t>(read_reg_(reg_adr::CRCResultH)) << 8;
-			result = d | read_reg_(reg_adr::CRCResultL);
 
-			return status::OK;
+		// CRC_A（ISO 14443-3、x^16 + x^12 + x^5 + 1、初期値 0x6363）@n
+		// ４ビット単位のテーブルで計算する（チップの CRC コプロセッサは使わない）
+		static uint16_t crc_a_(const void* data, uint8_t size) noexcept
+		{
+			static const uint16_t tbl[16] = {
+				0x0000, 0x1081, 0x2102, 0x3183, 0x4204, 0x5285, 0x6306, 0x7387,
+				0x8408, 0x9489, 0xA50A, 0xB58B, 0xC60C, 0xD68D, 0xE70E, 0xF78F
+			};
+			const uint8_t* p = static_cast<const uint8_t*>(data);
+			uint16_t crc = 0x6363;
+			while(size > 0) {
+				uint8_t d = *p++;
+				crc = (crc >> 4) ^ tbl[(crc ^ d) & 0x0F];
+				crc = (crc >> 4) ^ tbl[(crc ^ (d >> 4)) & 0x0F];
+				--size;
+			}
+			return crc;
 		}
 
 
@@ -340,7 +339,7 @@ namespace chip {
 			@brief	コンストラクタ
 		 */
 		//-----------------------------------------------------------------//
-		MFRC522(SPI& spi) noexcept : spi_(spi) { }
+		MFRC522(SPI& spi) noexcept : spi_(spi), coll_(0) { }
 
 
 		//-----------------------------------------------------------------//
@@ -611,12 +610,15 @@ namespace chip {
 	
 			write_reg_(reg_adr::Command, Command::Idle);		// Stop any active command.
 			write_reg_(reg_adr::ComIrq, 0x7F);					// Clear all seven interrupt request bits
-			set_reg_bit_(reg_adr::FIFOLevel, 0x80);				// FlushBuffer = 1, FIFO initialization
+			write_reg_(reg_adr::FIFOLevel, 0x80);				// FlushBuffer = 1, FIFO initialization
 			write_reg_(reg_adr::FIFOData, send_ptr, send_len);	// Write sendData to the FIFO
-			write_reg_(reg_adr::BitFraming, bitFraming);		// Bit adjustments
-			write_reg_(reg_adr::Command, cmd);					// Execute the command
 			if(cmd == Command::Transceive) {
-				set_reg_bit_(reg_adr::BitFraming, 0x80);		// StartSend=1, transmission of data starts
+				write_reg_(reg_adr::Command, cmd);				// Execute the command
+				// Bit adjustments, StartSend=1, transmission of data starts
+				write_reg_(reg_adr::BitFraming, bitFraming | 0x80);
+			} else {
+				write_reg_(reg_adr::BitFraming, bitFraming);	// Bit adjustments
+				write_reg_(reg_adr::Command, cmd);				// Execute the command
 			}
 
 			// Wait for the command to complete.
@@ -633,7 +635,6 @@ namespace chip {
 //	debug_format("State: %02X\n") % static_cast<uint16_t>(n);
 //}
 				if(n & waitIRq) {	// One of the interrupts that signal success has been set.
-					debug_format("Card detect !\n");
 					break;
 				}
 				if(n & 0x01) {		// Timer interrupt - nothing received in 25ms
@@ -649,9 +650,17 @@ namespace chip {
 				}
 			}
 
+			// Error, FIFOLevel, Control, Coll を１回で読む
+			static const reg_adr regs[4] = {
+				reg_adr::Error, reg_adr::FIFOLevel, reg_adr::Control, reg_adr::Coll
+			};
+			uint8_t sts[4];
+			read_regs_(regs, sts, 4);
+			coll_ = sts[3];
+
 			// Stop now if any errors except collisions were detected.
 			// ErrorReg[7..0] bits are: WrErr TempErr reserved BufferOvfl CollErr CRCErr ParityErr ProtocolErr
-			uint8_t errorRegValue = read_reg_(reg_adr::Error);
+			uint8_t errorRegValue = sts[0];
 			if(errorRegValue & 0x13) {	 // BufferOvfl ParityErr ProtocolErr
 				return status::ERROR;
 			}
@@ -659,7 +668,7 @@ namespace chip {
 			uint8_t validBits = 0;
 			// If the caller wants data back, get it from the MFRC522.
 			if(back_ptr != nullptr) {
-				auto n = read_reg_(reg_adr::FIFOLevel);		// Number of bytes in the FIFO
+				uint8_t n = sts[1] & 0x7F;		// Number of bytes in the FIFO
 				if (n > back_len) {
 					return status::NO_ROOM;
 				}
@@ -667,7 +676,7 @@ namespace chip {
 				read_reg_(reg_adr::FIFOData, back_ptr, n, rx_align);	// Get received data from FIFO
 				// RxLastBits[2:0] indicates the number of valid bits in the last received byte.
 				// If this value is 000b, the whole byte is valid.
-				validBits = read_reg_(reg_adr::Control) & 0x07;
+				validBits = sts[2] & 0x07;
 				if(valid_bits != nullptr) {
 					*valid_bits = validBits;
 				}
@@ -679,7 +688,7 @@ namespace chip {
 			}
 	
 			// Perform CRC_A validation if requested.
-			if(back_ptr != nullptr && back_ptr != nullptr && check_crc) {
+			if(back_ptr != nullptr && check_crc) {
 				// In this case a MIFARE Classic NAK is not OK.
 				if(back_len == 1 && validBits == 4) {
 					return status::MIFARE_NACK;
@@ -688,12 +697,8 @@ namespace chip {
 				if(back_len < 2 || validBits != 0) {
 					return status::CRC_WRONG;
 				}
-				// Verify CRC_A - do our own calculation and store the control in controlBuffer.
-				uint16_t ans;
-				auto st = calculate_CRC_(back_ptr, back_len - 2, ans);
-				if(st != status::OK) {
-					return st;
-				}
+				// Verify CRC_A - do our own calculation
+				uint16_t ans = crc_a_(back_ptr, back_len - 2);
 				const uint8_t* p = static_cast<const uint8_t*>(back_ptr);
 				uint16_t crc = (static_cast<uint16_t>(p[back_len - 1]) << 8) | p[back_len - 2];
 				if(crc != ans) {
@@ -734,8 +739,9 @@ namespace chip {
 				return status::NO_ROOM;
 			}
 
-			// ValuesAfterColl=1 => Bits received after collision are cleared.
-			set_reg_bit_(reg_adr::Coll, 0x80, false);
+			// ValuesAfterColl=0 => Bits received after collision are cleared.
+			// (bit 6..0 are read only)
+			write_reg_(reg_adr::Coll, 0x00);
 			// For REQA and WUPA we need the short frame format - transmit
 			// only 7 bits of the last (and only) byte. TxLastBits = BitFramingReg[2..0]
 			uint8_t validBits = 7;
@@ -774,7 +780,7 @@ namespace chip {
 			@return ステータス
 		 */
 		//-----------------------------------------------------------------//
-		status wakeup(uint8_t* bufferATQA, uint8_t* bufferSize)
+		status wakeup(uint8_t* bufferATQA, uint8_t& bufferSize)
 		{
 			return req_or_wup(PICC_Command::WUPA, bufferATQA, bufferSize);
 		}
@@ -782,11 +788,15 @@ namespace chip {
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	セレクト
+			@brief	セレクト（衝突防止ループを含む）@n
+					UID の全ビットが判明したら、SELECT（BCC、CRC_A はホストで計算）を @n
+					続けて送るので、チップとのやり取りは送受信だけになる。
+			@param[in,out]	uid			UID（valid_bits 分が既知の場合に設定）
+			@param[in]		valid_bits	既知の UID のビット数
 			@return ステータス
 		 */
 		//-----------------------------------------------------------------//
-		status select(uid_t& uid, uint8_t validBits = 0)
+		status select(uid_t& uid, uint8_t valid_bits = 0)
 		{
 			// Description of buffer structure:
 			//		Byte 0: SEL 		Indicates the Cascade Level: PICC_CMD_SEL_CL1, PICC_CMD_SEL_CL2 or PICC_CMD_SEL_CL3
@@ -811,188 +821,160 @@ namespace chip {
 			//						3			uid6	uid7	uid8	uid9
 	
 			// Sanity checks
-			if(validBits > 80) {
+			if(valid_bits > 80) {
 				return status::INVALID;
 			}
 
-			// Prepare MFRC522
-			// ValuesAfterColl=1 => Bits received after collision are cleared.
-			set_reg_bit_(reg_adr::Coll, 0x80, false);
+			// ValuesAfterColl=0 => Bits received after collision are cleared.
+			// (bit 6..0 are read only)
+			write_reg_(reg_adr::Coll, 0x00);
+
+			static const uint8_t CT = static_cast<uint8_t>(PICC_Command::CT);
 
 			// Repeat Cascade Level loop until we have a complete UID.
-			bool uidComplete = false;
-			uint8_t cascadeLevel = 1;
+			uint8_t cascade = 1;
 			uint8_t buffer[9];
-			uint8_t uidIndex;
-			bool useCascadeTag;
-			while(!uidComplete) {
+			while(1) {
 				// Set the Cascade Level in the SEL byte, find out if we need to use the Cascade Tag in byte 2.
-				switch(cascadeLevel) {
-					case 1:
-						buffer[0] = static_cast<uint8_t>(PICC_Command::SEL_CL1);
-						uidIndex = 0;
-						useCascadeTag = validBits && uid->size > 4;
-						break;
-			
-					case 2:
-						buffer[0] = static_cast<uint8_t>(PICC_Command::SEL_CL2);
-						uidIndex = 3;
-						useCascadeTag = validBits && uid->size > 7;
-						break;
-			
-					case 3:
-						buffer[0] = static_cast<uint8_t>(PICC_Command::SEL_CL3);
-						uidIndex = 6;
-						useCascadeTag = false;						// Never used in CL3.
-						break;
-			
-					default:
-						return status::INTERNAL_ERROR;
-						break;
+				uint8_t uid_idx;
+				bool use_ct;
+				switch(cascade) {
+				case 1:
+					buffer[0] = static_cast<uint8_t>(PICC_Command::SEL_CL1);
+					uid_idx = 0;
+					use_ct = valid_bits && uid.size > 4;
+					break;
+				case 2:
+					buffer[0] = static_cast<uint8_t>(PICC_Command::SEL_CL2);
+					uid_idx = 3;
+					use_ct = valid_bits && uid.size > 7;
+					break;
+				case 3:
+					buffer[0] = static_cast<uint8_t>(PICC_Command::SEL_CL3);
+					uid_idx = 6;
+					use_ct = false;  // Never used in CL3.
+					break;
+				default:
+					return status::INTERNAL_ERROR;
 				}
-		
+
 				// How many UID bits are known in this Cascade Level?
-				int8_t currentLevelKnownBits = validBits - (8 * uidIndex);
-				if(currentLevelKnownBits < 0) {
-					currentLevelKnownBits = 0;
+				int8_t known = valid_bits - (8 * uid_idx);
+				if(known < 0) {
+					known = 0;
 				}
-				// Copy the known bits from uid->uidByte[] to buffer[]
-				uint8_t index = 2; // destination index in buffer[]
-				if(useCascadeTag) {
-					buffer[index++] = static_cast<uint8_t>(PICC_Command::CT);
+				// Copy the known bits from uid.uid_byte[] to buffer[]
+				uint8_t index = 2;  // destination index in buffer[]
+				if(use_ct) {
+					buffer[index++] = CT;
 				}
 				// The number of bytes needed to represent the known bits for this level.
-				uint8_t bytesToCopy = currentLevelKnownBits / 8 + (currentLevelKnownBits % 8 ? 1 : 0);
-				if(bytesToCopy) {
+				uint8_t bytes = (known + 7) / 8;
+				if(bytes > 0) {
 					// Max 4 bytes in each Cascade Level. Only 3 left if we use the Cascade Tag
-					uint8_t maxBytes = useCascadeTag ? 3 : 4;
-					if(bytesToCopy > maxBytes) {
-						bytesToCopy = maxBytes;
+					uint8_t max = use_ct ? 3 : 4;
+					if(bytes > max) {
+						bytes = max;
 					}
-					for(uint8_t count = 0; count < bytesToCopy; count++) {
-						buffer[index++] = uid->uid_byte[uidIndex + count];
+					for(uint8_t i = 0; i < bytes; ++i) {
+						buffer[index++] = uid.uid_byte[uid_idx + i];
 					}
 				}
 				// Now that the data has been copied we need to include the 8 bits in CT
-				// in currentLevelKnownBits
-				if(useCascadeTag) {
-					currentLevelKnownBits += 8;
+				if(use_ct) {
+					known += 8;
 				}
 
 				// Repeat anti collision loop until we can transmit all UID bits + BCC and
 				// receive a SAK - max 32 iterations.
-				bool selectDone = false;
-				uint8_t txLastBits;
-				uint8_t bufferUsed;
-				uint8_t count;
-				uint8_t* responseBuffer;
-				uint8_t responseLength;
-				while(!selectDone) {
-					// Find out how many bits and bytes to send and receive.
-					// All UID bits in this Cascade Level are known. This is a SELECT.
-					if(currentLevelKnownBits >= 32) {
-					//Serial.print(F("SELECT: currentLevelKnownBits=")); Serial.println(currentLevelKnownBits, DEC);
-						buffer[1] = 0x70; // NVB - Number of Valid Bits: Seven whole bytes
+				uint8_t* resp;
+				uint8_t resp_len;
+				uint8_t last_bits;
+				while(1) {
+					uint8_t used;
+					if(known >= 32) {
+						// All UID bits in this Cascade Level are known. This is a SELECT.
+						buffer[1] = 0x70;  // NVB - Number of Valid Bits: Seven whole bytes
 						// Calculate BCC - Block Check Character
 						buffer[6] = buffer[2] ^ buffer[3] ^ buffer[4] ^ buffer[5];
-						// Calculate CRC_A
-						uint16_t crc;
-						auto result = calculate_CRC_(buffer, 7, crc);
-						if(result != status::OK) {
-							return result;
-						}
-						txLastBits		= 0; // 0 => All 8 bits are valid.
-						bufferUsed		= 9;
+						uint16_t crc = crc_a_(buffer, 7);
+						buffer[7] = crc & 0xff;
+						buffer[8] = crc >> 8;
+						last_bits = 0;  // 0 => All 8 bits are valid.
+						used = 9;
 						// Store response in the last 3 bytes of buffer (BCC and CRC_A - not needed after tx)
-						responseBuffer = &buffer[6];
-						responseLength = 3;
+						resp = &buffer[6];
+						resp_len = 3;
 					} else {
-						//Serial.print(F("ANTICOLLISION: currentLevelKnownBits=")); Serial.println(currentLevelKnownBits, DEC);
-						uint8_t txLastBits		= currentLevelKnownBits % 8;
-						count			= currentLevelKnownBits / 8;
-						index			= 2 + count;			// Number of whole bytes: SEL + NVB + UIDs
-						buffer[1]		= (index << 4) + txLastBits;	// NVB - Number of Valid Bits
-						bufferUsed		= index + (txLastBits ? 1 : 0);
+						// ANTICOLLISION
+						last_bits = known % 8;
+						index = 2 + known / 8;  // Number of whole bytes: SEL + NVB + UIDs
+						buffer[1] = (index << 4) + last_bits;  // NVB - Number of Valid Bits
+						used = index + (last_bits ? 1 : 0);
 						// Store response in the unused part of buffer
-						responseBuffer	= &buffer[index];
-						responseLength	= sizeof(buffer) - index;
+						resp = &buffer[index];
+						resp_len = sizeof(buffer) - index;
 					}
 
-					// Set bit adjustments
-					// Having a separate variable is overkill. But it makes the next line easier to read.
-					uint8_t rxAlign = txLastBits;
-					// RxAlign = BitFramingReg[6..4]. TxLastBits = BitFramingReg[2..0]
-					write_reg_(reg_adr::BitFraming, (rxAlign << 4) + txLastBits);
-			
 					// Transmit the buffer and receive the response.
-					auto result = transceive_data(buffer, bufferUsed, responseBuffer, responseLength, &txLastBits, rxAlign);
-
-					if(result == status::COLLISION) { // More than one PICC in the field => collision.
+					uint8_t rx_align = last_bits;
+					auto st = transceive_data(buffer, used, resp, resp_len, &last_bits, rx_align);
+					if(st == status::COLLISION) {  // More than one PICC in the field => collision.
 						// CollReg[7..0] bits are: ValuesAfterColl reserved CollPosNotValid CollPos[4:0]
-						uint8_t valueOfCollReg = read_reg_(reg_adr::Coll);
-						if(valueOfCollReg & 0x20) { // CollPosNotValid
+						if(coll_ & 0x20) {  // CollPosNotValid
 							// Without a valid collision position we cannot continue
 							return status::COLLISION;
 						}
-						uint8_t collisionPos = valueOfCollReg & 0x1F; // Values 0-31, 0 means bit 32.
-						if(collisionPos == 0) {
-							collisionPos = 32;
+						uint8_t pos = coll_ & 0x1F;  // Values 0-31, 0 means bit 32.
+						if(pos == 0) {
+							pos = 32;
 						}
-						if(collisionPos <= currentLevelKnownBits) { // No progress - should not happen 
+						if(pos <= known) {  // No progress - should not happen 
 							return status::INTERNAL_ERROR;
 						}
 						// Choose the PICC with the bit set.
-						currentLevelKnownBits = collisionPos;
-						count			= (currentLevelKnownBits - 1) % 8; // The bit to modify
-						index			= 1 + (currentLevelKnownBits / 8) + (count ? 1 : 0); // First byte is index 0.
-						buffer[index]	|= (1 << count);
-					} else if (result != status::OK) {
-						return result;
-					} else { // STATUS_OK
-						if(currentLevelKnownBits >= 32) { // This was a SELECT.
-							selectDone = true; // No more anticollision 
-							// We continue below outside the while.
-						} else {
-							// We now have all 32 bits of the UID in this Cascade Level
-							currentLevelKnownBits = 32;
-							// Run loop again to do the SELECT.
-						}
+						known = pos;
+						uint8_t bit = (known - 1) % 8;  // The bit to modify
+						index = 1 + (known / 8) + (bit ? 1 : 0);  // First byte is index 0.
+						buffer[index] |= (1 << bit);
+					} else if(st != status::OK) {
+						return st;
+					} else if(known >= 32) {  // This was a SELECT.
+						break;
+					} else {
+						// We now have all 32 bits of the UID in this Cascade Level
+						known = 32;
+						// Run loop again to do the SELECT.
 					}
 				}
-				// We do not check the CBB - it was constructed by us above.
-		
-				// Copy the found UID bytes from buffer[] to uid->uidByte[]
-				index = (buffer[2] == PICC_Command::CT) ? 3 : 2; // source index in buffer[]
-				bytesToCopy	= (buffer[2] == PICC_Command::CT) ? 3 : 4;
-				for(count = 0; count < bytesToCopy; count++) {
-					uid->uid_byte[uidIndex + count] = buffer[index++];
+				// We do not check the BCC - it was constructed by us above.
+
+				// Copy the found UID bytes from buffer[] to uid.uid_byte[]
+				index = (buffer[2] == CT) ? 3 : 2;  // source index in buffer[]
+				bytes = (buffer[2] == CT) ? 3 : 4;
+				for(uint8_t i = 0; i < bytes; ++i) {
+					uid.uid_byte[uid_idx + i] = buffer[index++];
 				}
-		
+
 				// Check response SAK (Select Acknowledge)
-				if(responseLength != 3 || txLastBits != 0) { // SAK must be exactly 24 bits (1 byte + CRC_A).
+				if(resp_len != 3 || last_bits != 0) {  // SAK must be exactly 24 bits (1 byte + CRC_A).
 					return status::ERROR;
 				}
-				// Verify CRC_A - do our own calculation and store the control in buffer[2..3]
-				// - those bytes are not needed anymore.
-				uint16_t crc;
-				auto result = calculate_CRC_(responseBuffer, 1, crc);
-				if(result != status::OK) {
-					return result;
-				}
-				uint16_t res = (static_cast<uint16_t>(responseBuffer[1]) << 8) | responseBuffer[2];
-				if(crc != res) {
+				// Verify CRC_A (LSB first)
+				uint16_t crc = crc_a_(resp, 1);
+				if((crc & 0xff) != resp[1] || (crc >> 8) != resp[2]) {
 					return status::CRC_WRONG;
 				}
-				if(responseBuffer[0] & 0x04) { // Cascade bit set - UID not complete yes
-					cascadeLevel++;
+				if(resp[0] & 0x04) {  // Cascade bit set - UID not complete yes
+					++cascade;
 				} else {
-					uidComplete = true;
-					uid->sak = responseBuffer[0];
+					uid.sak = resp[0];
+					break;
 				}
 			}
 
-			// Set correct uid->size
-			uid->size = 3 * cascadeLevel + 1;
+			// Set correct uid.size
+			uid.size = 3 * cascade + 1;
 
 			return status::OK;
 		}
@@ -1011,11 +993,7 @@ namespace chip {
 			buffer[0] = static_cast<uint8_t>(PICC_Command::HLTA);
 			buffer[1] = 0;
 			// Calculate CRC_A
-			uint16_t crc;
-			auto st = calculate_CRC_(buffer, 2, crc);
-			if(st != status::OK) {
-				return st;
-			}
+			uint16_t crc = crc_a_(buffer, 2);
 	
 			// Send the command.
 			// The standard says:
@@ -1025,7 +1003,8 @@ namespace chip {
 			// We interpret that this way: Only STATUS_TIMEOUT is a success.
 			buffer[2] = crc & 0xff;
 			buffer[3] = crc >> 8;
-			st = transceive_data(buffer, sizeof(buffer), nullptr, 0);
+			uint8_t len = 0;
+			auto st = transceive_data(buffer, sizeof(buffer), nullptr, len);
 			if(st == status::TIMEOUT) {
 				return status::OK;
 			}
@@ -1036,6 +1015,30 @@ namespace chip {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	MIFARE ブロック（１６バイト）の読み出し @n
+					（MIFARE Classic は認証済みのセクターの場合）
+			@param[in]		block	ブロック番号（Ultralight はページ番号、４ページ分）
+			@param[out]		dst		バッファ（１８バイト以上、データ＋CRC_A）
+			@param[in,out]	size	バッファのサイズ、受信したバイト数
+			@return ステータス
+		 */
+		//-----------------------------------------------------------------//
+		status mifare_read(uint8_t block, uint8_t* dst, uint8_t& size)
+		{
+			if(dst == nullptr || size < 18) {
+				return status::NO_ROOM;
+			}
+			dst[0] = static_cast<uint8_t>(PICC_Command::MF_READ);
+			dst[1] = block;
+			uint16_t crc = crc_a_(dst, 2);
+			dst[2] = crc & 0xff;
+			dst[3] = crc >> 8;
+			return transceive_data(dst, 4, dst, size, nullptr, 0, true);
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	カード検出
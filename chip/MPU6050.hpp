@@ -1,7 +1,9 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	MPU6050 ジャイロ、加速度センサ・ドライバー
+	@brief	MPU6050 ジャイロ、加速度センサ・ドライバー @n
+			FIFO モードでは、サンプル・レートでセンサーが FIFO に書き込んだ @n
+			フレーム（加速度、ジャイロ）を、まとめて読み出してリングに格納する。
 	@author	平松邦仁 (hira@rvf-rc45.net)
 */
 //=====================================================================//
@@ -15,9 +17,10 @@ namespace chip {
 	/*!
 		@brief  MPU6050 テンプレートクラス
 		@param[in]	I2C_IO	i2c I/O クラス
+		@param[in]	FRAMES	FIFO モードのリング・バッファのフレーム数
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class I2C_IO>
+	template <class I2C_IO, uint8_t FRAMES = 8>
 	class MPU6050 {
 	public:
 		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
@@ -31,7 +34,22 @@ namespace chip {
 			int16_t z;
 		};
 
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	FIFO のフレーム（FIFO に並ぶ順）
+		 */
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct frame_t {
+			int16_vec	accel;
+			int16_vec	gyro;
+		};
+
 	private:
+		static const uint8_t FRAME_SIZE_ = 12;
+		static_assert(sizeof(frame_t) == FRAME_SIZE_, "frame_t must be packed");
+		static_assert(FRAMES >= 2, "FRAMES must be 2 or more");
+
 		// R/W ビットを含まない７ビット値
 		static const uint8_t MPU6050_ADR_ = 0x68;  // AD0 = 0; (GY-521 module default)
 //		static const uint8_t MPU6050_ADR_ = 0x69;  // AD0 = 1;
@@ -185,6 +203,29 @@ namespace chip {
 			};
 		};
 
+		struct FIFO_EN {
+			enum {
+				TEMP  = 0x80,
+				XG    = 0x40,
+				YG    = 0x20,
+				ZG    = 0x10,
+				ACCEL = 0x08,
+			};
+		};
+
+		struct USER_CTRL {
+			enum {
+				FIFO_EN    = 0x40,
+				FIFO_RESET = 0x04,
+			};
+		};
+
+		struct INT_STATUS {
+			enum {
+				FIFO_OFLOW = 0x10,
+			};
+		};
+
 		struct ACCEL_CONFIG {
 			enum {
 				XA_ST_BIT         = 7,
@@ -408,6 +449,11 @@ DMP_MEMORY_CHUNK_SIZE   16
 
 		I2C_IO& i2c_;
 
+		frame_t		frame_[FRAMES];
+		uint8_t		put_;
+		uint8_t		get_;
+		uint16_t	overflow_;
+
 		uint8_t recv_(REG reg) const {
 			uint8_t tmp[1];
 			tmp[0] = static_cast<uint8_t>(reg);
@@ -438,7 +484,7 @@ DMP_MEMORY_CHUNK_SIZE   16
 			tmp[0] = static_cast<uint8_t>(reg);
 			i2c_.send(MPU6050_ADR_, tmp, 1);
 			i2c_.recv(MPU6050_ADR_, &tmp[1], 1);
-			tmp[1] &= ((1 << len) - 1) << bpos;
+			tmp[1] &= ~(((1 << len) - 1) << bpos);
 			tmp[1] |= v << bpos;
  			i2c_.send(MPU6050_ADR_, tmp, 2);
 		}
@@ -469,6 +515,36 @@ DMP_MEMORY_CHUNK_SIZE   16
 		    vec.z = static_cast<int16_t>((tmp[4] << 8) | tmp[5]);
 		}
 
+		static void swap_(int16_vec& v) {
+			const uint8_t* p = reinterpret_cast<const uint8_t*>(&v);
+			int16_t x = static_cast<int16_t>((p[0] << 8) | p[1]);
+			int16_t y = static_cast<int16_t>((p[2] << 8) | p[3]);
+			int16_t z = static_cast<int16_t>((p[4] << 8) | p[5]);
+			v.x = x;
+			v.y = y;
+			v.z = z;
+		}
+
+		void reset_fifo_() {
+			send_(REG::USER_CTRL, 0);
+			send_(REG::USER_CTRL, USER_CTRL::FIFO_RESET);
+			send_(REG::USER_CTRL, USER_CTRL::FIFO_EN);
+		}
+
+		// FIFO のフレームをリングに直接読み込んで、エンディアンを変換する
+		void read_frames_(uint8_t n) {
+			uint8_t tmp[1];
+			tmp[0] = static_cast<uint8_t>(REG::FIFO_R_W);
+			i2c_.send(MPU6050_ADR_, tmp, 1);
+			i2c_.recv(MPU6050_ADR_, reinterpret_cast<uint8_t*>(&frame_[put_]), n * FRAME_SIZE_);
+			for(uint8_t i = 0; i < n; ++i) {
+				swap_(frame_[put_].accel);
+				swap_(frame_[put_].gyro);
+				++put_;
+				if(put_ >= FRAMES) put_ = 0;
+			}
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -476,7 +552,7 @@ DMP_MEMORY_CHUNK_SIZE   16
 			@param[in]	i2c	iica_io クラスを参照で渡す
 		 */
 		//-----------------------------------------------------------------//
-		MPU6050(I2C_IO& i2c) : i2c_(i2c) { }
+		MPU6050(I2C_IO& i2c) : i2c_(i2c), frame_{ }, put_(0), get_(0), overflow_(0) { }
 
 		void set_sleep_enable(bool f) { set_bit_(REG::PWR_MGMT_1, PWR1::SLEEP_BIT, f); }
 
@@ -555,6 +631,101 @@ DMP_MEMORY_CHUNK_SIZE   16
 			get_vec_(REG::GYRO_XOUT_H, vec);
 			return vec;
 		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	FIFO モードの開始 @n
+					DLPF（帯域 42Hz）を有効にして、内部レート 1KHz を分周する。
+			@param[in]	rate	サンプル・レート（4 to 1000 [Hz]）
+			@return エラーなら「false」を返す
+		 */
+		//-----------------------------------------------------------------//
+		bool start_fifo(uint16_t rate) {
+			if(rate < 4 || rate > 1000) return false;
+
+			send_(REG::FIFO_EN, 0);
+			send_(REG::CONFIG, 0x03);  // DLPF_CFG: 42Hz
+			send_(REG::SMPLRT_DIV, 1000 / rate - 1);
+
+			put_ = 0;
+			get_ = 0;
+			overflow_ = 0;
+			reset_fifo_();
+			send_(REG::FIFO_EN, FIFO_EN::ACCEL | FIFO_EN::XG | FIFO_EN::YG | FIFO_EN::ZG);
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	FIFO モードのサービス @n
+					FIFO に溜まったフレームを、リングの空きの分だけ、まとめて読み出す。@n
+					読み出しは、リングの連続した領域毎に１回の転送になる。@n
+					FIFO が溢れた場合は、FIFO をリセットする（get_overflow で数を確認）。
+			@return 読み出したフレーム数
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t service() {
+			uint8_t st;
+			get_8_(REG::INT_STATUS, st);
+			if(st & INT_STATUS::FIFO_OFLOW) {
+				++overflow_;
+				reset_fifo_();
+				return 0;
+			}
+
+			uint16_t cnt;
+			get_16_(REG::FIFO_COUNTH, cnt);
+			uint16_t n = cnt / FRAME_SIZE_;
+			uint8_t total = 0;
+			while(n > 0) {
+				uint8_t free = (get_ + FRAMES - put_ - 1) % FRAMES;
+				if(free == 0) break;  // 残りは FIFO に置いておく
+				uint8_t m = FRAMES - put_;
+				if(m > free) m = free;
+				if(m > n) m = n;
+				if(m > (255 / FRAME_SIZE_)) m = 255 / FRAME_SIZE_;
+				read_frames_(m);
+				n -= m;
+				total += m;
+			}
+			return total;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リングにあるフレーム数を取得
+			@return フレーム数
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t length() const { return (put_ + FRAMES - get_) % FRAMES; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リングからフレームを取得
+			@param[out]	frame	フレーム
+			@return フレームが無い場合「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool get(frame_t& frame) {
+			if(put_ == get_) return false;
+			frame = frame_[get_];
+			++get_;
+			if(get_ >= FRAMES) get_ = 0;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	FIFO の溢れた回数を取得
+			@return 溢れた回数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_overflow() const { return overflow_; }
 	};
 }
 
@@ -8,6 +8,7 @@
 				https://github.com/hirakuni45/R8C/blob/master/LICENSE
 */
 //=====================================================================//
+#include <cstdint>
 #include <cmath>
 
 namespace chip {
@@ -26,7 +27,9 @@ namespace chip {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
-		@brief  NTCTH テンプレートクラス
+		@brief  NTCTH テンプレートクラス @n
+				温度テーブル（折れ線近似）はコンパイル時に生成され、変換は @n
+				整数演算のみで行う（浮動小数点ライブラリを使わない）。
 		@param[in]	ADNUM	A/D 変換値の量子化最大値（１２ビットの場合４０９５ @n
 							１０ビットの場合、１０２３）
 		@param[in]	THM		サーミスタの型
@@ -40,62 +43,122 @@ namespace chip {
 		// サーミスタの型に応じたパラメーター
 		// THB:  B 定数
 		// TR25: ２５度における基準抵抗値
-		static void get_para_(float& THB, float& TR25)
+		static constexpr float get_thb_()
 		{
-			switch(THM) {
-			case thermistor::NT103_34G:
-				THB  = 3435.0f;  ///< サーミスタＢ定数
-				TR25 = 10e3;     ///< R25 サーミスタ２５℃基準抵抗値
-				break;
-			case thermistor::NT103_41G:
-				THB  = 4126.0f;  ///< サーミスタＢ定数
-				TR25 = 10e3;     ///< R25 サーミスタ２５℃基準抵抗値
-				break;
-			case thermistor::HX103_3380:
-				THB  = 3380.0f;  ///< サーミスタＢ定数
-				TR25 = 10e3;     ///< R25 サーミスタ２５℃基準抵抗値
-				break;
-			default:
-				break;
-			}
+			return THM == thermistor::NT103_34G ? 3435.0f
+				: THM == thermistor::NT103_41G ? 4126.0f
+				: THM == thermistor::HX103_3380 ? 3380.0f : 0.0f;
 		}
 
+		static constexpr float get_tr25_() { return 10e3f; }
+
+		static constexpr float T0 = 298.15f;   ///< 絶対温度
+
 		// サーミスターが VCC 側
-		static float thermistor_upper_(uint32_t raw)
+		static constexpr float thermistor_upper_(uint32_t raw)
 		{
-			if(raw == 0) return 0.0f;  // 零除算を避ける
-			float thr = (static_cast<float>(REFR * ADNUM) / static_cast<float>(raw)) - static_cast<float>(REFR);
-			return thr;
+			return (static_cast<float>(REFR * ADNUM) / static_cast<float>(raw)) - static_cast<float>(REFR);
 		}
 
 		// サーミスターが GND 側
-		static float thermistor_lower_(uint32_t raw)
+		static constexpr float thermistor_lower_(uint32_t raw)
 		{
-			float thr = static_cast<float>(REFR * raw) / static_cast<float>(ADNUM - raw);
-			return thr;
+			return static_cast<float>(REFR * raw) / static_cast<float>(ADNUM - raw);
 		}
 
+		// コンパイル時に使う自然対数（2^e * m に分解して atanh 級数）
+		static constexpr double ln_(double x)
+		{
+			int e = 0;
+			while(x > 1.5) { x *= 0.5; ++e; }
+			while(x < 0.75) { x *= 2.0; --e; }
+			double y = (x - 1.0) / (x + 1.0);
+			double y2 = y * y;
+			double s = 0.0;
+			for(int k = 1; k < 24; k += 2) {
+				s += y / k;
+				y *= y2;
+			}
+			return 2.0 * s + e * 0.69314718055994531;
+		}
+
+		// テーブルの区間数は６４、区間幅は２のべき乗
+		static constexpr uint8_t shift_()
+		{
+			uint8_t n = 0;
+			while((static_cast<uint32_t>(64) << n) < (ADNUM + 1)) ++n;
+			return n;
+		}
+		static constexpr uint8_t SHIFT = shift_();
+		static constexpr uint8_t NUM = static_cast<uint8_t>(((ADNUM + 1) + (1 << SHIFT) - 1) >> SHIFT);
+
+		// 0.01 度単位の温度（int16_t の範囲で飽和）
+		static constexpr int16_t temp_(uint32_t raw)
+		{
+			// 両端（零除算）は１つ内側の値で代用する
+			if(raw < 1) raw = 1;
+			if(raw > (ADNUM - 1)) raw = ADNUM - 1;
+			double thr = thup ? thermistor_upper_(raw) : thermistor_lower_(raw);
+			double t = 1.0 / (ln_(thr / get_tr25_()) / get_thb_() + (1.0 / T0)) - 273.15;
+			t *= 100.0;
+			if(t >  32767.0) t =  32767.0;
+			if(t < -32768.0) t = -32768.0;
+			return static_cast<int16_t>(t < 0.0 ? t - 0.5 : t + 0.5);
+		}
+
+		struct table_t {
+			int16_t	t[NUM + 1];
+		};
+
+		static constexpr table_t make_table_()
+		{
+			table_t tb { };
+			for(uint16_t i = 0; i <= NUM; ++i) {
+				tb.t[i] = temp_(static_cast<uint32_t>(i) << SHIFT);
+			}
+			return tb;
+		}
+
+		static constexpr table_t table_ = make_table_();
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	() オペレーター
+			@brief	() オペレーター（テーブル参照、整数演算）
 			@param[in]	adn		A/D 変換値
+			@return 温度（0.01 度単位）
 		 */
 		//-----------------------------------------------------------------//
-		float operator () (uint16_t adn) const
+		int16_t operator () (uint16_t adn) const
 		{
-			float thr;
-			if(thup) {
-				thr = thermistor_upper_(adn);
-			} else {
-				thr = thermistor_lower_(adn);
-			}
-			float THB;
-			float TR25;
-			get_para_(THB, TR25);
-			static const float T0 = 298.15f;   ///< 絶対温度
-			float t = 1.0f / (std::log(thr / TR25) / THB + (1.0f / T0));
+			if(adn > ADNUM) adn = ADNUM;
+			uint16_t idx = adn >> SHIFT;
+			int32_t a = table_.t[idx];
+			int32_t b = table_.t[idx + 1];
+			int32_t f = adn & ((1 << SHIFT) - 1);
+			return static_cast<int16_t>(a + (((b - a) * f) >> SHIFT));
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	浮動小数点による計算（基準値、検証用）
+			@param[in]	adn		A/D 変換値
+			@return 温度（度）
+		 */
+		//-----------------------------------------------------------------//
+		static float get_float(uint16_t adn)
+		{
+			if(thup && adn == 0) return -273.15f;  // 零除算を避ける
+			float thr = thup ? thermistor_upper_(adn) : thermistor_lower_(adn);
+			float t = 1.0f / (std::log(thr / get_tr25_()) / get_thb_() + (1.0f / T0));
 			return t - 273.15f;
 		}
 	};
+
+	template <uint32_t ADNUM, thermistor THM, uint32_t REFR, bool thup>
+	constexpr float NTCTH<ADNUM, THM, REFR, thup>::T0;
+
+	template <uint32_t ADNUM, thermistor THM, uint32_t REFR, bool thup>
+	constexpr typename NTCTH<ADNUM, THM, REFR, thup>::table_t NTCTH<ADNUM, THM, REFR, thup>::table_;
 }
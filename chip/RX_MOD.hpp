@@ -2,14 +2,22 @@
 //=====================================================================//
 /*!	@file
 	@brief	RX_MOD ドライバー @n
-			※「TX_MOD.hpp」とペア
+			※「TX_MOD.hpp」とペア @n
+			スロット周期の OVS 倍のタイマー割り込みで入力をサンプルし、 @n
+			エッジの位置でスロットの位相を合わせる（デジタル PLL）。 @n
+			スロットの中央で、その間にエッジがあったかを判定して復調する。 @n
+			（バイフェーズ・マーク符号なので、ビット毎に必ずエッジがある） @n
+			ヘッダーと同期を検出したら、長さ、データ、CRC-8 を受け取り、 @n
+			CRC が一致したフレームだけを受信バッファに入れる。
     @author 平松邦仁 (hira@rvf-rc45.net)
-	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+	@copyright	Copyright (C) 2017, 2021 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/R8C/blob/master/LICENSE
 */
 //=====================================================================//
 #include <cstdint>
+#include <cstring>
+#include "chip/TX_MOD.hpp"
 
 namespace chip {
 
@@ -19,26 +27,112 @@ namespace chip {
 		@param[in]	PORT	受信ポートクラス
 		@param[in]	HNUM	ヘッダー・フレーム数（標準４）
 		@param[in]	SNUM	転送最大数
+		@param[in]	OVS		オーバーサンプル数（スロット当たりの service 呼び出し回数）
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class PORT, uint8_t HNUM = 4, uint8_t SNUM = 4>
+	template <class PORT, uint8_t HNUM = 4, uint8_t SNUM = 4, uint8_t OVS = 8>
 	class RX_MOD {
 
-		volatile uint8_t	head_;
-		volatile uint8_t	sync_;
-		volatile uint8_t	len_;
-		uint8_t	dat_;
-		volatile uint8_t	bit_pos_;
+		static_assert(OVS >= 4 && (OVS & 1) == 0, "OVS must be even, 4 or more");
+		// bit_pos_ は８ビットで（長さ、データ、CRC）のビット数を数える
+		static_assert(SNUM >= 1 && SNUM <= 29, "SNUM must be 1 to 29");
+
+		static const uint8_t HALF = OVS / 2;
+
+		uint8_t		smp_;		// 過去３回のサンプル
+		uint8_t		level_;		// 多数決後のレベル
+		uint8_t		phase_;		// スロット内の位相（０がスロットの境界）
+		bool		edge_;		// 前の判定点からエッジがあった
+		bool		data_;		// データ受信中
+		uint8_t		run_;		// 連続したエッジ・スロット数（ヘッダー検出）
+		uint8_t		sync_;		// ヘッダーの後のエッジが無いスロット数
+		bool		half_;		// ビットの前半スロットを受けた
+		uint8_t		dat_;
+		uint8_t		bit_pos_;
+		uint8_t		work_[SNUM + 2];  // 長さ、データ、CRC
 
+		volatile uint8_t	len_;
 		uint8_t		buff_[SNUM];
 
+		volatile uint16_t	recv_count_;
+		volatile uint16_t	error_count_;
+		volatile uint16_t	lost_count_;
+
+		void frame_(uint8_t n) noexcept
+		{
+			data_ = false;
+			if(mod_crc8(work_, n - 1) != work_[n - 1]) {
+				++error_count_;
+				return;
+			}
+			if(len_ > 0) {  // 前のフレームが読まれていない
+				++lost_count_;
+				return;
+			}
+			std::memcpy(buff_, &work_[1], work_[0]);
+			len_ = work_[0];
+			++recv_count_;
+		}
+
+		void slot_(bool edge) noexcept
+		{
+			// ヘッダー（毎スロット反転）の後、同期（２スロット反転しない）を探す
+			// 同期はデータに現れないので、受信中に見つけた場合も新しいフレームとする
+			if(edge) {
+				if(sync_ > 0) {
+					run_ = 0;
+					sync_ = 0;
+				}
+				if(run_ < 255) ++run_;
+			} else if(run_ >= (HNUM - 1)) {
+				++sync_;
+				if(sync_ >= 2) {
+					run_ = 0;
+					sync_ = 0;
+					data_ = true;
+					half_ = false;
+					dat_ = 0;
+					bit_pos_ = 0;
+					return;
+				}
+			} else {
+				run_ = 0;
+			}
+			if(!data_) return;
+
+			if(!half_) {
+				if(!edge) {  // ビットの先頭にエッジが無い（符号違反）
+					data_ = false;
+					return;
+				}
+				half_ = true;
+				return;
+			}
+			half_ = false;
+
+			dat_ <<= 1;
+			if(edge) dat_ |= 1;
+			++bit_pos_;
+			if((bit_pos_ & 7) != 0) return;
+
+			uint8_t n = bit_pos_ >> 3;
+			work_[n - 1] = dat_;
+			if(n == 1) {
+				if(dat_ == 0 || dat_ > SNUM) data_ = false;
+			} else if(n == (work_[0] + 2)) {
+				frame_(n);
+			}
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	コンストラクター
 		 */
 		//-----------------------------------------------------------------//
-		RX_MOD() noexcept : head_(0), sync_(0), len_(0), dat_(0), bit_pos_(0) { }
+		RX_MOD() noexcept : smp_(0), level_(0), phase_(0), edge_(false), data_(false), run_(0),
+			sync_(0), half_(false), dat_(0), bit_pos_(0), work_{ 0 }, len_(0), buff_{ 0 },
+			recv_count_(0), error_count_(0), lost_count_(0) { }
 
 
 		//-----------------------------------------------------------------//
@@ -49,33 +143,103 @@ namespace chip {
 		void start() noexcept
 		{
 			PORT::DIR = 0;  // input
-			len_ = 0;
-			head_ = 0;
+			smp_ = 0;
+			level_ = 0;
+			phase_ = 0;
+			edge_ = false;
+			data_ = false;
+			run_ = 0;
 			sync_ = 0;
-			bit_pos_ = 0;
+			len_ = 0;
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	転送状態を取得
-			@return 転送中なら「true」
+			@brief	受信状態を取得
+			@return 受信データがあれば「true」
 		 */
 		//-----------------------------------------------------------------//
 		bool probe() const noexcept { return len_ > 0; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信データを取得
+			@param[out]	dst	受信データのコピー先（SNUM バイト以上）
+			@return 受信バイト数（受信データが無い場合０）
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t get(void* dst) noexcept
+		{
+			uint8_t len = len_;
+			if(len == 0) return 0;
+			std::memcpy(dst, buff_, len);
+			len_ = 0;
+			return len;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信したフレーム数を取得
+			@return フレーム数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_recv_count() const noexcept { return recv_count_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	CRC が一致しなかったフレーム数を取得
+			@return フレーム数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_error_count() const noexcept { return error_count_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	読まれる前に次が来て、捨てたフレーム数を取得
+			@return フレーム数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_lost_count() const noexcept { return lost_count_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	サービス @n
-					正確なタイマー割り込みで起動されるタスク
+					正確なタイマー割り込みで起動されるタスク @n
+					（TX_MOD の service の OVS 倍の周期で呼ぶ）
 		 */
 		//-----------------------------------------------------------------//
 		void service() noexcept
 		{
+			// ３サンプルの多数決（短いグリッチを除く）
+			smp_ = ((smp_ << 1) | (PORT::P() ? 1 : 0)) & 7;
+			uint8_t lvl = (smp_ == 3 || smp_ >= 5) ? 1 : 0;
+			if(lvl != level_) {
+				level_ = lvl;
+				edge_ = true;
+				// 位相の補正（ヘッダー検出中はエッジに合わせ、受信中は１つずつ）
+				if(!data_) {
+					phase_ = 0;
+				} else if(phase_ > 0 && phase_ < HALF) {
+					--phase_;
+				} else if(phase_ > HALF) {
+					++phase_;
+					if(phase_ >= OVS) phase_ = 0;
+				}
+			}
 
+			if(phase_ == HALF) {
+				slot_(edge_);
+				edge_ = false;
+			}
 
-
+			++phase_;
+			if(phase_ >= OVS) phase_ = 0;
 		}
 	};
 }
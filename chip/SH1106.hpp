@@ -24,6 +24,9 @@ namespace chip {
 	template <class CSI_IO, class CS, class DC, class RES, bool EXT_VCC = false>
 	class SH1106 {
 
+		/// 内部 RAM は 132 カラムで、128 ドットのパネルは 2 カラム目から表示される
+		static const uint8_t COLUMN_OFS_ = 2;
+
 		CSI_IO&	csi_;
 
 		enum class CMD : uint8_t {
@@ -50,6 +53,8 @@ namespace chip {
 
 			SETSTARTLINE		= 0x40,
 
+			SETPAGEADDR			= 0xB0,
+
 			MEMORYMODE			= 0x20,
 			COLUMNADDR			= 0x21,
 			PAGEADDR			= 0x22,
@@ -397,5 +402,68 @@ void Adafruit_SH1106::stopscroll(void){
 				write_cmd_(CMD::NORMALDISPLAY);
 			}
 		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ページ内の一部をコピー
+			@param[in]	src	フレームバッファソース（ページ先頭）
+			@param[in]	page	転送先ページ
+			@param[in]	x	開始カラム
+			@param[in]	w	カラム数
+		*/
+		//-----------------------------------------------------------------//
+		void copy_window(const uint8_t* src, uint8_t page, uint8_t x, uint8_t w)
+		{
+			uint8_t o = x + COLUMN_OFS_;
+			write_cmd_(static_cast<CMD>(static_cast<uint8_t>(CMD::SETPAGEADDR) | page));
+			write_cmd_(static_cast<CMD>(static_cast<uint8_t>(CMD::SETLOWCOLUMN) | (o & 0x0f)));
+			write_cmd_(static_cast<CMD>(static_cast<uint8_t>(CMD::SETHIGHCOLUMN) | (o >> 4)));
+			DC::P = 1;
+			CS::P = 0;
+			csi_.send(src + x, w);
+			CS::P = 1;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コピー
+			@param[in]	src	フレームバッファソース
+			@param[in]	num	転送ページ数
+			@param[in]	ofs	転送先オフセット
+		*/
+		//-----------------------------------------------------------------//
+		void copy(const uint8_t* src, uint8_t num, uint8_t ofs = 0)
+		{
+			for(uint8_t page = 0; page < num; ++page) {
+				copy_window(src, page + ofs, 0, 128);
+				src += 128;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  更新された領域だけをコピー（monograph の更新範囲を利用）
+			@param[in]	mono	monograph クラス
+			@param[in]	ofs	転送先オフセット
+		*/
+		//-----------------------------------------------------------------//
+		template <class MONO>
+		void flush_dirty(MONO& mono, uint8_t ofs = 0)
+		{
+			static_assert(MONO::plot_type::PAGE_LAYOUT, "PLOT must declare PAGE_LAYOUT");
+			const uint8_t* src = mono.at_plot().fb();
+			for(uint8_t page = 0; page < mono.get_page_num(); ++page) {
+				uint8_t x;
+				uint8_t w;
+				if(mono.get_dirty(page, x, w)) {
+					copy_window(src, page + ofs, x, w);
+				}
+				src += mono.get_width();
+			}
+			mono.reset_dirty();
+		}
 	};
 }
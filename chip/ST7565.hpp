@@ -218,5 +218,49 @@ namespace chip {
 			chip_enable_(false);
 		}
 
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ページ内の一部をコピー
+			@param[in]	src	フレームバッファソース（ページ先頭）
+			@param[in]	page	転送先ページ
+			@param[in]	x	開始カラム
+			@param[in]	w	カラム数
+		*/
+		//-----------------------------------------------------------------//
+		void copy_window(const uint8_t* src, uint8_t page, uint8_t x, uint8_t w) {
+			chip_enable_();
+			reg_select_(0);
+			write_(CMD::SET_COLUMN_LOWER, x & 0x0f);
+			write_(CMD::SET_COLUMN_UPPER, x >> 4);
+			write_(CMD::SET_PAGE, page);
+			reg_select_(1);
+			csi_.send(src + x, w);
+			reg_select_(0);
+			chip_enable_(false);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  更新された領域だけをコピー（monograph の更新範囲を利用）
+			@param[in]	mono	monograph クラス
+			@param[in]	ofs	転送先オフセット
+		*/
+		//-----------------------------------------------------------------//
+		template <class MONO>
+		void flush_dirty(MONO& mono, uint8_t ofs = 0) {
+			static_assert(MONO::plot_type::PAGE_LAYOUT, "PLOT must declare PAGE_LAYOUT");
+			const uint8_t* src = mono.at_plot().fb();
+			for(uint8_t page = 0; page < mono.get_page_num(); ++page) {
+				uint8_t x;
+				uint8_t w;
+				if(mono.get_dirty(page, x, w)) {
+					copy_window(src, page + ofs, x, w);
+				}
+				src += mono.get_width();
+			}
+			mono.reset_dirty();
+		}
 	};
 }
@@ -2,9 +2,14 @@
 //=====================================================================//
 /*!	@file
 	@brief	TX_MOD ドライバー @n
-			※「RX_MOD.hpp」とペア
+			※「RX_MOD.hpp」とペア @n
+			１ビットは２スロット（service の呼び出し２回）のバイフェーズ・マーク符号、 @n
+			ビットの先頭で必ず出力を反転し、「1」はビットの中央でも反転する。 @n
+			フレーム：ヘッダー（HNUM スロット、毎スロット反転）、 @n
+			同期（２スロット反転しない、データには現れない）、 @n
+			長さ（１バイト）、データ、CRC-8（長さとデータ）、MSB ファースト
     @author 平松邦仁 (hira@rvf-rc45.net)
-	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+	@copyright	Copyright (C) 2017, 2021 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/R8C/blob/master/LICENSE
 */
@@ -14,24 +19,51 @@
 
 namespace chip {
 
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	フレーム検査用 CRC-8（x^8 + x^2 + x + 1、初期値 0）
+		@param[in]	src	ソース
+		@param[in]	len	バイト数
+		@return CRC
+	*/
+	//-----------------------------------------------------------------//
+	inline uint8_t mod_crc8(const uint8_t* src, uint8_t len) noexcept
+	{
+		uint8_t crc = 0;
+		while(len > 0) {
+			crc ^= *src++;
+			for(uint8_t i = 0; i < 8; ++i) {
+				if(crc & 0x80) crc = (crc << 1) ^ 0x07;
+				else crc <<= 1;
+			}
+			--len;
+		}
+		return crc;
+	}
+
+
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
 		@brief  送信データ変調 テンプレートクラス
-		@param[in]	PORT	送信ポートクラス（標準４）※必ず偶数
-		@param[in]	HNUM	ヘッダー・フレーム数（標準４）
+		@param[in]	PORT	送信ポートクラス
+		@param[in]	HNUM	ヘッダー・フレーム数（標準４）※必ず偶数
 		@param[in]	SNUM	転送最大数
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	template <class PORT, uint8_t HNUM = 4, uint8_t SNUM = 4>
 	class TX_MOD {
 
+		static_assert((HNUM & 1) == 0 && HNUM >= 4, "HNUM must be even, 4 or more");
+		// bit_pos_ は８ビットで（長さ、データ、CRC）のビット数を数える
+		static_assert(SNUM >= 1 && SNUM <= 29, "SNUM must be 1 to 29");
+
 		volatile uint8_t	head_;
 		volatile uint8_t	sync_;
 		volatile uint8_t	len_;
 		uint8_t	dat_;
 		volatile uint8_t	bit_pos_;
 
-		uint8_t		buff_[SNUM];
+		uint8_t		buff_[SNUM + 2];  // 長さ、データ、CRC
 
 	public:
 		//-----------------------------------------------------------------//
@@ -82,19 +114,22 @@ namespace chip {
 		/*!
 			@brief	送信要求
 			@param[in]	src	送信ソース
-			@param[in]	len	送信バイト数
+			@param[in]	len	送信バイト数（1 to SNUM）
 			@return 送信開始なら「true」
 		 */
 		//-----------------------------------------------------------------//
 		bool send(const void* src, uint8_t len) noexcept
 		{
-			if(len > SNUM ) return false;
+			if(len == 0 || len > SNUM) return false;
+			if(len_ > 0) return false;  // 送信中
 
-			std::memcpy(buff_, src, len);
+			buff_[0] = len;
+			std::memcpy(&buff_[1], src, len);
+			buff_[len + 1] = mod_crc8(buff_, len + 1);
 			head_ = 0;
 			sync_ = 0;
 			bit_pos_ = 0;
-			len_ = len;
+			len_ = len + 2;
 			return true;
 		}
 
@@ -113,14 +148,14 @@ namespace chip {
 				PORT::P = head_ & 1;
 				++head_;
 			} else if(sync_ < 2) {
-				PORT::P = 0;
+				PORT::P = 1;  // ヘッダーの最後と同じレベル（反転しない）
 				++sync_;
-				dat_ = 2;
+				dat_ = 0;
 			} else if((bit_pos_ >> 3) < len_) {
 				static const uint8_t mask[8] = {
 					0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01
 				};
-				if(buff_[bit_pos_ >> 3] & mask[bit_pos_ & 7]) {
+				if(dat_ == 0 || (buff_[bit_pos_ >> 3] & mask[bit_pos_ & 7])) {
 					PORT::P = !PORT::P();
 				}
 				++dat_;
@@ -1,9 +1,12 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	VL53L0X ドライバー
+	@brief	VL53L0X ドライバー @n
+			計測の完了は「poll」で確認（待たない）、結果はリングに格納する。 @n
+			GPIO1 を外部割り込みに接続した場合、割り込みで「notify」を呼ぶと、 @n
+			「poll」は割り込みがあった時だけ I2C でアクセスする。
     @author 平松邦仁 (hira@rvf-rc45.net)
-	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+	@copyright	Copyright (C) 2017, 2021 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/R8C/blob/master/LICENSE
 */
@@ -18,12 +21,23 @@ namespace chip {
 	/*!
 		@brief  VL53L0X テンプレートクラス
 		@param[in]	I2C_IO	i2c I/O クラス
+		@param[in]	RING	計測結果リングの大きさ
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class I2C_IO>
+	template <class I2C_IO, uint8_t RING = 4>
 	class VL53L0X {
 	public:
 
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  計測結果
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct result_t {
+			uint16_t	range;	///< 距離（ミリメートル）
+			uint8_t		status;	///< レンジ・ステータス（0x0B が正常）
+		};
+
 		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 		/*!
 			@brief  シーケンスステップ許可、構造体
@@ -173,6 +187,15 @@ namespace chip {
 		bool		last_status_;
 		bool		did_timeout_;
 
+		result_t	ring_[RING];
+		uint8_t		put_;
+		uint8_t		get_;
+		uint16_t	lost_;
+		bool		use_irq_;
+		volatile bool	irq_;
+
+		static_assert(RING >= 2, "RING must be 2 or more");
+
 
 		void start_timeout_() {
 			timeout_start_ms_ = 0;
@@ -361,7 +384,8 @@ namespace chip {
 		VL53L0X(I2C_IO& i2c) : i2c_io_(i2c),
 			measurement_timing_budget_us_(0), timeout_start_ms_(0), io_timeout_(500), 
 			stop_variable_(0),
-			last_status_(true), did_timeout_(false) { }
+			last_status_(true), did_timeout_(false),
+			ring_{ }, put_(0), get_(0), lost_(0), use_irq_(false), irq_(false) { }
 
 
 		//-----------------------------------------------------------------//
@@ -1040,6 +1064,132 @@ namespace chip {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	単発計測の開始（完了を待たない、結果は「poll」で取得）
+		 */
+		//-----------------------------------------------------------------//
+		void start_single()
+		{
+			write_(static_cast<reg_addr>(0x80), 0x01);
+			write_(static_cast<reg_addr>(0xFF), 0x01);
+			write_(static_cast<reg_addr>(0x00), 0x00);
+			write_(static_cast<reg_addr>(0x91), stop_variable_);
+			write_(static_cast<reg_addr>(0x00), 0x01);
+			write_(static_cast<reg_addr>(0xFF), 0x00);
+			write_(static_cast<reg_addr>(0x80), 0x00);
+
+			write_(reg_addr::SYSRANGE_START, 0x01);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	GPIO1 割り込みを使うか設定 @n
+					使う場合、GPIO1（アクティブ Low）の立下りで「notify」を呼ぶ事。
+			@param[in]	ena	使う場合「true」
+		 */
+		//-----------------------------------------------------------------//
+		void set_interrupt(bool ena) {
+			use_irq_ = ena;
+			irq_ = ena;  // 取りこぼしを防ぐため、最初の「poll」は確認する
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	GPIO1 割り込みの通知（割り込みから呼ぶ）
+		 */
+		//-----------------------------------------------------------------//
+		void notify() { irq_ = true; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	計測完了の確認（待たない）@n
+					完了していない場合は、ステータスを１回読むだけで戻る。@n
+					完了していれば、結果をリングに格納して割り込みをクリアする。@n
+					リングが一杯の場合は、古い結果を捨てる（get_lost で数を確認）。
+			@return 新しい結果を格納したら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool poll()
+		{
+			if(use_irq_) {
+				if(!irq_) return false;
+				irq_ = false;
+			}
+
+			// I2C エラーの場合は、割り込みが残っているので次の「poll」で再確認する
+			uint8_t st = read_(reg_addr::RESULT_INTERRUPT_STATUS);
+			if(!last_status_) {
+				irq_ = true;
+				return false;
+			}
+			if((st & 0x07) == 0) return false;
+
+			// RESULT_RANGE_STATUS から、距離（+10）までを１回で読む
+			uint8_t tmp[12];
+			if(!read_(reg_addr::RESULT_RANGE_STATUS, tmp, sizeof(tmp))) {
+				irq_ = true;
+				return false;
+			}
+			// クリア出来なかった場合は、同じ結果を次の「poll」で読み直す
+			write_(reg_addr::SYSTEM_INTERRUPT_CLEAR, 0x01);
+			if(!last_status_) {
+				irq_ = true;
+				return false;
+			}
+
+			uint8_t next = put_ + 1;
+			if(next >= RING) next = 0;
+			if(next == get_) {
+				++get_;
+				if(get_ >= RING) get_ = 0;
+				++lost_;
+			}
+			ring_[put_].range = (static_cast<uint16_t>(tmp[10]) << 8) | tmp[11];
+			ring_[put_].status = (tmp[0] >> 3) & 0x0f;
+			put_ = next;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リングにある結果の数を取得
+			@return 結果の数
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t length() const { return (put_ + RING - get_) % RING; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リングから結果を取得
+			@param[out]	res	結果
+			@return 結果が無い場合「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool get(result_t& res)
+		{
+			if(put_ == get_) return false;
+			res = ring_[get_];
+			++get_;
+			if(get_ >= RING) get_ = 0;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リングから捨てた結果の数を取得
+			@return 捨てた数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_lost() const { return lost_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	連続モードでの距離の取得（ミリメートル）@n
@@ -4,11 +4,22 @@
 	@brief	NRF905 Single chip 433/868/915MHz Transceiver ドライバー @n
 			NORDIC SEMICONDUCTOR @n
 			https://infocenter.nordicsemi.com/pdf/nRF905_PS_v1.5.pdf @n
+			ShockBurst の固定長ペイロード（PW バイト）を、W_TX_PAYLOAD、 @n
+			R_RX_PAYLOAD でまとめて転送する。受信の完了は DR 端子、受信中は @n
+			AM 端子で判断し、SPI でステータスを読みに行かない。 @n
+			ペイロードの先頭にヘッダーを置き、ACK を要求するパケットは、 @n
+			ACK が返るまで「set_retry」の回数だけ再送する。 @n
+			ペイロードの形式： @n
+			[ctl][送信元アドレス（４バイト、LSB から）][len][data (PW - 6)] @n
+			ctl: bit7: ACK、bit6: ACK 要求、bit5-0: シーケンス番号 @n
+			周波数： (422.4 + CH_NO / 10) * (1 + HFREQ_PLL) [MHz]
 			Copyright 2020 Kunihito Hiramatsu
 	@author	平松邦仁 (hira@rvf-rc45.net)
 */
 //=====================================================================//
 #include <cstdint>
+#include <cstring>
+#include "common/delay.hpp"
 
 namespace chip {
 
@@ -16,14 +27,287 @@ namespace chip {
 	/*!
 		@brief  nRF905 テンプレートクラス
 		@param[in]	SPI		SPI クラス (MISO, MOSI, SCLK)
-		@param[in]	SS		SPI/SS クラス
+		@param[in]	SS		SPI/SS クラス（CSN）
+		@param[in]	CE		TRX_CE ポート
+		@param[in]	TXE		TX_EN ポート
+		@param[in]	PWR		PWR_UP ポート
+		@param[in]	DR		DR（Data Ready）ポート
+		@param[in]	AM		AM（Address Match）ポート（使わない場合 device::NULL_PORT）
+		@param[in]	PW		ペイロード幅（7 to 32）
+		@param[in]	RXN		受信リングの大きさ
+		@param[in]	TXN		送信キューの大きさ
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class SPI, class SS>
+	template <class SPI, class SS, class CE, class TXE, class PWR, class DR, class AM,
+		uint8_t PW = 32, uint8_t RXN = 4, uint8_t TXN = 2>
 	class nRF905 {
+	public:
+
+		static const uint8_t HEAD = 6;				///< ヘッダーのバイト数
+		static const uint8_t DATA_MAX = PW - HEAD;	///< １パケットの最大データ長
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  出力電力
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class PA : uint8_t {
+			M10DBM,	///< -10 dBm
+			M2DBM,	///<  -2 dBm
+			P6DBM,	///<  +6 dBm
+			P10DBM,	///< +10 dBm
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  クリスタル周波数
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class XTAL : uint8_t {
+			MHZ4,	///<  4 MHz
+			MHZ8,	///<  8 MHz
+			MHZ12,	///< 12 MHz
+			MHZ16,	///< 16 MHz
+			MHZ20,	///< 20 MHz
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  受信パケット
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct packet_t {
+			uint32_t	src;				///< 送信元アドレス
+			uint8_t		len;				///< データ長
+			uint8_t		data[DATA_MAX];		///< データ
+		};
+
+	private:
+		static_assert(PW > HEAD && PW <= 32, "PW must be 7 to 32");
+		static_assert(RXN >= 2, "RXN must be 2 or more");
+		static_assert(TXN >= 2, "TXN must be 2 or more");
+
+		static const uint8_t W_CONFIG       = 0x00;  // | adrs
+		static const uint8_t R_CONFIG       = 0x10;  // | adrs
+		static const uint8_t W_TX_PAYLOAD   = 0x20;
+		static const uint8_t W_TX_ADDRESS   = 0x22;
+		static const uint8_t R_RX_PAYLOAD   = 0x24;
+		static const uint8_t CHANNEL_CONFIG = 0x80;
+
+		static const uint8_t CFG_NUM  = 10;  // 設定レジスタの数
+		static const uint8_t CFG_ADRS = 5;   // RX_ADDRESS の位置
+
+		static const uint8_t CTL_ACK = 0x80;
+		static const uint8_t CTL_REQ = 0x40;
+		static const uint8_t CTL_SEQ = 0x3F;
+
+		static const uint8_t DUP_NUM = 4;  // 重複検出に覚える送信元の数
+
+		enum class TX : uint8_t {
+			NONE,
+			DATA,
+			ACK,
+		};
+
+		struct tx_t {
+			uint32_t	dst;
+			uint8_t		ctl;
+			uint8_t		len;
+			uint8_t		data[DATA_MAX];
+		};
+
+		struct dup_t {
+			uint32_t	src;
+			uint8_t		ctl;	// CTL_REQ が無ければ無効
+		};
 
 		SPI&		spi_;
 
+		uint32_t	addr_;
+		uint32_t	tx_addr_;	// 設定済みの TX_ADDRESS
+		uint8_t		buff_[PW];
+
+		packet_t	rx_[RXN];
+		uint8_t		rx_put_;
+		uint8_t		rx_get_;
+		tx_t		tx_[TXN];
+		uint8_t		tx_put_;
+		uint8_t		tx_get_;
+
+		dup_t		dup_[DUP_NUM];
+		uint8_t		dup_pos_;
+
+		uint32_t	ack_dst_;
+		uint8_t		ack_ctl_;
+		bool		ack_pend_;
+
+		TX			txs_;
+		uint16_t	tx_limit_;
+		bool		wait_ack_;
+		uint16_t	limit_;
+		uint8_t		seq_;
+		uint8_t		retry_;
+		uint8_t		retry_num_;
+		uint16_t	wait_;
+		uint8_t		rnd_;
+
+		volatile uint16_t	tick_;
+
+		uint16_t	send_count_;
+		uint16_t	retry_count_;
+		uint16_t	fail_count_;
+		uint16_t	dup_count_;
+		uint16_t	lost_;
+
+
+		void write_config_(uint8_t adrs, const void* src, uint8_t len) noexcept
+		{
+			SS::P = 0;
+			spi_.xchg(W_CONFIG | adrs);
+			spi_.send(src, len);
+			SS::P = 1;
+		}
+
+
+		void set_tx_address_(uint32_t dst) noexcept
+		{
+			if(dst == tx_addr_) return;
+			uint8_t tmp[4];
+			for(uint8_t i = 0; i < 4; ++i) tmp[i] = dst >> (i * 8);
+			SS::P = 0;
+			spi_.xchg(W_TX_ADDRESS);
+			spi_.send(tmp, sizeof(tmp));
+			SS::P = 1;
+			tx_addr_ = dst;
+		}
+
+
+		void rx_mode_() noexcept
+		{
+			TXE::P = 0;
+			CE::P = 1;
+		}
+
+
+		// buff_ のパケットを１回送信（完了で DR が High になる）
+		void transmit_(uint32_t dst) noexcept
+		{
+			CE::P = 0;
+			TXE::P = 1;
+			set_tx_address_(dst);
+			SS::P = 0;
+			spi_.xchg(W_TX_PAYLOAD);
+			spi_.send(buff_, PW);
+			SS::P = 1;
+			CE::P = 1;
+			utils::delay::micro_second(10);
+			CE::P = 0;  // 送信が終わると standby になる
+			tx_limit_ = tick_ + wait_;
+		}
+
+
+		void build_(uint8_t ctl, uint8_t len) noexcept
+		{
+			buff_[0] = ctl;
+			for(uint8_t i = 0; i < 4; ++i) buff_[1 + i] = addr_ >> (i * 8);
+			buff_[5] = len;
+		}
+
+
+		void send_ack_() noexcept
+		{
+			build_(ack_ctl_, 0);
+			ack_pend_ = false;
+			txs_ = TX::ACK;
+			transmit_(ack_dst_);
+		}
+
+
+		void send_data_() noexcept
+		{
+			const tx_t& t = tx_[tx_get_];
+			build_(t.ctl, t.len);
+			std::memcpy(&buff_[HEAD], t.data, t.len);
+			txs_ = TX::DATA;
+			transmit_(t.dst);
+		}
+
+
+		void pop_tx_() noexcept
+		{
+			++tx_get_;
+			if(tx_get_ >= TXN) tx_get_ = 0;
+			retry_ = 0;
+		}
+
+
+		bool duplicate_(uint32_t src, uint8_t ctl) noexcept
+		{
+			for(uint8_t i = 0; i < DUP_NUM; ++i) {
+				if(dup_[i].src != src || (dup_[i].ctl & CTL_REQ) == 0) continue;
+				if(dup_[i].ctl == ctl) return true;
+				dup_[i].ctl = ctl;
+				return false;
+			}
+			dup_[dup_pos_].src = src;
+			dup_[dup_pos_].ctl = ctl;
+			++dup_pos_;
+			if(dup_pos_ >= DUP_NUM) dup_pos_ = 0;
+			return false;
+		}
+
+
+		// DR が High の時、ペイロードを読む（読むと DR は Low になる）
+		bool recv_() noexcept
+		{
+			SS::P = 0;
+			spi_.xchg(R_RX_PAYLOAD);
+			spi_.recv(buff_, PW);
+			SS::P = 1;
+
+			uint8_t ctl = buff_[0];
+			uint32_t src = 0;
+			for(uint8_t i = 0; i < 4; ++i) src |= static_cast<uint32_t>(buff_[1 + i]) << (i * 8);
+
+			if(ctl & CTL_ACK) {
+				if(!wait_ack_) return false;
+				const tx_t& t = tx_[tx_get_];
+				if(src != t.dst || ((ctl ^ t.ctl) & CTL_SEQ) != 0) return false;
+				wait_ack_ = false;
+				++send_count_;
+				pop_tx_();
+				return false;
+			}
+
+			uint8_t len = buff_[5];
+			if(len > DATA_MAX) return false;
+			if(ctl & CTL_REQ) {  // ACK は重複しても返す（ACK が失われた場合）
+				ack_dst_ = src;
+				ack_ctl_ = CTL_ACK | (ctl & CTL_SEQ);
+				ack_pend_ = true;
+				if(duplicate_(src, ctl)) {
+					++dup_count_;
+					return false;
+				}
+			}
+
+			uint8_t next = rx_put_ + 1;
+			if(next >= RXN) next = 0;
+			if(next == rx_get_) {  // 一杯なら古いパケットを捨てる
+				++rx_get_;
+				if(rx_get_ >= RXN) rx_get_ = 0;
+				++lost_;
+			}
+			packet_t& p = rx_[rx_put_];
+			p.src = src;
+			p.len = len;
+			std::memcpy(p.data, &buff_[HEAD], len);
+			rx_put_ = next;
+			return true;
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -31,21 +315,302 @@ namespace chip {
 			@param[in]	spi	spi クラスを参照で渡す
 		 */
 		//-----------------------------------------------------------------//
-		nRF905(SPI& spi) : spi_(spi)
+		nRF905(SPI& spi) noexcept : spi_(spi), addr_(0), tx_addr_(0), buff_{ 0 },
+			rx_{ }, rx_put_(0), rx_get_(0), tx_{ }, tx_put_(0), tx_get_(0),
+			dup_{ }, dup_pos_(0), ack_dst_(0), ack_ctl_(0), ack_pend_(false),
+			txs_(TX::NONE), tx_limit_(0), wait_ack_(false), limit_(0), seq_(0), retry_(0),
+			retry_num_(3), wait_(20), rnd_(1), tick_(0),
+			send_count_(0), retry_count_(0), fail_count_(0), dup_count_(0), lost_(0)
 		{ }
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	開始
+			@brief	開始 @n
+					設定レジスタ（１０バイト）をまとめて書き込み、読み返して確認する。@n
+					成功すると受信モードになる。
+			@param[in]	addr	自分の（受信）アドレス
+			@param[in]	ch		チャネル（CH_NO: 0 to 511、433.2MHz: 108）
+			@param[in]	hfreq	868/915MHz 帯の場合「true」
+			@param[in]	pa		出力電力
+			@param[in]	xtal	クリスタル周波数
+			@return nRF905 が応答しない場合「false」
 		 */
 		//-----------------------------------------------------------------//
-		void start() noexcept
+		bool start(uint32_t addr, uint16_t ch = 108, bool hfreq = false, PA pa = PA::P10DBM,
+			XTAL xtal = XTAL::MHZ16) noexcept
 		{
+			SS::DIR = 1;
+			SS::P = 1;
+			CE::DIR = 1;
+			CE::P = 0;
+			TXE::DIR = 1;
+			TXE::P = 0;
+			PWR::DIR = 1;
+			DR::DIR = 0;
+			AM::DIR = 0;
+
+			PWR::P = 1;
+			utils::delay::milli_second(3);  // power down -> standby
+
+			uint8_t cfg[CFG_NUM];
+			cfg[0] = ch;
+			cfg[1] = (static_cast<uint8_t>(pa) << 2) | (hfreq ? 0x02 : 0x00) | ((ch >> 8) & 1);
+			cfg[2] = 0x44;  // TX_AFW, RX_AFW: ４バイト
+			cfg[3] = PW;    // RX_PW
+			cfg[4] = PW;    // TX_PW
+			for(uint8_t i = 0; i < 4; ++i) cfg[CFG_ADRS + i] = addr >> (i * 8);
+			cfg[9] = 0xC0 | (static_cast<uint8_t>(xtal) << 3);  // CRC16, UP_CLK 無効
+			write_config_(0, cfg, sizeof(cfg));
+
+			uint8_t tmp[CFG_NUM];
+			SS::P = 0;
+			spi_.xchg(R_CONFIG);
+			spi_.recv(tmp, sizeof(tmp));
+			SS::P = 1;
+			if(std::memcmp(cfg, tmp, sizeof(cfg)) != 0) {
+				return false;
+			}
+
+			addr_ = addr;
+			tx_addr_ = ~addr;
+			rx_put_ = rx_get_ = 0;
+			tx_put_ = tx_get_ = 0;
+			ack_pend_ = false;
+			wait_ack_ = false;
+			retry_ = 0;
+			rnd_ = addr | 1;
+			txs_ = TX::NONE;
+			rx_mode_();
+			return true;
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	チャネル、出力電力の設定（CHANNEL_CONFIG）
+			@param[in]	ch		チャネル（CH_NO: 0 to 511）
+			@param[in]	hfreq	868/915MHz 帯の場合「true」
+			@param[in]	pa		出力電力
+			@return 送信中の場合「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool set_channel(uint16_t ch, bool hfreq, PA pa) noexcept
+		{
+			if(txs_ != TX::NONE) return false;
+			CE::P = 0;  // standby で設定する
+			SS::P = 0;
+			spi_.xchg(CHANNEL_CONFIG | (static_cast<uint8_t>(pa) << 2)
+				| (hfreq ? 0x02 : 0x00) | ((ch >> 8) & 1));
+			spi_.xchg(ch);
+			SS::P = 1;
+			rx_mode_();
+			return true;
+		}
 
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	自分の（受信）アドレスの設定
+			@param[in]	addr	アドレス
+			@return 送信中の場合「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool set_address(uint32_t addr) noexcept
+		{
+			if(txs_ != TX::NONE) return false;
+			CE::P = 0;  // standby で設定する
+			uint8_t tmp[4];
+			for(uint8_t i = 0; i < 4; ++i) tmp[i] = addr >> (i * 8);
+			write_config_(CFG_ADRS, tmp, sizeof(tmp));
+			addr_ = addr;
+			rx_mode_();
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	再送の設定 @n
+					待ち時間は、パケットの往復（PW = 32 で約１５ミリ秒）より長くする事。
+			@param[in]	num		再送回数
+			@param[in]	wait	ACK を待つ時間（「tick」の回数）
+		 */
+		//-----------------------------------------------------------------//
+		void set_retry(uint8_t num, uint16_t wait) noexcept
+		{
+			retry_num_ = num;
+			wait_ = wait;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	時間の更新（タイマー割り込みなどから、一定周期で呼ぶ）
+		 */
+		//-----------------------------------------------------------------//
+		void tick() noexcept { ++tick_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	サービス（メインループから呼ぶ）@n
+					・送信の完了（DR）で受信モードに戻す @n
+					・受信（DR）したペイロードを読み、受信リングに移す @n
+					・ACK の返送、送信キューの送信、再送 @n
+					受信中（AM が High）は送信を始めない。
+			@return 受信したら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool service() noexcept
+		{
+			if(txs_ != TX::NONE) {
+				// 送信の完了（DR）を待つ、完了しない場合も待ち時間で受信に戻す
+				if(!DR::P() && static_cast<int16_t>(tick_ - tx_limit_) < 0) return false;
+				rx_mode_();
+				if(txs_ == TX::DATA) {
+					if(tx_[tx_get_].ctl & CTL_REQ) {
+						wait_ack_ = true;
+						rnd_ = rnd_ * 5 + 1;  // 衝突が続かないように、待ち時間をずらす
+						limit_ = tick_ + wait_ + (rnd_ % ((wait_ >> 2) + 1));
+					} else {
+						++send_count_;
+						pop_tx_();
+					}
+				}
+				txs_ = TX::NONE;
+				return false;
+			}
+
+			bool rx = false;
+			if(DR::P()) rx = recv_();
+
+			if(wait_ack_ && static_cast<int16_t>(tick_ - limit_) >= 0) {
+				wait_ack_ = false;
+				++retry_;
+				if(retry_ > retry_num_) {
+					++fail_count_;
+					pop_tx_();
+				} else {
+					++retry_count_;
+				}
+			}
+
+			if(AM::P() || DR::P()) return rx;
+
+			if(ack_pend_) {
+				send_ack_();
+			} else if(!wait_ack_ && tx_get_ != tx_put_) {
+				send_data_();
+			}
+			return rx;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信キューにパケットを積む
+			@param[in]	dst		送信先アドレス
+			@param[in]	src		データ
+			@param[in]	len		データ長（最大 DATA_MAX）
+			@param[in]	ack		ACK を待って再送する場合「true」
+			@return キューが一杯、又はデータが長い場合「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool post(uint32_t dst, const void* src, uint8_t len, bool ack = true) noexcept
+		{
+			if(len > DATA_MAX) return false;
+			uint8_t next = tx_put_ + 1;
+			if(next >= TXN) next = 0;
+			if(next == tx_get_) return false;
+			tx_t& t = tx_[tx_put_];
+			t.dst = dst;
+			t.ctl = (ack ? CTL_REQ : 0) | (seq_ & CTL_SEQ);
+			++seq_;
+			t.len = len;
+			std::memcpy(t.data, src, len);
+			tx_put_ = next;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信キューにあるパケットの数（送信中、ACK 待ちを含む）
+			@return パケットの数
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t tx_length() const noexcept { return (tx_put_ + TXN - tx_get_) % TXN; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信リングにあるパケットの数を取得
+			@return パケットの数
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t length() const noexcept { return (rx_put_ + RXN - rx_get_) % RXN; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信リングからパケットを取得
+			@param[out]	packet	パケット
+			@return パケットが無い場合「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool get(packet_t& packet) noexcept
+		{
+			if(rx_put_ == rx_get_) return false;
+			packet = rx_[rx_get_];
+			++rx_get_;
+			if(rx_get_ >= RXN) rx_get_ = 0;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信に成功した（ACK を受けた）パケットの数を取得
+			@return 数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_send_count() const noexcept { return send_count_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	再送の回数を取得
+			@return 回数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_retry_count() const noexcept { return retry_count_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	再送しても ACK が無く、捨てたパケットの数を取得
+			@return 数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_fail_count() const noexcept { return fail_count_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	重複して受信した（再送された）パケットの数を取得
+			@return 数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_dup_count() const noexcept { return dup_count_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信リングから捨てたパケットの数を取得
+			@return 捨てた数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_lost() const noexcept { return lost_; }
 	};
 }
-
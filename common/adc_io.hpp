@@ -23,7 +23,10 @@ namespace device {
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	template <class TASK>
 	class adc_io {
+	public:
+		typedef TASK task_type;
 
+	private:
 		static TASK	task_;
 		static volatile uint8_t intr_count_;
 
@@ -56,8 +59,9 @@ namespace device {
 			++intr_count_;
 			task_();
 			// IR 関係フラグは必ず mov 命令で・・
+			// （ADF だけをクリアし、ADIE は保持する、繰り返し変換で割り込みを継続）
 			volatile uint8_t r = ADICSR();
-			ADICSR = 0x00;
+			ADICSR = ADICSR.ADF.b(false) | (r & ADICSR.ADIE.b());
 		}
 
 	private:
@@ -166,6 +170,164 @@ namespace device {
 				return AD0();
 			}
 		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  TASK クラスの参照
+			@return TASK クラス
+		*/
+		//-----------------------------------------------------------------//
+		static TASK& at_task() noexcept { return task_; }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  A/D 連続変換、オーバーサンプリング・間引きタスク @n
+				adc_io の TASK として使い、繰り返し変換＋割り込みで動作させる。@n
+				割り込み毎に AD0/AD1 を積算し、(4^OVS * DEC) 回で１つの値を @n
+				リングに格納する（ボックスカー、１次の CIC と等価）。@n
+				結果は (10 + OVS) ビット、区間内の最小値、最大値（１０ビット）@n
+				も同時に記録する。
+		@param[in]	CHN		チャネル数（１：AD0、２：AD0、AD1）
+		@param[in]	OVS		オーバーサンプリングで増やすビット数
+		@param[in]	DEC		間引き（平均）数
+		@param[in]	SIZE	リングの大きさ（２のべき乗）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint8_t CHN, uint8_t OVS, uint16_t DEC, uint8_t SIZE = 4>
+	class adc_decimator {
+
+		static_assert(CHN == 1 || CHN == 2, "CHN must be 1 or 2");
+		static_assert(DEC > 0, "DEC must be > 0");
+		static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "SIZE must be power of 2");
+		static_assert((static_cast<uint32_t>(DEC) << (OVS * 2)) <= (static_cast<uint32_t>(1) << 22),
+			"Accumulator overflow (4^OVS * DEC)");
+
+	public:
+		static const uint32_t NUM = static_cast<uint32_t>(DEC) << (OVS * 2);	///< １出力あたりの変換回数
+		static const uint8_t BITS = 10 + OVS;	///< 出力のビット数
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  出力値
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct value_t {
+			uint16_t	val;	///< 間引き後の値（BITS ビット）
+			uint16_t	min;	///< 区間内の最小値（１０ビット）
+			uint16_t	max;	///< 区間内の最大値（１０ビット）
+		};
+
+	private:
+		uint32_t	sum_[CHN];
+		uint16_t	min_[CHN];
+		uint16_t	max_[CHN];
+		uint32_t	cnt_;
+
+		value_t		ring_[SIZE][CHN];
+		volatile uint8_t	put_;
+		volatile uint8_t	get_;
+		volatile uint8_t	lost_;
+
+		void clear_() noexcept {
+			for(uint8_t i = 0; i < CHN; ++i) {
+				sum_[i] = 0;
+				min_[i] = 0xffff;
+				max_[i] = 0;
+			}
+			cnt_ = 0;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		adc_decimator() noexcept : put_(0), get_(0), lost_(0) { clear_(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  割り込みタスク（変換終了毎）
+		*/
+		//-----------------------------------------------------------------//
+		void operator() () noexcept
+		{
+			for(uint8_t i = 0; i < CHN; ++i) {
+				uint16_t v = (i == 0) ? AD0() : AD1();
+				sum_[i] += v;
+				if(v < min_[i]) min_[i] = v;
+				if(v > max_[i]) max_[i] = v;
+			}
+			++cnt_;
+			if(cnt_ < NUM) return;
+
+			uint8_t n = (put_ + 1) & (SIZE - 1);
+			if(n == get_) {  // リングが一杯なら捨てる
+				++lost_;
+			} else {
+				for(uint8_t i = 0; i < CHN; ++i) {
+					value_t& t = ring_[put_][i];
+					t.val = (sum_[i] >> OVS) / DEC;
+					t.min = min_[i];
+					t.max = max_[i];
+				}
+				put_ = n;
+			}
+			clear_();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  積算とリングのリセット（変換停止中に呼ぶ事）
+		*/
+		//-----------------------------------------------------------------//
+		void reset() noexcept
+		{
+			clear_();
+			put_ = get_ = 0;
+			lost_ = 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  有効な出力数を取得
+			@return 有効な出力数
+		*/
+		//-----------------------------------------------------------------//
+		uint8_t length() const noexcept { return (put_ - get_) & (SIZE - 1); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  出力の取得
+			@param[out]	out		出力先（CHN 個）
+			@return 出力が無い場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool get(value_t* out) noexcept
+		{
+			if(put_ == get_) return false;
+			for(uint8_t i = 0; i < CHN; ++i) {
+				out[i] = ring_[get_][i];
+			}
+			get_ = (get_ + 1) & (SIZE - 1);
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  リングが一杯で捨てた数を取得（２５６で一周する）
+			@return 捨てた数
+		*/
+		//-----------------------------------------------------------------//
+		uint8_t get_lost() const noexcept { return lost_; }
 	};
 
 	// スタティック実態定義
@@ -165,6 +165,16 @@ namespace utils {
 		const char* get_command() const { return buff_; }
 
 
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  コマンド行の参照（書き換え可能） @n
+					※次の行の入力で上書きされる
+			@return コマンド行
+        */
+        //-----------------------------------------------------------------//
+		char* at_command() { return buff_; }
+
+
         //-----------------------------------------------------------------//
         /*!
             @brief  ワード数を取得
@@ -0,0 +1,287 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	テーブル駆動コマンド・シェル @n
+			コマンド名と引数形式を並べたテーブルで、コマンドを処理する。 @n
+			・１行を一度だけワードに分割 @n
+			・コマンド名は二分探索（テーブルは名前順、static_assert で検査） @n
+			・引数は形式に従い「utils::input」で変換して関数に渡す @n
+			引数形式の文字： @n
+			'd' ---> １０進の整数（int32_t） @n
+			'x' ---> １６進の整数（uint32_t） @n
+			'f' ---> 浮動小数点数（float、REAL が true の場合） @n
+			's' ---> ワード文字列 @n
+			'[' ---> 以降の引数は省略可能 @n
+			'*' ---> 直前の形式を繰り返す（最後に置く）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstring>
+#include "common/command.hpp"
+#include "common/input.hpp"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  コマンド引数
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct command_arg {
+		union {
+			int32_t		i;	///< 'd'
+			uint32_t	u;	///< 'x'
+			float		f;	///< 'f'
+			const char*	s;	///< 's'（行の処理中だけ有効）
+		};
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  コマンド・テーブルの要素
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct command_entry {
+		typedef void (*func_type)(const command_arg* arg, uint8_t num);
+
+		const char*	name;	///< コマンド名
+		const char*	form;	///< 引数形式
+		func_type	func;	///< 処理関数
+		const char*	help;	///< 引数の説明（nullptr 可）
+	};
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  コマンド名の比較（constexpr）
+		@param[in]	a	文字列 A
+		@param[in]	b	文字列 B
+		@return A < B なら負、A == B なら０、A > B なら正
+	*/
+	//-----------------------------------------------------------------//
+	inline constexpr int command_name_cmp(const char* a, const char* b) {
+		while(*a != 0 && *a == *b) { ++a; ++b; }
+		return static_cast<int>(static_cast<uint8_t>(*a)) - static_cast<int>(static_cast<uint8_t>(*b));
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  コマンド・テーブルが名前順で、重複が無いか検査（constexpr）@n
+				static_assert(utils::command_sorted(table), "...");
+		@param[in]	tbl	コマンド・テーブル
+		@return 正しければ「true」
+	*/
+	//-----------------------------------------------------------------//
+	template <uint8_t N>
+	inline constexpr bool command_sorted(const command_entry (&tbl)[N]) {
+		for(uint8_t i = 1; i < N; ++i) {
+			if(command_name_cmp(tbl[i - 1].name, tbl[i].name) >= 0) return false;
+		}
+		return true;
+	}
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  コマンド・シェル・クラス
+		@param[in]	buffsize	行バッファのサイズ
+		@param[in]	ARGS		引数の最大数
+		@param[in]	REAL		浮動小数点の引数を使う場合「true」
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <int16_t buffsize, uint8_t ARGS = 8, bool REAL = false>
+	class command_shell {
+
+		command<buffsize>		cmd_;
+
+		const command_entry*	tbl_;
+		uint8_t					num_;
+
+		char*		word_[ARGS + 1];
+		command_arg	arg_[ARGS];
+
+		static void error_(const char* msg, const char* word) {
+			sci_puts(msg);
+			sci_puts(word);
+			sci_putch('\n');
+		}
+
+		// 先頭から n 個のワードの区切りを空白に戻す（エラー表示用）
+		void join_(uint8_t n) {
+			for(uint8_t i = 0; i < n; ++i) {
+				word_[i][std::strlen(word_[i])] = ' ';
+			}
+		}
+
+		// コマンドの行バッファを、その場でワードに分ける
+		uint8_t split_() {
+			char* p = cmd_.at_command();
+			uint8_t n = 0;
+			while(1) {
+				while(*p == ' ') ++p;
+				if(*p == 0) break;
+				if(n > ARGS) {
+					join_(n);
+					return 0xff;
+				}
+				word_[n] = p;
+				++n;
+				while(*p != 0 && *p != ' ') ++p;
+				if(*p == 0) break;
+				*p++ = 0;
+			}
+			return n;
+		}
+
+		const command_entry* find_(const char* name) const {
+			int16_t lo = 0;
+			int16_t hi = static_cast<int16_t>(num_) - 1;
+			while(lo <= hi) {
+				int16_t mid = (lo + hi) >> 1;
+				int c = std::strcmp(name, tbl_[mid].name);
+				if(c == 0) return &tbl_[mid];
+				else if(c < 0) hi = mid - 1;
+				else lo = mid + 1;
+			}
+			return nullptr;
+		}
+
+		static bool conv_(char t, const char* word, command_arg& arg) {
+			switch(t) {
+			case 'd':
+				return (input("%d", word) % arg.i).status();
+			case 'x':
+				return (input("%x", word) % arg.u).status();
+			case 'f':
+				if(REAL) {
+					return (input("%f", word) % arg.f).status();
+				}
+				return false;
+			case 's':
+				arg.s = word;
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		void usage_(const command_entry& e) const {
+			sci_puts(e.name);
+			if(e.help != nullptr) {
+				sci_putch(' ');
+				sci_puts(e.help);
+			}
+			sci_putch('\n');
+		}
+
+		void execute_(const command_entry& e, uint8_t argn) {
+			const char* f = e.form;
+			bool opt = false;
+			char last = 0;
+			uint8_t n = 0;
+			while(n < argn) {
+				char t = *f;
+				if(t == '[') {
+					opt = true;
+					++f;
+					continue;
+				} else if(t == '*') {
+					t = last;
+				} else if(t == 0) {
+					sci_puts("Too many arguments: ");
+					usage_(e);
+					return;
+				} else {
+					++f;
+				}
+				if(!conv_(t, word_[n + 1], arg_[n])) {
+					error_("Invalid argument: ", word_[n + 1]);
+					return;
+				}
+				last = t;
+				++n;
+			}
+			// 必須の引数が残っている
+			if(!opt && *f != 0 && *f != '[' && *f != '*') {
+				sci_puts("Too few arguments: ");
+				usage_(e);
+				return;
+			}
+			e.func(arg_, n);
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+			@param[in]	tbl	コマンド・テーブル（名前順）
+		*/
+		//-----------------------------------------------------------------//
+		template <uint8_t N>
+		command_shell(const command_entry (&tbl)[N]) : cmd_(), tbl_(tbl), num_(N),
+			word_{ nullptr }, arg_{ } { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  プロムプト文字列を設定
+			@param[in]	text	文字列
+		*/
+		//-----------------------------------------------------------------//
+		void set_prompt(const char* text) { cmd_.set_prompt(text); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コマンド入力クラスの参照
+			@return コマンド入力クラス
+		*/
+		//-----------------------------------------------------------------//
+		command<buffsize>& at_command() { return cmd_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  サービス @n
+					定期的に呼び出す、１行入力されたらコマンドを実行する。
+			@return １行を処理したら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool service() {
+			if(!cmd_.service()) return false;
+
+			uint8_t n = split_();
+			if(n == 0) return true;
+			if(n == 0xff) {
+				error_("Too many words: ", cmd_.get_command());
+				return true;
+			}
+
+			const command_entry* e = find_(word_[0]);
+			if(e == nullptr) {
+				join_(n - 1);
+				error_("Command error: ", cmd_.get_command());
+				return true;
+			}
+			execute_(*e, n - 1);
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コマンド一覧を表示
+		*/
+		//-----------------------------------------------------------------//
+		void list() const {
+			for(uint8_t i = 0; i < num_; ++i) {
+				usage_(tbl_[i]);
+			}
+		}
+	};
+}
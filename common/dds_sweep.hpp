@@ -0,0 +1,354 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	DDS 波形出力エンジン（スイープ、FSK/PSK） @n
+			チューニング・ワードを整数演算で前もって計算してキューに積み、 @n
+			タイマー割り込み（「itask」）で一定周期毎に DDS に書き込む。 @n
+			・リニア・スイープ（ワードを等間隔で増減） @n
+			・対数スイープ（ワードを一定の比率で増減、比率は整数の log2/exp2 で求める） @n
+			・シンボル列（FSK/PSK、シンボル毎にテーブルのワードを出力） @n
+			DDS の周波数を変えても位相アキュムレーターは保たれるので、位相は連続する。 @n
+			DDS は「freq_word(hz)」（static）と「load(word)」を持つクラス @n
+			（chip::AD9833、chip::AD985X） @n
+			※「load」は割り込みから呼ばれるので、動作中は DDS を他から操作しない事
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  DDS 波形出力エンジン・クラス
+		@param[in]	DDS		DDS クラス
+		@param[in]	QN		キューの大きさ
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class DDS, uint8_t QN = 32>
+	class dds_sweep {
+	public:
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  動作モード
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class MODE : uint8_t {
+			NONE,		///< 停止
+			LINEAR,		///< リニア・スイープ
+			LOG,		///< 対数スイープ
+			SYMBOL,		///< シンボル列（FSK/PSK）
+		};
+
+	private:
+		static_assert(QN >= 4, "QN must be 4 or more");
+
+		DDS&		dds_;
+
+		uint32_t	que_[QN];
+		volatile uint8_t	put_;
+		volatile uint8_t	get_;
+
+		volatile uint16_t	hold_;
+		volatile uint16_t	hold_cnt_;
+		volatile bool		run_;
+		volatile uint16_t	underrun_;
+
+		MODE		mode_;
+		bool		loop_;
+		uint16_t	steps_;
+		uint16_t	pos_;
+		uint32_t	w0_;
+		uint32_t	w1_;
+		uint64_t	wq_;	// 現在のワード（小数点以下１６ビット）
+		int64_t		step_;	// リニア: 増分（小数点以下１６ビット）
+		uint32_t	ratio_;	// 対数: 比率（小数点以下３１ビット）
+
+		const uint32_t*	sym_;
+		uint8_t		sym_num_;
+
+		// log2（小数点以下２４ビット）
+		static uint32_t log2_(uint32_t v) noexcept
+		{
+			uint8_t n = 31;
+			while((v & 0x80000000) == 0) {
+				v <<= 1;
+				--n;
+			}
+			uint32_t r = static_cast<uint32_t>(n) << 24;
+			uint64_t x = v;  // 1.0 to 2.0（小数点以下３１ビット）
+			for(uint32_t b = 1UL << 23; b != 0; b >>= 1) {
+				x = (x * x) >> 31;
+				if(x >= (2ULL << 31)) {
+					x >>= 1;
+					r |= b;
+				}
+			}
+			return r;
+		}
+
+		// exp2（0 <= f < 1、小数点以下３２ビット）、戻り値は小数点以下３１ビット
+		static uint32_t exp2_(uint32_t f) noexcept
+		{
+			static const uint32_t tbl[] = {  // 2^(2^-n)
+				0xB504F334, 0x9837F052, 0x8B95C1E4, 0x85AAC368,
+				0x82CD8699, 0x8164D1F4, 0x80B1ED50, 0x8058D7D3,
+				0x802C6437, 0x8016302F, 0x800B179D, 0x80058BAF,
+				0x8002C5D0, 0x800162E6, 0x8000B173, 0x800058B9,
+			};
+			uint64_t r = 1UL << 31;
+			for(uint8_t i = 0; i < 16; ++i) {
+				if(f & (0x80000000 >> i)) r = (r * tbl[i] + (1UL << 30)) >> 31;
+			}
+			// 下位１６ビットは 2^x = 1 + x * ln2 で近似（誤差 2^-33 以下）
+			uint32_t lo = ((f & 0xFFFF) * 45426UL) >> 16;  // ln2: 45426 / 65536
+			r += (r * lo) >> 32;
+			return r;
+		}
+
+		uint32_t word_() const noexcept { return (wq_ + 0x8000) >> 16; }
+
+		void reset_sweep_() noexcept
+		{
+			pos_ = 0;
+			wq_ = static_cast<uint64_t>(w0_) << 16;
+		}
+
+		void advance_() noexcept
+		{
+			++pos_;
+			if(pos_ > steps_) {
+				if(loop_) {
+					reset_sweep_();
+				} else {
+					mode_ = MODE::NONE;
+					run_ = false;
+				}
+			} else if(pos_ == steps_) {  // 誤差が残らないように、最後は終了ワード
+				wq_ = static_cast<uint64_t>(w1_) << 16;
+			} else if(mode_ == MODE::LINEAR) {
+				wq_ += step_;
+			} else {
+				// wq_ * ratio_（64 x 32 ビット）
+				uint32_t hi = wq_ >> 32;
+				uint32_t lo = wq_;
+				wq_ = ((static_cast<uint64_t>(hi) * ratio_) << 1)
+					+ ((static_cast<uint64_t>(lo) * ratio_ + (1UL << 30)) >> 31);
+			}
+		}
+
+		bool push_(uint32_t word) noexcept
+		{
+			uint8_t next = put_ + 1;
+			if(next >= QN) next = 0;
+			if(next == get_) return false;
+			que_[put_] = word;
+			put_ = next;
+			return true;
+		}
+
+		void begin_(MODE mode, uint32_t w0, uint32_t w1, uint16_t steps, bool loop) noexcept
+		{
+			run_ = false;
+			if(steps == 0) steps = 1;
+			w0_ = w0;
+			w1_ = w1;
+			steps_ = steps;
+			loop_ = loop;
+			reset_sweep_();
+			if(mode == MODE::LINEAR) {
+				step_ = (static_cast<int64_t>(w1_) - static_cast<int64_t>(w0_)) * 65536 / steps;
+			}
+			mode_ = mode;
+			run_ = true;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+			@param[in]	dds	DDS クラス
+		*/
+		//-----------------------------------------------------------------//
+		dds_sweep(DDS& dds) noexcept : dds_(dds), que_{ 0 }, put_(0), get_(0),
+			hold_(1), hold_cnt_(0), run_(false), underrun_(0),
+			mode_(MODE::NONE), loop_(false), steps_(0), pos_(0), w0_(0), w1_(0),
+			wq_(0), step_(0), ratio_(1UL << 31), sym_(nullptr), sym_num_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  １ワードを出力する割り込みの回数を設定
+			@param[in]	hold	割り込みの回数（１なら毎回）
+		*/
+		//-----------------------------------------------------------------//
+		void set_hold(uint16_t hold) noexcept { hold_ = hold == 0 ? 1 : hold; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  リニア・スイープの開始 @n
+					キューに残っているワードを出力した後、hz0 から hz1 まで @n
+					steps 回で変化する（steps + 1 ワード）。
+			@param[in]	hz0		開始周波数 [Hz]
+			@param[in]	hz1		終了周波数 [Hz]
+			@param[in]	steps	ステップ数
+			@param[in]	loop	繰り返す場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		void start_linear(uint32_t hz0, uint32_t hz1, uint16_t steps, bool loop = false) noexcept
+		{
+			begin_(MODE::LINEAR, DDS::freq_word(hz0), DDS::freq_word(hz1), steps, loop);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  対数スイープの開始 @n
+					１ステップの比率は、２倍（１オクターブ）未満である事。
+			@param[in]	hz0		開始周波数 [Hz]（０より大きい事）
+			@param[in]	hz1		終了周波数 [Hz]（０より大きい事）
+			@param[in]	steps	ステップ数
+			@param[in]	loop	繰り返す場合「true」
+			@return 範囲外の場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool start_log(uint32_t hz0, uint32_t hz1, uint16_t steps, bool loop = false) noexcept
+		{
+			uint32_t w0 = DDS::freq_word(hz0);
+			uint32_t w1 = DDS::freq_word(hz1);
+			if(w0 == 0 || w1 == 0 || steps == 0) return false;
+			// １ステップの log2（小数点以下３２ビット）
+			int64_t d = static_cast<int64_t>(log2_(w1)) - static_cast<int64_t>(log2_(w0));
+			int64_t p = d * 256 / steps;
+			if(p >= (1LL << 32) || p <= -(1LL << 32)) return false;
+			if(p >= 0) {
+				ratio_ = exp2_(p);
+			} else {
+				ratio_ = exp2_(p + (1LL << 32)) >> 1;
+			}
+			begin_(MODE::LOG, w0, w1, steps, loop);
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  シンボル列（FSK/PSK）の開始 @n
+					テーブルは、DDS の「freq_word」「phase_word」で作る。@n
+					シンボルは「put_symbol」で積み、「set_hold」の回数毎に出力される。
+			@param[in]	tbl		シンボル毎のワード
+			@param[in]	num		シンボルの数
+		*/
+		//-----------------------------------------------------------------//
+		void start_symbol(const uint32_t* tbl, uint8_t num) noexcept
+		{
+			run_ = false;
+			sym_ = tbl;
+			sym_num_ = num;
+			mode_ = MODE::SYMBOL;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  シンボルをキューに積む
+			@param[in]	sym		シンボル
+			@return キューが一杯、又はシンボル列の動作中で無い場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool put_symbol(uint8_t sym) noexcept
+		{
+			if(mode_ != MODE::SYMBOL || sym >= sym_num_) return false;
+			return push_(sym_[sym]);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  停止（キューに残っているワードは出力される）
+		*/
+		//-----------------------------------------------------------------//
+		void stop() noexcept
+		{
+			run_ = false;
+			mode_ = MODE::NONE;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  サービス（メインループから呼ぶ）@n
+					スイープのワードを計算して、キューが一杯になるまで積む。@n
+					キューの大きさ / 更新レートより短い間隔で呼ぶ事。
+			@return 積んだワードの数
+		*/
+		//-----------------------------------------------------------------//
+		uint8_t service() noexcept
+		{
+			uint8_t n = 0;
+			while(mode_ == MODE::LINEAR || mode_ == MODE::LOG) {
+				if(!push_(word_())) break;
+				advance_();
+				++n;
+			}
+			return n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  割り込みタスク（一定周期のタイマー割り込みから呼ぶ）
+		*/
+		//-----------------------------------------------------------------//
+		void itask() noexcept
+		{
+			if(hold_cnt_ > 1) {
+				--hold_cnt_;
+				return;
+			}
+			uint8_t g = get_;
+			if(g == put_) {
+				if(run_) ++underrun_;
+				hold_cnt_ = 0;
+				return;
+			}
+			dds_.load(que_[g]);
+			++g;
+			if(g >= QN) g = 0;
+			get_ = g;
+			hold_cnt_ = hold_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  動作モードを取得
+			@return 動作モード
+		*/
+		//-----------------------------------------------------------------//
+		MODE get_mode() const noexcept { return mode_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  キューにあるワードの数を取得
+			@return ワードの数
+		*/
+		//-----------------------------------------------------------------//
+		uint8_t length() const noexcept { return (put_ + QN - get_) % QN; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  スイープ中にキューが空になった（出力が遅れた）回数を取得
+			@return 回数
+		*/
+		//-----------------------------------------------------------------//
+		uint16_t get_underrun() const noexcept { return underrun_; }
+	};
+}
@@ -1,24 +1,143 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	delay ユーティリティー
+	@brief	delay ユーティリティー @n
+			待ち時間は F_CLK からコンパイル時にサイクル数として求め、 @n
+			サイクル数が決まったアセンブラ・ループで消費する。 @n
+			※割り込みが入った場合は、その分長くなる。 @n
+			長い待ちには、タイマーのカウントを使う「wait_until」、「wait_count」、「wait_timer」を使う。@n
+			※「wait_count」、「wait_timer」はティックのカウントとダウンカウンタを組み合わせ、@n
+			ティック（割り込み周期）以下の分解能で待つ
     @author 平松邦仁 (hira@rvf-rc45.net)
-	@copyright	Copyright (C) 2015, 2017 Kunihito Hiramatsu @n
+	@copyright	Copyright (C) 2015, 2021 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/R8C/blob/master/LICENSE
 */
 //=====================================================================//
 #include <cstdint>
 
+/// F_CLK は待ち時間の計算で必要で、設定が無いとエラーにします。
+#ifndef F_CLK
+#  error "delay.hpp requires F_CLK to be defined"
+#endif
+
 namespace utils {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
-		@brief  基準クロック２０ＭＨｚの待ち
+		@brief  F_CLK を基準にした待ち
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	struct delay {
 
+		static constexpr uint32_t CLOCK = F_CLK;	///< CPU クロック
+
+		/// ループ１回のサイクル数（ADD:Q.W: 1, JNZ（分岐成立）: 3）
+		static constexpr uint8_t LOOP_CYCLES = 4;
+		/// micro_second の１マイクロ秒毎の外側ループのサイクル数
+		static constexpr uint8_t OUTER_CYCLES = 6;
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ナノ秒をサイクル数に変換（切り上げ）
+			@param[in]	ns	時間（ナノ秒）
+			@return サイクル数
+		*/
+		//-----------------------------------------------------------------//
+		static constexpr uint32_t cycles_ns(uint32_t ns) {
+			return static_cast<uint32_t>((static_cast<uint64_t>(CLOCK) * ns + 999999999) / 1000000000);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  サイクル数をループ回数に変換（切り上げ）
+			@param[in]	cyc	サイクル数
+			@return ループ回数
+		*/
+		//-----------------------------------------------------------------//
+		static constexpr uint32_t loops(uint32_t cyc) {
+			return (cyc + LOOP_CYCLES - 1) / LOOP_CYCLES;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  １マイクロ秒のループ回数（外側ループ分を除く）
+			@return ループ回数
+		*/
+		//-----------------------------------------------------------------//
+		static constexpr uint16_t us_loops() {
+			return cycles_ns(1000) > OUTER_CYCLES ? loops(cycles_ns(1000) - OUTER_CYCLES) : 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  １ミリ秒のループ回数（外側ループ分を除く）
+			@return ループ回数
+		*/
+		//-----------------------------------------------------------------//
+		static constexpr uint16_t ms_loops() {
+			return loops(cycles_ns(1000000) - OUTER_CYCLES);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ナノ秒からループ回数への係数（小数点以下１６ビット、切り上げ）
+			@return 係数
+		*/
+		//-----------------------------------------------------------------//
+		static constexpr uint32_t ns_loops_q16() {
+			return static_cast<uint32_t>(
+				((static_cast<uint64_t>(CLOCK) << 16) + (static_cast<uint64_t>(LOOP_CYCLES) * 1000000000 - 1))
+				/ (static_cast<uint64_t>(LOOP_CYCLES) * 1000000000));
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ナノ秒をループ回数に変換（切り上げ）
+			@param[in]	ns	時間（ナノ秒）
+			@return ループ回数
+		*/
+		//-----------------------------------------------------------------//
+		static constexpr uint16_t ns_loops(uint16_t ns) {
+			return static_cast<uint16_t>((static_cast<uint32_t>(ns) * ns_loops_q16() + 0xffff) >> 16);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ループ（n == 0 の場合は何もしない）
+			@param[in]	n	ループ回数
+		*/
+		//-----------------------------------------------------------------//
+		static inline void loop(uint16_t n) {
+			if(n == 0) return;
+			asm volatile (
+				"1:\n\t"
+				"add.w #-1,%0\n\t"
+				"jnz 1b\n\t"
+				: "+r"(n)
+			);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ナノ秒単位の待ち（待ち時間が定数の場合）
+			@param[in]	NS	待ち時間（ナノ秒）
+		*/
+		//-----------------------------------------------------------------//
+		template <uint32_t NS>
+		static inline void nano_second() {
+			static_assert(loops(cycles_ns(NS)) <= 0xffff, "NS too large");
+			loop(loops(cycles_ns(NS)));
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  ナノ秒単位の待ち
@@ -26,11 +145,7 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		static void nano_second(uint16_t ns) {
-			ns /= 50;   ///< 20MHz clock base
-			while(ns > 0) {
-				asm("nop");
-				--ns;
-			}
+			loop(ns_loops(ns));
 		}
 
 
@@ -42,16 +157,7 @@ namespace utils {
 		//-----------------------------------------------------------------//
 		static void micro_second(uint16_t us) {
 			while(us > 0) {
-				asm("nop");
-				asm("nop");
-				asm("nop");
-				asm("nop");
-				asm("nop");
-				asm("nop");
-				asm("nop");
-				asm("nop");
-				asm("nop");
-				asm("nop");
+				loop(us_loops());
 				--us;
 			}
 		}
@@ -64,9 +170,88 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		static void milli_second(uint16_t ms) {
-			for(uint16_t i = 0; i < ms; ++i) {
-				micro_second(1000);
+			static_assert(loops(cycles_ns(1000000) - OUTER_CYCLES) <= 0xffff, "F_CLK too high");
+			while(ms > 0) {
+				loop(ms_loops());
+				--ms;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  タイマーのカウントが指定値になるまで待つ @n
+					TIMER は「get_count()」を持つクラス（device::trb_io など）@n
+					カウントの一周の半分以内の値を指定する事。@n
+					※カウントが target に進んだティックの境界で戻る。
+			@param[in]	tm		タイマー
+			@param[in]	target	待つカウント値
+		*/
+		//-----------------------------------------------------------------//
+		template <class TIMER, typename CNT>
+		static void wait_until(const TIMER& tm, CNT target) {
+			while(1) {
+				CNT d = target - static_cast<CNT>(tm.get_count());
+				if(d == 0 || (d >> (sizeof(CNT) * 8 - 1)) != 0) break;  // 到達、又は過ぎた
 			}
 		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  タイマーのダウンカウンタで n クロック分待つ @n
+					TIMER は「get_count()、get_timer()、get_limit()」を持つクラス @n
+					（device::trb_io を割り込みで使う場合）@n
+					１ティックは「get_limit() + 1」クロック。
+			@param[in]	tm		タイマー
+			@param[in]	n		ダウンカウンタのクロック数
+		*/
+		//-----------------------------------------------------------------//
+		template <class TIMER>
+		static void wait_timer(const TIMER& tm, uint32_t n) {
+			typedef decltype(tm.get_count()) CNT;
+			int32_t per = static_cast<int32_t>(tm.get_limit()) + 1;
+			CNT c0;
+			uint16_t t0;
+			read_timer_(tm, c0, t0);
+			uint32_t sum = 0;
+			while(sum < n) {
+				CNT c1;
+				uint16_t t1;
+				read_timer_(tm, c1, t1);
+				// タイマーはダウンカウント
+				int32_t d = static_cast<int32_t>(static_cast<CNT>(c1 - c0)) * per + t0 - t1;
+				// 負の場合、ダウンカウンタが再ロードされ、ティックの更新前なので、次で数える
+				if(d > 0) {
+					sum += d;
+					c0 = c1;
+					t0 = t1;
+				}
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  タイマーのティックで n 回分待つ @n
+					呼び出した時点から数え、ティックの途中でも n ティック分待つ。
+			@param[in]	tm		タイマー（wait_timer を参照）
+			@param[in]	n		ティック数
+		*/
+		//-----------------------------------------------------------------//
+		template <class TIMER>
+		static void wait_count(const TIMER& tm, uint16_t n) {
+			wait_timer(tm, static_cast<uint32_t>(n) * (static_cast<uint32_t>(tm.get_limit()) + 1));
+		}
+
+	private:
+		// カウントとダウンカウンタを組で読む（読む間にティックが進んだら読み直す）
+		template <class TIMER, typename CNT>
+		static void read_timer_(const TIMER& tm, CNT& c, uint16_t& t) {
+			do {
+				c = tm.get_count();
+				t = tm.get_timer();
+			} while(c != static_cast<CNT>(tm.get_count())) ;
+		}
 	};
 }
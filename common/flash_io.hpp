@@ -10,6 +10,7 @@
 //=====================================================================//
 #include "common/vect.h"
 #include "M120AN/flash.hpp"
+#include "M120AN/intr.hpp"
 
 namespace device {
 
@@ -31,9 +32,50 @@ namespace device {
 			BANK1,	///< 0x3400 to 0x37FF (1024)
 		};
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  バックグラウンド動作状態
+		*/
+		//-----------------------------------------------------------------//
+		enum class STATE : uint8_t {
+			IDLE,		///< 待機（完了）
+			ERASE,		///< ブロック消去中
+			SUSPEND,	///< ブロック消去サスペンド中
+			WRITE,		///< 書き込み中
+			ERROR,		///< エラー終了
+		};
+
 	private:
+		volatile STATE		state_;
+		volatile uint16_t	ofs_;
+		volatile uint16_t	end_;
+		const uint8_t* volatile	src_;
+		uint16_t			bank_;
+		uint8_t				level_;
+
 		void sleep_() const { asm("nop"); }
 
+		// FLASH_READY 割り込みが受け付けられない状態か検査 @n
+		// （I フラグが「０」、又は、IPL が割り込みレベル以上）
+		bool intr_blocked_() const {
+			uint16_t flg;
+			asm volatile ("stc flg,%0" : "=r" (flg));
+			if((flg & 0x0040) == 0) return true;
+			return ((flg >> 12) & 7) >= level_;
+		}
+
+		// 消去、書き込みの完了（又はサスペンド）を待つ @n
+		// 割り込みが受け付けられない場合は、FST7 をポーリングして itask を代行する
+		void wait_() {
+			while(state_ == STATE::ERASE || state_ == STATE::WRITE) {
+				if(intr_blocked_()) {
+					if(FST.FST7()) itask();
+				} else {
+					sleep_();
+				}
+			}
+		}
+
 		void sync_() const {
 			while(FST.FST7() == 0) {
 				sleep_();
@@ -76,13 +118,225 @@ namespace device {
 			return !ret;
 		}
 
+		void start_write_() const {
+			wr8_(0x3000 + ofs_, 0x40);
+			wr8_(0x3000 + ofs_, *src_);
+		}
+
+		void finish_(STATE st) {
+			FMR0.RDYSTIE = 0;
+			wr8_(0x3000, 0xff);
+			disable_(bank_);
+			FMR2.FMR20 = 0;
+			state_ = st;
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  コンストラクター
 		*/
 		//-----------------------------------------------------------------//
-		flash_io() { }
+		flash_io() : state_(STATE::IDLE), ofs_(0), end_(0), src_(nullptr), bank_(0), level_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  フラッシュ・レディ割り込みタスク @n
+					※「FLASH_READY_intr」関数から呼ぶ
+		*/
+		//-----------------------------------------------------------------//
+		void itask()
+		{
+			FST.RDYSTI = 0;
+
+			switch(state_) {
+			case STATE::ERASE:
+				if(FST.FST6()) {  // サスペンドによるレディ
+					state_ = STATE::SUSPEND;
+					break;
+				}
+				if(FST.FST5()) {
+					wr8_(0x3000, 0x50);  // ステータス消去
+					finish_(STATE::ERROR);
+				} else {
+					finish_(STATE::IDLE);
+				}
+				break;
+
+			case STATE::WRITE:
+				if(FST.FST4()) {
+					wr8_(0x3000, 0x50);  // ステータス消去
+					finish_(STATE::ERROR);
+					break;
+				}
+				++src_;
+				++ofs_;
+				if(ofs_ < end_) {
+					start_write_();
+				} else {
+					finish_(STATE::IDLE);
+				}
+				break;
+
+			default:
+				break;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  バックグラウンド消去開始 @n
+					※完了は「FLASH_READY_intr」経由で通知される
+			@param[in]	bank	バンク
+			@param[in]	level	割り込みレベル（１～７）
+			@return 開始出来ない場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool start_erase(DATA_AREA bank, uint8_t level = 1)
+		{
+			if(get_busy() || level == 0) return false;
+
+			uint16_t ofs;
+			if(bank == DATA_AREA::BANK0) {
+				ofs = 0x0000;
+			} else if(bank == DATA_AREA::BANK1) {
+				ofs = 0x0400;
+			} else {
+				return false;
+			}
+
+			bank_ = ofs;
+			state_ = STATE::ERASE;
+
+			level_ = level;
+			ILVL0.B45 = level;
+			di();
+			enable_(ofs);
+			FMR2.FMR20 = 1;  // サスペンド許可
+			FST.RDYSTI = 0;
+			FMR0.RDYSTIE = 1;
+			wr8_(0x3000,       0x20);  // ブロック消去
+			wr8_(0x3000 + ofs, 0xd0);
+			ei();
+
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  バックグラウンド書き込み開始 @n
+					※ソースは完了までを保持する事 @n
+					※書き込み範囲は同一バンク内に限る
+			@param[in]	src ソース
+			@param[in]	ofs	開始オフセット
+			@param[in]	len	バイト数
+			@param[in]	level	割り込みレベル（１～７）
+			@return 開始出来ない場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool start_write(const uint8_t* src, uint16_t ofs, uint16_t len, uint8_t level = 1)
+		{
+			if(get_busy() || level == 0 || len == 0) return false;
+			if(ofs >= 0x0800 || (ofs + len) > 0x0800) {
+				return false;
+			}
+			if((ofs & 0x0400) != ((ofs + len - 1) & 0x0400)) {
+				return false;
+			}
+
+			bank_ = ofs;
+			src_ = src;
+			ofs_ = ofs;
+			end_ = ofs + len;
+			state_ = STATE::WRITE;
+
+			level_ = level;
+			ILVL0.B45 = level;
+			di();
+			enable_(ofs);
+			FST.RDYSTI = 0;
+			FMR0.RDYSTIE = 1;
+			start_write_();
+			ei();
+
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  消去サスペンド要求 @n
+					※サスペンド中は、データフラッシュの読み出しが可能 @n
+					※割り込み禁止中（上位レベルの割り込み内を含む）は、FST7 をポーリングする
+			@return 消去中で無い場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool suspend()
+		{
+			if(state_ != STATE::ERASE) return false;
+
+			FMR2.FMR21 = 1;
+			wait_();
+			if(state_ == STATE::SUSPEND) {
+				wr8_(0x3000, 0xff);  // リードアレイ
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  消去再開
+			@return サスペンド中で無い場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool resume()
+		{
+			if(state_ != STATE::SUSPEND) return false;
+
+			di();
+			state_ = STATE::ERASE;
+			FMR2.FMR21 = 0;
+			ei();
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  動作状態の取得
+			@return 動作状態
+		*/
+		//-----------------------------------------------------------------//
+		STATE get_state() const { return state_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  バックグラウンド動作中か検査
+			@return 消去、書き込み中（サスペンド含む）なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool get_busy() const {
+			auto st = state_;
+			return st == STATE::ERASE || st == STATE::SUSPEND || st == STATE::WRITE;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  バックグラウンド動作の完了を同期 @n
+					※割り込み禁止中（上位レベルの割り込み内を含む）は、FST7 をポーリングする
+			@return エラー、又はサスペンド中なら「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool sync() {
+			wait_();
+			return state_ == STATE::IDLE;
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -101,6 +355,7 @@ namespace device {
 			} else {
 				return false;
 			}
+			if(get_busy()) return false;
 
 			di();
 			enable_(ofs);
@@ -169,7 +424,7 @@ namespace device {
 		*/
 		//-----------------------------------------------------------------//
 		bool write(uint16_t ofs, uint8_t data) const {
-			if(ofs >= 0x0800) {
+			if(ofs >= 0x0800 || get_busy()) {
 				return false;
 			}
 
@@ -196,7 +451,7 @@ namespace device {
 		*/
 		//-----------------------------------------------------------------//
 		bool write(const uint8_t* src, uint16_t ofs, uint16_t len) const {
-			if(ofs >= 0x0800 || (ofs + len) > 0x0800) {
+			if(ofs >= 0x0800 || (ofs + len) > 0x0800 || get_busy()) {
 				return false;
 			}
 
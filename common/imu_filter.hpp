@@ -0,0 +1,210 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	整数演算による姿勢推定（コンプリメンタリー・フィルター）@n
+			・ジャイロの角速度を積分し、加速度から求めた傾きで補正する @n
+			・角度の単位は 0.01 度（ロール、ピッチは ±18000、ヨーは積分のみ）@n
+			・浮動小数点を使わない（atan2、sqrt は整数近似）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  整数三角関数など
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct imath {
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  整数平方根
+			@param[in]	v	値
+			@return 平方根（切り捨て）
+		*/
+		//-----------------------------------------------------------------//
+		static uint16_t sqrt(uint32_t v) {
+			uint32_t r = 0;
+			uint32_t b = 1UL << 30;
+			while(b > v) b >>= 2;
+			while(b != 0) {
+				if(v >= r + b) {
+					v -= r + b;
+					r = (r >> 1) + b;
+				} else {
+					r >>= 1;
+				}
+				b >>= 2;
+			}
+			return r;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  atan2（誤差 約 0.11 度）@n
+					atan(x) = 45x + x(1 - x)(14.02 + 3.80x) [度]、0 <= x <= 1
+			@param[in]	y	Y
+			@param[in]	x	X
+			@return 角度（0.01 度、-18000 to 18000）
+		*/
+		//-----------------------------------------------------------------//
+		static int16_t atan2(int32_t y, int32_t x) {
+			if(x == 0 && y == 0) return 0;
+			uint32_t ax = x < 0 ? -x : x;
+			uint32_t ay = y < 0 ? -y : y;
+			bool swap = ay > ax;
+			uint32_t mn = swap ? ax : ay;
+			uint32_t mx = swap ? ay : ax;
+			// t = mn / mx（小数点以下１５ビット）
+			while(mx >= 0x10000) {
+				mx >>= 1;
+				mn >>= 1;
+			}
+			uint32_t t = (mn << 15) / mx;
+			uint32_t a = (4500 * t) >> 15;
+			a += (((t * (32768 - t)) >> 15) * (1402 + ((380 * t) >> 15))) >> 15;
+			int16_t deg = a;
+			if(swap) deg = 9000 - deg;
+			if(x < 0) deg = 18000 - deg;
+			if(y < 0) deg = -deg;
+			return deg;
+		}
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  姿勢推定クラス
+		@param[in]	SHIFT	加速度による補正の強さ（補正係数 1/2^SHIFT）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint8_t SHIFT = 5>
+	class imu_filter {
+
+		int32_t		roll_;	// 0.01 度、小数点以下８ビット
+		int32_t		pitch_;
+		int32_t		yaw_;
+		int16_t		gyro_k_;	// ジャイロ値を１サンプル毎の角度に変換する係数
+		int16_t		bias_[3];
+		bool		init_;
+
+		static const int32_t DEG180 = 18000L << 8;
+		static const int32_t DEG360 = 36000L << 8;
+
+		static int32_t wrap_(int32_t a) {
+			if(a > DEG180) a -= DEG360;
+			else if(a < -DEG180) a += DEG360;
+			return a;
+		}
+
+		static int32_t fuse_(int32_t a, int16_t acc) {
+			int32_t d = wrap_((static_cast<int32_t>(acc) << 8) - a);
+			return wrap_(a + (d >> SHIFT));
+		}
+
+		int32_t delta_(int16_t g, int16_t bias) const {
+			return (static_cast<int32_t>(g) - bias) * gyro_k_ >> 8;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		imu_filter() noexcept : roll_(0), pitch_(0), yaw_(0), gyro_k_(0),
+			bias_{ 0 }, init_(false) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  開始
+			@param[in]	rate	サンプル・レート [Hz]
+			@param[in]	lsb		ジャイロの感度 [LSB/(度/秒)]（±250 度/秒: 131）
+		*/
+		//-----------------------------------------------------------------//
+		void start(uint16_t rate, uint16_t lsb = 131) noexcept
+		{
+			// raw * gyro_k_ >> 8 で、0.01 度（小数点以下８ビット）
+			gyro_k_ = (100UL << 16) / (static_cast<uint32_t>(lsb) * rate);
+			roll_ = 0;
+			pitch_ = 0;
+			yaw_ = 0;
+			init_ = false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ジャイロのバイアス（静止時の値）を設定
+			@param[in]	vec	バイアス
+		*/
+		//-----------------------------------------------------------------//
+		template <class VEC>
+		void set_bias(const VEC& vec) noexcept
+		{
+			bias_[0] = vec.x;
+			bias_[1] = vec.y;
+			bias_[2] = vec.z;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  更新（サンプル毎に呼ぶ）
+			@param[in]	acc		加速度
+			@param[in]	gyro	ジャイロ
+		*/
+		//-----------------------------------------------------------------//
+		template <class VEC>
+		void update(const VEC& acc, const VEC& gyro) noexcept
+		{
+			int16_t ar = imath::atan2(acc.y, acc.z);
+			uint32_t yz = static_cast<int32_t>(acc.y) * acc.y + static_cast<int32_t>(acc.z) * acc.z;
+			int16_t ap = imath::atan2(-static_cast<int32_t>(acc.x), imath::sqrt(yz));
+			if(!init_) {
+				roll_ = static_cast<int32_t>(ar) << 8;
+				pitch_ = static_cast<int32_t>(ap) << 8;
+				init_ = true;
+				return;
+			}
+			roll_  = fuse_(wrap_(roll_ + delta_(gyro.x, bias_[0])), ar);
+			pitch_ = fuse_(wrap_(pitch_ + delta_(gyro.y, bias_[1])), ap);
+			yaw_   = wrap_(yaw_ + delta_(gyro.z, bias_[2]));
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ロール角を取得
+			@return ロール角（0.01 度）
+		*/
+		//-----------------------------------------------------------------//
+		int16_t get_roll() const noexcept { return roll_ >> 8; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ピッチ角を取得
+			@return ピッチ角（0.01 度）
+		*/
+		//-----------------------------------------------------------------//
+		int16_t get_pitch() const noexcept { return pitch_ >> 8; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ヨー角を取得（ジャイロの積分のみ、ドリフトする）
+			@return ヨー角（0.01 度）
+		*/
+		//-----------------------------------------------------------------//
+		int16_t get_yaw() const noexcept { return yaw_ >> 8; }
+	};
+}
@@ -12,50 +12,19 @@
 
 int main(int argc, char**argv);
 
-extern short _datainternal;
-extern short _datastart;
-extern short _dataend;
-
-extern short _bssstart;
-extern short _bssend;
-
 extern short _preinit_array_start;
 extern short _preinit_array_end;
 extern short _init_array_start;
 extern short _init_array_end;
-extern short _fini_array_start;
-extern short _fini_array_end;
 
 //-----------------------------------------------------------------//
 /*!
-	@brief  メイン関数起動前初期化
+	@brief  メイン関数起動前初期化 @n
+			.data のコピーと .bss のクリアは start.s で済ませてある。
 */
 //-----------------------------------------------------------------//
 void _init(void)
 {
-	{  // R/W-data セクションのコピー
-		short *src = &_datainternal;
-		short *dst = &_datastart;
-		while(dst < &_dataend) {
-			*dst++ = *src++;
-		}
-	}
-
-	{  // bss セクションのクリア
-		short *dst = &_bssstart;
-		while(dst < &_bssend) {
-			*dst++ = 0;
-		}
-	}
-
-	{  // C++ 静的コンストラクターの実行
-		short *p = &_fini_array_start;
-		while(p < &_fini_array_end) {
-			void (*prog)(void) = (void *)*p++;
-			(*prog)();
-		}
-	}
-
 	{  // C++ 事前静的コンストラクターの実行
 		short *p = &_preinit_array_start;
 		while(p < &_preinit_array_end) {
@@ -9,6 +9,10 @@
 */
 //=====================================================================//
 
+/// 起動時にクリアしない変数（リセット後も値を保つ、初期値は書けない）@n
+/// 例： static uint16_t boot_count_ NOINIT;
+#define NOINIT __attribute__ ((section (".noinit")))
+
 #ifdef __cplusplus
 extern "C" {
 #endif
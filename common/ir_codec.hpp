@@ -0,0 +1,400 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	赤外線リモコン・フォーマットのエンコーダー、デコーダー @n
+			・NEC（３８ＫＨｚ、３２ビット、リピート・コード） @n
+			・SONY SIRC（４０ＫＨｚ、１２／１５／２０ビット） @n
+			・Canon カメラ・リモコン（３２．７６８ＫＨｚ、即時／２秒後） @n
+			マーク（キャリア有り）とスペースの時間（マイクロ秒）の列で @n
+			扱い、ハードウェアに依存しない（ホストでも試験できる）。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  赤外線フレーム
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct ir_frame {
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  フォーマット
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class PROTO : uint8_t {
+			NONE,	///< 無し
+			NEC,	///< NEC（data: LSB から、アドレス、~アドレス、コマンド、~コマンド）
+			SONY,	///< SONY SIRC（data: 下位７ビットがコマンド、上位がアドレス）
+			CANON,	///< Canon（data: ０で即時、１で２秒後）
+		};
+
+		PROTO		proto;	///< フォーマット
+		uint8_t		bits;	///< ビット数（NEC: 32、SONY: 12/15/20、CANON: 0）
+		bool		repeat;	///< NEC のリピート・コード
+		uint32_t	data;	///< データ
+
+		ir_frame(PROTO p = PROTO::NONE, uint32_t d = 0, uint8_t b = 0) noexcept :
+			proto(p), bits(b), repeat(false), data(d) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  NEC フレームを作成
+			@param[in]	adr	アドレス
+			@param[in]	cmd	コマンド
+			@return フレーム
+		*/
+		//-----------------------------------------------------------------//
+		static ir_frame nec(uint8_t adr, uint8_t cmd) noexcept
+		{
+			uint32_t d = static_cast<uint32_t>(adr) | (static_cast<uint32_t>(adr ^ 0xff) << 8)
+				| (static_cast<uint32_t>(cmd) << 16) | (static_cast<uint32_t>(cmd ^ 0xff) << 24);
+			return ir_frame(PROTO::NEC, d, 32);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  SONY フレームを作成
+			@param[in]	adr		アドレス
+			@param[in]	cmd		コマンド（７ビット）
+			@param[in]	bits	ビット数（12/15/20）
+			@return フレーム
+		*/
+		//-----------------------------------------------------------------//
+		static ir_frame sony(uint16_t adr, uint8_t cmd, uint8_t bits = 12) noexcept
+		{
+			uint32_t d = (cmd & 0x7f) | (static_cast<uint32_t>(adr) << 7);
+			d &= (1UL << bits) - 1;
+			return ir_frame(PROTO::SONY, d, bits);
+		}
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  赤外線エンコーダー @n
+				マーク、スペースを交互に、一つずつ求める（バッファを使わない）。
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct ir_encoder {
+
+		static constexpr uint16_t NEC_LEAD_MARK  = 9000;
+		static constexpr uint16_t NEC_LEAD_SPACE = 4500;
+		static constexpr uint16_t NEC_REP_SPACE  = 2250;
+		static constexpr uint16_t NEC_UNIT       = 560;
+		static constexpr uint16_t NEC_ONE        = 1690;
+		static constexpr uint32_t NEC_PERIOD     = 108000;
+
+		static constexpr uint16_t SONY_LEAD      = 2400;
+		static constexpr uint16_t SONY_UNIT      = 600;
+		static constexpr uint32_t SONY_PERIOD    = 45000;
+
+		static constexpr uint16_t CANON_MARK     = 488;   ///< 32.768KHz x 16
+		static constexpr uint16_t CANON_NOW      = 7330;
+		static constexpr uint16_t CANON_DELAY    = 5360;
+		static constexpr uint32_t CANON_GAP      = 20000;
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  キャリア周波数を取得
+			@param[in]	f	フレーム
+			@return キャリア周波数 [Hz]
+		*/
+		//-----------------------------------------------------------------//
+		static uint16_t carrier(const ir_frame& f) noexcept
+		{
+			switch(f.proto) {
+			case ir_frame::PROTO::SONY:  return 40000;
+			case ir_frame::PROTO::CANON: return 32768;
+			default: return 38000;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  マーク、スペースの時間を取得 @n
+					偶数番目がマーク、奇数番目がスペース、最後のスペースは @n
+					次のフレームまでの間隔（フレーム周期から求める）。
+			@param[in]	f	フレーム
+			@param[in]	idx	番号
+			@return 時間 [us]（０で終り）
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t pulse(const ir_frame& f, uint8_t idx) noexcept
+		{
+			switch(f.proto) {
+			case ir_frame::PROTO::NEC:
+				if(f.repeat) {
+					static const uint16_t rep[3] = { NEC_LEAD_MARK, NEC_REP_SPACE, NEC_UNIT };
+					if(idx < 3) return rep[idx];
+					if(idx == 3) return NEC_PERIOD - (NEC_LEAD_MARK + NEC_REP_SPACE + NEC_UNIT);
+					return 0;
+				}
+				if(idx == 0) return NEC_LEAD_MARK;
+				if(idx == 1) return NEC_LEAD_SPACE;
+				idx -= 2;
+				if(idx < 64) {
+					if((idx & 1) != 0 && ((f.data >> (idx >> 1)) & 1) != 0) return NEC_ONE;
+					return NEC_UNIT;
+				}
+				if(idx == 64) return NEC_UNIT;
+				if(idx == 65) {
+					uint32_t t = NEC_LEAD_MARK + NEC_LEAD_SPACE + NEC_UNIT * 65UL;
+					for(uint8_t i = 0; i < 32; ++i) {
+						if((f.data >> i) & 1) t += NEC_ONE - NEC_UNIT;
+					}
+					return NEC_PERIOD - t;
+				}
+				return 0;
+
+			case ir_frame::PROTO::SONY:
+				if(f.bits == 0 || f.bits > 20) return 0;
+				if(idx == 0) return SONY_LEAD;
+				if(idx <= f.bits * 2) {
+					if((idx & 1) == 0 && ((f.data >> ((idx >> 1) - 1)) & 1) != 0) return SONY_UNIT * 2;
+					return SONY_UNIT;
+				}
+				if(idx == f.bits * 2 + 1) {
+					uint32_t t = SONY_LEAD + SONY_UNIT * 2UL * f.bits;
+					for(uint8_t i = 0; i < f.bits; ++i) {
+						if((f.data >> i) & 1) t += SONY_UNIT;
+					}
+					return SONY_PERIOD - t;
+				}
+				return 0;
+
+			case ir_frame::PROTO::CANON:
+				switch(idx) {
+				case 0:
+				case 2:  return CANON_MARK;
+				case 1:
+					if(f.data) return CANON_DELAY;
+					return CANON_NOW;
+				case 3:  return CANON_GAP;
+				default: return 0;
+				}
+
+			default:
+				return 0;
+			}
+		}
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  赤外線デコーダー @n
+				受信モジュールの出力から求めた、マーク、スペースの時間を @n
+				順に渡す。全てのフォーマットを同時に判定する。@n
+				無信号（タイムアウト）はスペース「IDLE」で渡す。
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class ir_decoder {
+	public:
+		static constexpr uint16_t IDLE = 0xffff;	///< 無信号
+
+	private:
+		enum class TASK : uint8_t {
+			IDLE,
+			NEC_LEAD,		// 9ms のマークの後
+			NEC_MARK,
+			NEC_SPACE,
+			NEC_REP,		// リピートのストップ・マーク待ち
+			SONY_SPACE,
+			SONY_MARK,
+			CANON_SPACE,
+			CANON_MARK,
+		};
+
+		TASK		task_;
+		uint8_t		bits_;
+		uint32_t	data_;
+		uint32_t	last_;		// 最後に受信した NEC のデータ
+		bool		last_ok_;
+
+		ir_frame	frame_;
+
+		// 受信モジュールでマークが伸び、スペースが縮むので、許容幅を広く取る
+		static bool near_(uint16_t t, uint16_t nom) noexcept
+		{
+			uint16_t d = t > nom ? t - nom : nom - t;
+			return d <= (nom >> 2) + 100;
+		}
+
+		static bool short_(uint16_t t) noexcept { return t >= 200 && t < 1000; }
+
+		bool emit_(ir_frame::PROTO p, uint8_t bits, uint32_t data, bool rep) noexcept
+		{
+			frame_.proto = p;
+			frame_.bits = bits;
+			frame_.data = data;
+			frame_.repeat = rep;
+			task_ = TASK::IDLE;
+			return true;
+		}
+
+		bool start_(uint16_t t) noexcept
+		{
+			task_ = TASK::IDLE;
+			if(near_(t, ir_encoder::NEC_LEAD_MARK)) {
+				task_ = TASK::NEC_LEAD;
+			} else if(near_(t, ir_encoder::SONY_LEAD)) {
+				task_ = TASK::SONY_SPACE;
+				bits_ = 0;
+				data_ = 0;
+			} else if(short_(t)) {
+				task_ = TASK::CANON_SPACE;
+			}
+			return false;
+		}
+
+		bool mark_(uint16_t t) noexcept
+		{
+			switch(task_) {
+			case TASK::NEC_MARK:
+				if(!short_(t)) break;
+				if(bits_ == 32) {
+					last_ = data_;
+					last_ok_ = true;
+					return emit_(ir_frame::PROTO::NEC, 32, data_, false);
+				}
+				task_ = TASK::NEC_SPACE;
+				return false;
+
+			case TASK::NEC_REP:
+				if(!short_(t)) break;
+				if(!last_ok_) {
+					task_ = TASK::IDLE;
+					return false;
+				}
+				return emit_(ir_frame::PROTO::NEC, 32, last_, true);
+
+			case TASK::SONY_MARK:
+				if(t < 200 || t >= 1800) break;
+				if(t >= 900) data_ |= 1UL << bits_;
+				++bits_;
+				if(bits_ == 20) {
+					return emit_(ir_frame::PROTO::SONY, 20, data_, false);
+				}
+				task_ = TASK::SONY_SPACE;
+				return false;
+
+			case TASK::CANON_MARK:
+				if(!short_(t)) break;
+				return emit_(ir_frame::PROTO::CANON, 0, data_, false);
+
+			default:
+				break;
+			}
+			// 期待しないマーク（リーダーかもしれない）
+			return start_(t);
+		}
+
+		bool space_(uint16_t t) noexcept
+		{
+			switch(task_) {
+			case TASK::NEC_LEAD:
+				if(near_(t, ir_encoder::NEC_LEAD_SPACE)) {
+					task_ = TASK::NEC_MARK;
+					bits_ = 0;
+					data_ = 0;
+					return false;
+				} else if(near_(t, ir_encoder::NEC_REP_SPACE)) {
+					task_ = TASK::NEC_REP;
+					return false;
+				}
+				break;
+
+			case TASK::NEC_SPACE:
+				if(t < 200 || t >= 2600) break;
+				if(t >= (ir_encoder::NEC_UNIT + ir_encoder::NEC_ONE) / 2) data_ |= 1UL << bits_;
+				++bits_;
+				task_ = TASK::NEC_MARK;
+				return false;
+
+			case TASK::SONY_SPACE:
+				if(t >= 200 && t < 1000) {
+					task_ = TASK::SONY_MARK;
+					return false;
+				} else if(t >= 1500) {  // フレームの終り
+					if(bits_ == 12 || bits_ == 15) {
+						return emit_(ir_frame::PROTO::SONY, bits_, data_, false);
+					}
+				}
+				break;
+
+			case TASK::CANON_SPACE:
+				if(t >= 4500 && t < 6300) {
+					data_ = 1;
+					task_ = TASK::CANON_MARK;
+					return false;
+				} else if(t >= 6300 && t < 8300) {
+					data_ = 0;
+					task_ = TASK::CANON_MARK;
+					return false;
+				}
+				break;
+
+			default:
+				break;
+			}
+			task_ = TASK::IDLE;
+			return false;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		ir_decoder() noexcept : task_(TASK::IDLE), bits_(0), data_(0), last_(0), last_ok_(false),
+			frame_() { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  リセット（NEC リピートの元も忘れる）
+		*/
+		//-----------------------------------------------------------------//
+		void reset() noexcept
+		{
+			task_ = TASK::IDLE;
+			last_ok_ = false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  マーク、又はスペースを渡す
+			@param[in]	mark	マークの場合「true」
+			@param[in]	t		時間 [us]（無信号は IDLE）
+			@return フレームを受信したら「true」（get で取得）
+		*/
+		//-----------------------------------------------------------------//
+		bool put(bool mark, uint16_t t) noexcept
+		{
+			if(mark) return mark_(t);
+			else return space_(t);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  受信したフレームを取得
+			@return フレーム
+		*/
+		//-----------------------------------------------------------------//
+		const ir_frame& get() const noexcept { return frame_; }
+	};
+}
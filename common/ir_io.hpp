@@ -0,0 +1,348 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	赤外線リモコン送受信（TimerRJ、TimerRC）@n
+			送信： @n
+			・TimerRJ のパルス出力（TRJIO 端子）でキャリアを作り、TOPCR で @n
+			  マーク、スペースを切り替える。 @n
+			・TimerRC のコンペア・マッチ A 割り込みで、次の切り替え時間を @n
+			  TRCGRA に加算する（時間が累積誤差を持たない）。 @n
+			受信： @n
+			・TimerRC のインプット・キャプチャー D（TRCIOD 端子、両エッジ）で @n
+			  エッジの時間を取り込み、割り込みでリングに積む。 @n
+			・コンペア・マッチ B を最後のエッジからのタイムアウトに使う。 @n
+			・「service()」でデコードし、受信フレームをキューに積む。 @n
+			TimerRC のカウント・ソースは F_CLK / 32（20MHz で 1.6us）、 @n
+			フリーランニングで使う。TimerRC 割り込みから「itask()」を呼ぶ事。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "common/vect.h"
+#include "M120AN/system.hpp"
+#include "M120AN/intr.hpp"
+#include "common/trc_io.hpp"
+#include "common/trj_io.hpp"
+#include "common/intr_utils.hpp"
+#include "common/ir_codec.hpp"
+
+/// F_CLK はタイマー周期計算で必要で、設定が無いとエラーにします。
+#ifndef F_CLK
+#  error "ir_io.hpp requires F_CLK to be defined"
+#endif
+
+namespace device {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  赤外線リモコン送受信クラス
+		@param[in]	RXN		エッジ・リングの大きさ
+		@param[in]	FRN		受信フレーム・キューの大きさ
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint8_t RXN = 32, uint8_t FRN = 4>
+	class ir_io {
+
+		static constexpr uint32_t TCLK = F_CLK / 32;	///< TimerRC のカウント周波数
+		static_assert(TCLK >= 100000, "F_CLK too low for ir_io");
+
+		/// マイクロ秒からカウントへの係数（小数点以下１２ビット）
+		static constexpr uint32_t US_K = ((TCLK << 12) + 500000) / 1000000;
+		/// カウントからマイクロ秒への係数（小数点以下１２ビット）
+		static constexpr uint32_t TK_K = ((1000000UL << 12) + TCLK / 2) / TCLK;
+
+		/// 受信のタイムアウト（NEC のリーダー 9ms より長く、フレーム間隔より短い）
+		static constexpr uint16_t RX_TIMEOUT = (12000UL * US_K) >> 12;
+
+		static constexpr uint16_t MARK_BIT = 0x8000;
+		static constexpr uint16_t TIME_MAX = 0x7fff;
+
+		typedef trj_io<utils::null_task> CARRIER;
+		CARRIER		carrier_;
+
+		// 送信
+		utils::ir_frame	tx_;
+		volatile uint8_t	tx_pos_;
+		volatile uint8_t	tx_rep_;
+		volatile bool		tx_busy_;
+		uint32_t			tx_rest_;	// 長いスペースの残り（カウント）
+
+		// 受信
+		volatile uint16_t	edge_[RXN];
+		volatile uint8_t	edge_put_;
+		volatile uint8_t	edge_get_;
+		uint16_t			cap_;
+		bool				mark_;		// 現在のレベル
+		bool				run_;
+
+		utils::ir_decoder	dec_;
+		utils::ir_frame		frame_[FRN];
+		uint8_t				frame_put_;
+		uint8_t				frame_get_;
+
+		uint16_t			lost_;
+
+		static uint32_t to_count_(uint32_t us) { return (us * US_K + 0x800) >> 12; }
+
+		static uint16_t to_us_(uint16_t cnt) {
+			if(cnt >= TIME_MAX) return utils::ir_decoder::IDLE;
+			return (static_cast<uint32_t>(cnt) * TK_K + 0x800) >> 12;
+		}
+
+		static void carrier_on_(bool on) { TRJIOC.TOPCR = !on; }
+
+		// 次のコンペア・マッチまで（最大 0x8000 カウント）
+		void step_(uint32_t cnt) {
+			uint16_t n = cnt > 0x8000 ? 0x8000 : cnt;
+			tx_rest_ = cnt - n;
+			TRCGRA = TRCGRA() + n;
+		}
+
+		void tx_task_() {
+			if(tx_rest_ > 0) {
+				step_(tx_rest_);
+				return;
+			}
+			uint32_t t = utils::ir_encoder::pulse(tx_, tx_pos_);
+			if(t == 0 && tx_rep_ > 0) {
+				--tx_rep_;
+				tx_pos_ = 0;
+				if(tx_.proto == utils::ir_frame::PROTO::NEC) tx_.repeat = true;
+				t = utils::ir_encoder::pulse(tx_, 0);
+			}
+			if(t == 0) {
+				carrier_on_(false);
+				TRCIER.IMIEA = 0;
+				tx_busy_ = false;
+				return;
+			}
+			carrier_on_((tx_pos_ & 1) == 0);
+			step_(to_count_(t));
+			++tx_pos_;
+		}
+
+		void put_edge_(uint16_t v) {
+			uint8_t next = edge_put_ + 1;
+			if(next >= RXN) next = 0;
+			if(next == edge_get_) return;  // 一杯なら捨てる（デコーダーはタイムアウトで戻る）
+			edge_[edge_put_] = v;
+			edge_put_ = next;
+		}
+
+		void rx_timeout_() {
+			if(run_) {
+				put_edge_((mark_ ? MARK_BIT : 0) | TIME_MAX);
+			}
+			mark_ = false;
+			run_ = false;
+			TRCIER.IMIEB = 0;
+		}
+
+		void rx_edge_() {
+			uint16_t cap = TRCGRD();
+			uint16_t d = cap - cap_;
+			cap_ = cap;
+			if(run_) {
+				if(d > TIME_MAX) d = TIME_MAX;
+				put_edge_((mark_ ? MARK_BIT : 0) | d);
+			}
+			// 受信モジュールの出力は交互に変化する、無信号の後はマークから
+			mark_ = !mark_;
+			run_ = true;
+			TRCGRB = cap + RX_TIMEOUT;
+			TRCIER.IMIEB = 1;
+		}
+
+		void put_frame_(const utils::ir_frame& f) {
+			uint8_t next = frame_put_ + 1;
+			if(next >= FRN) next = 0;
+			if(next == frame_get_) {  // 一杯なら古いフレームを捨てる
+				++frame_get_;
+				if(frame_get_ >= FRN) frame_get_ = 0;
+				++lost_;
+			}
+			frame_[frame_put_] = f;
+			frame_put_ = next;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		ir_io() noexcept : carrier_(), tx_(), tx_pos_(0), tx_rep_(0), tx_busy_(false), tx_rest_(0),
+			edge_{ 0 }, edge_put_(0), edge_get_(0), cap_(0), mark_(false), run_(false),
+			dec_(), frame_{ }, frame_put_(0), frame_get_(0), lost_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  開始 @n
+					TRJIO、TRCIOD 端子の設定（PORT_MAP）は、呼び出し側で行う。
+			@param[in]	ir_lvl	割り込みレベル（１～７）
+			@return 割り込みレベルが不正な場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool start(uint8_t ir_lvl) noexcept
+		{
+			if(ir_lvl == 0) return false;
+
+			// キャリア（出力は止めておく）
+			carrier_.pluse_out(38000, 0);
+			carrier_on_(false);
+
+			MSTCR.MSTTRC = 0;  // モジュールスタンバイ解除
+			TRCMR.CTS = 0;  // カウント停止
+
+			TRCCNT = 0x0000;
+			TRCMR = TRCMR.PWM2.b(1);  // タイマー・モード
+			// フリーランニング、F_CLK / 32
+			TRCCR1 = TRCCR1.CKS.b(static_cast<uint8_t>(trc_base::DIVIDE::F32));
+			// A, B: 端子を使わないアウトプット・コンペア
+			TRCIOR0 = TRCIOR0.IOA.b(0b000) | TRCIOR0.IOB.b(0b000) | 0b10001000;
+			// C: 未使用、D: インプット・キャプチャー（両エッジ）
+			TRCIOR1 = TRCIOR1.IOC.b(0b1000) | TRCIOR1.IOD.b(0b1110);
+			// TRCIOD のデジタル・フィルター（f32 で３回一致）
+			TRCDF = TRCDF.DFD.b(1) | TRCDF.DFCK.b(0b00);
+			TRCOER = TRCOER.EA.b(1) | TRCOER.EB.b(1) | TRCOER.EC.b(1) | TRCOER.ED.b(1);
+
+			tx_busy_ = false;
+			tx_rest_ = 0;
+			edge_put_ = edge_get_ = 0;
+			mark_ = false;
+			run_ = false;
+			dec_.reset();
+
+			ILVL3.B45 = ir_lvl;
+			volatile uint8_t tmp = TRCSR();
+			TRCSR = 0x00;
+			TRCIER = TRCIER.IMIED.b(1);
+
+			TRCMR.CTS = 1;  // カウント開始
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  送信 @n
+					最後のスペース（フレーム周期）が終わるまで、送信中となる。
+			@param[in]	f	フレーム
+			@param[in]	rep	繰り返し回数（NEC の場合はリピート・コード）
+			@return 送信中、フレームが不正な場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool send(const utils::ir_frame& f, uint8_t rep = 0) noexcept
+		{
+			if(tx_busy_) return false;
+			if(utils::ir_encoder::pulse(f, 0) == 0) return false;
+
+			carrier_.pluse_out(utils::ir_encoder::carrier(f), 0);
+			carrier_on_(false);
+			tx_ = f;
+			tx_pos_ = 0;
+			tx_rep_ = rep;
+			tx_rest_ = 0;
+			tx_busy_ = true;
+
+			di();
+			TRCGRA = TRCCNT() + 16;
+			volatile uint8_t tmp = TRCSR();
+			TRCSR = ~TRCSR.IMFA.b(1);
+			TRCIER.IMIEA = 1;
+			ei();
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  送信中か検査
+			@return 送信中なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool busy() const noexcept { return tx_busy_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  送信の繰り返しを止める（送信中のフレームは最後まで送る）
+		*/
+		//-----------------------------------------------------------------//
+		void stop_repeat() noexcept { tx_rep_ = 0; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  サービス（メイン・ループから呼ぶ）@n
+					エッジをデコードし、受信したフレームをキューに積む。
+		*/
+		//-----------------------------------------------------------------//
+		void service() noexcept
+		{
+			while(edge_get_ != edge_put_) {
+				uint16_t v = edge_[edge_get_];
+				uint8_t next = edge_get_ + 1;
+				if(next >= RXN) next = 0;
+				edge_get_ = next;
+				if(dec_.put((v & MARK_BIT) != 0, to_us_(v & TIME_MAX))) {
+					put_frame_(dec_.get());
+				}
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  割り込みタスク（TimerRC 割り込みから呼ぶ）
+		*/
+		//-----------------------------------------------------------------//
+		void itask() noexcept
+		{
+			uint8_t sr = TRCSR();
+			TRCSR = ~sr;
+			sr &= TRCIER();  // 割り込みを止めているフラグは見ない
+			if(sr & TRCSR.IMFB.b(1)) rx_timeout_();
+			if(sr & TRCSR.IMFD.b(1)) rx_edge_();
+			if(sr & TRCSR.IMFA.b(1)) tx_task_();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  受信フレームの数を取得
+			@return 受信フレームの数
+		*/
+		//-----------------------------------------------------------------//
+		uint8_t length() const noexcept { return (frame_put_ + FRN - frame_get_) % FRN; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  受信フレームを取得
+			@param[out]	f	フレーム
+			@return フレームが無い場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool get(utils::ir_frame& f) noexcept
+		{
+			if(frame_put_ == frame_get_) return false;
+			f = frame_[frame_get_];
+			++frame_get_;
+			if(frame_get_ >= FRN) frame_get_ = 0;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  キューが一杯で捨てたフレームの数を取得
+			@return 捨てたフレームの数
+		*/
+		//-----------------------------------------------------------------//
+		uint16_t get_lost() const noexcept { return lost_; }
+	};
+}
@@ -9,6 +9,7 @@
 */
 //=====================================================================//
 #include <cstdint>
+#include <type_traits>
 
 namespace graphics {
 
@@ -41,7 +42,10 @@ namespace graphics {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
-		@brief	ビットマップ描画クラス
+		@brief	ビットマップ描画クラス @n
+				PLOT が「PAGE_LAYOUT = true」を宣言した場合、「fb()」のフレームバッファを @n
+				ページ構成（縦８ピクセルを１バイト、１ページ WIDTH バイト）として、@n
+				バイト単位の高速描画を行う。（宣言が無ければ、PLOT の operator() を使う）
 		@param[in]	PLOT	プロットクラス
 		@param[in]	AFONT	ASCII フォント・クラス
 		@param[in]	KFONT	漢字フォントクラス
@@ -50,6 +54,9 @@ namespace graphics {
 	template <class PLOT, class AFONT = afont_null, class KFONT = kfont_null>
 	class monograph {
 
+		/// 縦８ピクセル単位（ページ）の数
+		static const uint8_t PAGE_NUM_ = (PLOT::HEIGHT + 7) / 8;
+
 		PLOT		plot_;
 
 		KFONT&		kfont_;
@@ -59,14 +66,185 @@ namespace graphics {
 
 		bool		x2_;
 
+		// ページ毎の更新範囲（lo > hi なら更新無し）
+		uint8_t		dirty_lo_[PAGE_NUM_];
+		uint8_t		dirty_hi_[PAGE_NUM_];
+
+		// PLOT がページ構成を宣言（PAGE_LAYOUT）しているか検査
+		template <class T>
+		struct page_layout_ {
+			template <class U> static std::integral_constant<bool, U::PAGE_LAYOUT> check_(U*);
+			template <class U> static std::false_type check_(...);
+			static const bool value = decltype(check_<T>(nullptr))::value;
+		};
+		typedef std::integral_constant<bool, page_layout_<PLOT>::value> fast_t;
+
+		// 矩形を画面内にクリップ（x1, y1 は終端を含む）
+		static bool clip_(int16_t& x, int16_t& y, int16_t w, int16_t h, int16_t& x1, int16_t& y1)
+		{
+			if(w <= 0 || h <= 0) return false;
+			x1 = x + w - 1;
+			y1 = y + h - 1;
+			if(x < 0) x = 0;
+			if(y < 0) y = 0;
+			if(x1 >= static_cast<int16_t>(PLOT::WIDTH))  x1 = PLOT::WIDTH - 1;
+			if(y1 >= static_cast<int16_t>(PLOT::HEIGHT)) y1 = PLOT::HEIGHT - 1;
+			return x <= x1 && y <= y1;
+		}
+
+		void fill_(int16_t x, int16_t y, int16_t w, int16_t h, bool c, std::false_type)
+		{
+			for(int16_t yy = y; yy < (y + h); ++yy) {
+				for(int16_t xx = x; xx < (x + w); ++xx) {
+					plot_(xx, yy, c);
+				}
+			}
+		}
+
+		void fill_(int16_t x, int16_t y, int16_t w, int16_t h, bool c, std::true_type)
+		{
+			int16_t x1;
+			int16_t y1;
+			if(!clip_(x, y, w, h, x1, y1)) return;
+
+			uint8_t* fb = plot_.fb();
+			uint8_t p1 = y1 >> 3;
+			for(uint8_t page = y >> 3; page <= p1; ++page) {
+				uint8_t m = 0xff;
+				if(page == (y >> 3)) m &= 0xff << (y & 7);
+				if(page == p1) m &= 0xff >> (7 - (y1 & 7));
+				uint8_t* p = &fb[page * PLOT::WIDTH + x];
+				uint8_t n = x1 - x + 1;
+				if(c) {
+					do { *p++ |= m; } while(--n);
+				} else {
+					m = ~m;
+					do { *p++ &= m; } while(--n);
+				}
+			}
+		}
+
+		void draw_image_(int16_t x, int16_t y, const uint8_t* p, uint8_t w, uint8_t h, std::false_type)
+		{
+			uint8_t k = 1;
+			uint8_t c = *p++;
+			for(uint8_t i = 0; i < h; ++i) {
+				int16_t xx = x;
+				for(uint8_t j = 0; j < w; ++j) {
+					if(c & k) {
+						plot_(xx, y, 1);
+					}
+					k <<= 1;
+					if(k == 0) {
+						k = 1;
+						c = *p++;
+					}
+					++xx;
+				}
+				++y;
+			}
+		}
+
+		// １ビット・イメージのブリッター（ソースはライン毎に連続した LSB ファースト）
+		void draw_image_(int16_t x, int16_t y, const uint8_t* p, uint8_t w, uint8_t h, std::true_type)
+		{
+			uint8_t* fb = plot_.fb();
+			uint16_t bit = 0;
+			for(uint8_t i = 0; i < h; ++i, ++y, bit += w) {
+				if(y < 0) continue;
+				if(y >= static_cast<int16_t>(PLOT::HEIGHT)) break;
+				uint8_t m = 1 << (y & 7);
+				uint8_t* d = &fb[(y >> 3) * PLOT::WIDTH];
+				const uint8_t* s = p + (bit >> 3);
+				uint8_t k = 1 << (bit & 7);
+				uint8_t c = *s++;
+				int16_t xx = x;
+				for(uint8_t j = 0; j < w; ++j, ++xx) {
+					if((c & k) && xx >= 0 && xx < static_cast<int16_t>(PLOT::WIDTH)) {
+						d[xx] |= m;
+					}
+					k <<= 1;
+					if(k == 0) {
+						k = 1;
+						c = *s++;
+					}
+				}
+			}
+		}
+
+		void draw_afont_(int16_t x, int16_t y, const uint8_t* p, std::false_type)
+		{
+			draw_image_(x, y, p, AFONT::WIDTH, AFONT::HEIGHT, fast_t());
+		}
+
+		// ASCII フォント（横８、縦１６ピクセル以下）の描画 @n
+		// カラム単位に変換して、各カラム最大３バイトの OR で書き込む
+		void draw_afont_(int16_t x, int16_t y, const uint8_t* p, std::true_type)
+		{
+			if(AFONT::WIDTH > 8 || AFONT::HEIGHT > 16) {
+				draw_image_(x, y, p, AFONT::WIDTH, AFONT::HEIGHT, fast_t());
+				return;
+			}
+
+			uint16_t col[(AFONT::WIDTH > 0 && AFONT::WIDTH <= 8) ? AFONT::WIDTH : 8] = { 0 };
+			uint8_t k = 1;
+			uint8_t c = *p++;
+			for(uint8_t i = 0; i < AFONT::HEIGHT; ++i) {
+				for(uint8_t j = 0; j < AFONT::WIDTH && j < 8; ++j) {
+					if(c & k) col[j] |= 1 << i;
+					k <<= 1;
+					if(k == 0) {
+						k = 1;
+						c = *p++;
+					}
+				}
+			}
+
+			uint8_t* fb = plot_.fb();
+			int8_t page = y >> 3;  // 算術シフト（負の場合も切り捨て）
+			uint8_t sft = y & 7;
+			for(uint8_t j = 0; j < AFONT::WIDTH && j < 8; ++j) {
+				int16_t xx = x + j;
+				if(xx < 0 || xx >= static_cast<int16_t>(PLOT::WIDTH)) continue;
+				uint32_t v = static_cast<uint32_t>(col[j]) << sft;
+				for(int8_t pg = page; v != 0; ++pg, v >>= 8) {
+					if(pg < 0) continue;
+					if(pg >= static_cast<int8_t>(PAGE_NUM_)) break;
+					fb[pg * PLOT::WIDTH + xx] |= static_cast<uint8_t>(v);
+				}
+			}
+		}
+
+		void mark_(int16_t x, int16_t y, int16_t w, int16_t h)
+		{
+			if(w <= 0 || h <= 0) return;
+			int16_t x1 = x + w - 1;
+			int16_t y1 = y + h - 1;
+			if(x < 0) x = 0;
+			if(y < 0) y = 0;
+			if(x1 >= static_cast<int16_t>(PLOT::WIDTH))  x1 = PLOT::WIDTH - 1;
+			if(y1 >= static_cast<int16_t>(PLOT::HEIGHT)) y1 = PLOT::HEIGHT - 1;
+			if(x > x1 || y > y1) return;
+
+			for(uint8_t page = y >> 3; page <= (y1 >> 3); ++page) {
+				if(dirty_lo_[page] > x)  dirty_lo_[page] = x;
+				if(dirty_hi_[page] < x1) dirty_hi_[page] = x1;
+			}
+		}
+
 	public:
+		typedef PLOT plot_type;
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	コンストラクター
 			@param[in]	kf	KFONT
 		*/
 		//-----------------------------------------------------------------//
-		monograph(KFONT& kf) : plot_(), kfont_(kf), code_(0), cnt_(0), x2_(false) { }
+		monograph(KFONT& kf) : plot_(), kfont_(kf), code_(0), cnt_(0), x2_(false)
+		{
+			reset_dirty();
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -132,6 +310,60 @@ namespace graphics {
 		int8_t get_kfont_height() const { return KFONT::HEIGHT; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ページ数（縦８ピクセル単位）の取得
+			@return ページ数
+		*/
+		//-----------------------------------------------------------------//
+		uint8_t get_page_num() const { return PAGE_NUM_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	更新領域を登録（フレームバッファを直接操作した場合など）
+			@param[in]	x	開始位置 X
+			@param[in]	y	開始位置 Y
+			@param[in]	w	横幅
+			@param[in]	h	高さ
+		*/
+		//-----------------------------------------------------------------//
+		void mark_dirty(int16_t x, int16_t y, int16_t w, int16_t h) { mark_(x, y, w, h); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ページの更新範囲を取得
+			@param[in]	page	ページ
+			@param[out]	x		開始カラム
+			@param[out]	w		カラム数
+			@return 更新が無ければ「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool get_dirty(uint8_t page, uint8_t& x, uint8_t& w) const
+		{
+			if(page >= PAGE_NUM_) return false;
+			if(dirty_lo_[page] > dirty_hi_[page]) return false;
+			x = dirty_lo_[page];
+			w = dirty_hi_[page] - dirty_lo_[page] + 1;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	更新領域をリセット（転送後に呼ぶ）
+		*/
+		//-----------------------------------------------------------------//
+		void reset_dirty()
+		{
+			for(uint8_t i = 0; i < PAGE_NUM_; ++i) {
+				dirty_lo_[i] = 0xff;
+				dirty_hi_[i] = 0x00;
+			}
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	点を描画
@@ -142,6 +374,7 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		void plot(typename PLOT::value_type x, typename PLOT::value_type y, bool c)
 		{
+			mark_(x, y, 1, 1);
 			plot_(x, y, c);
 		}
 
@@ -158,11 +391,40 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		void fill(typename PLOT::value_type x, typename PLOT::value_type y, typename PLOT::value_type w, typename PLOT::value_type h, bool c)
 		{
-			for(typename PLOT::value_type yy = y; yy < (y + h); ++yy) {
-				for(typename PLOT::value_type xx = x; xx < (x + w); ++xx) {
-					plot_(xx, yy, c);
-				}
-			}
+			mark_(x, y, w, h);
+			fill_(x, y, w, h, c, fast_t());
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	水平線を描画
+			@param[in]	x	開始位置 X
+			@param[in]	y	開始位置 Y
+			@param[in]	w	横幅 
+			@param[in]	c	カラー
+		*/
+		//-----------------------------------------------------------------//
+		void hspan(int16_t x, int16_t y, int16_t w, bool c)
+		{
+			mark_(x, y, w, 1);
+			fill_(x, y, w, 1, c, fast_t());
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	垂直線を描画
+			@param[in]	x	開始位置 X
+			@param[in]	y	開始位置 Y
+			@param[in]	h	高さ
+			@param[in]	c	カラー
+		*/
+		//-----------------------------------------------------------------//
+		void vspan(int16_t x, int16_t y, int16_t h, bool c)
+		{
+			mark_(x, y, 1, h);
+			fill_(x, y, 1, h, c, fast_t());
 		}
 
 
@@ -195,6 +457,7 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		void clear(bool c = 0)
 		{
+			mark_(0, 0, PLOT::WIDTH, PLOT::HEIGHT);
 			plot_.clear(c ? 0xff : 0x00);
 		}
 
@@ -217,6 +480,11 @@ namespace graphics {
 			int16_t dy;
 			int8_t sy;
 			if(y2 >= y1) { dy = y2 - y1; sy = 1; } else { dy = y1 - y2; sy = -1; }
+			mark_(x1 < x2 ? x1 : x2, y1 < y2 ? y1 : y2, dx + 1, dy + 1);
+			if(dy == 0 || dx == 0) {
+				fill_(x1 < x2 ? x1 : x2, y1 < y2 ? y1 : y2, dx + 1, dy + 1, c, fast_t());
+				return;
+			}
 
 			if(dx > dy) {
 				auto m = dy >> 1;
@@ -256,14 +524,11 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		void frame(int16_t x, int16_t y, int16_t w, int16_t h, bool c) noexcept
 		{
-			for(int16_t i = 0; i < w; ++i) {
-				plot_(x + i, y, c);
-				plot_(x + i, y + h - 1, c);
-			}
-			for(int16_t i = 0; i < h; ++i) {
-				plot_(x, y + i, c);
-				plot_(x + w - 1, y + i, c);
-			}
+			mark_(x, y, w, h);
+			fill_(x, y, w, 1, c, fast_t());
+			fill_(x, y + h - 1, w, 1, c, fast_t());
+			fill_(x, y, 1, h, c, fast_t());
+			fill_(x + w - 1, y, 1, h, c, fast_t());
 		}
 
 
@@ -281,24 +546,8 @@ namespace graphics {
 		{
 			if(img == nullptr) return;
 
-			const uint8_t* p = static_cast<const uint8_t*>(img);
-			uint8_t k = 1;
-			uint8_t c = *p++;
-			for(uint8_t i = 0; i < h; ++i) {
-				int16_t xx = x;
-				for(uint8_t j = 0; j < w; ++j) {
-					if(c & k) {
-						plot_(xx, y, 1);
-					}
-					k <<= 1;
-					if(k == 0) {
-						k = 1;
-						c = *p++;
-					}
-					++xx;
-				}
-				++y;
-			}
+			mark_(x, y, w, h);
+			draw_image_(x, y, static_cast<const uint8_t*>(img), w, h, fast_t());
 		}
 
 
@@ -402,7 +651,10 @@ namespace graphics {
 ///				if(x2_) {
 ///					draw_image2x(x, y, AFONT::get(code), AFONT::WIDTH, AFONT::HEIGHT);
 ///				} else {
-					draw_image(x, y, AFONT::get(code), AFONT::WIDTH, AFONT::HEIGHT);
+					auto p = AFONT::get(code);
+					if(p == nullptr) return;
+					mark_(x, y, AFONT::WIDTH, AFONT::HEIGHT);
+					draw_afont_(x, y, p, fast_t());
 ///				}
 			} else {
 				if(x <= -KFONT::WIDTH || x >= static_cast<int16_t>(PLOT::WIDTH)) {
@@ -528,6 +780,7 @@ namespace graphics {
 		void draw_holizontal_level(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t l) {
 			frame(x, y, w, h, 1);
 		  	if(w <= 2 || h <= 2) return;
+			mark_(x, y, w, h);
 			++x;
 			h -= 2;
 			++y;
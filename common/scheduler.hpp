@@ -0,0 +1,288 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	タイマー・ティックによる協調型タスク・スケジューラー @n
+			・固定周期タスクと、ワンショット・タスク @n
+			・優先度（値が小さい方が優先）順に、１回に１タスクだけ実行 @n
+			・デッドライン・ミス（周期の取りこぼし）の回数 @n
+			・タスク毎の実行時間（タイマーのカウント単位） @n
+			・実行するタスクが無い場合は IDLE（通常 wait 命令）で待つ @n
+			TIMER は「get_count()、get_timer()、get_limit()」を持つクラス @n
+			（device::trb_io をそのまま使える）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <utility>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  アイドル動作（wait 命令、割り込みで復帰）@n
+				※割り込みが許可されている事
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class scheduler_wait {
+	public:
+		void operator() () {
+			asm("wait");
+		}
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  スケジューラー・クラス
+		@param[in]	TIMER	ティックを供給するタイマークラス
+		@param[in]	NUM		タスクの最大数
+		@param[in]	IDLE	アイドル時に実行するクラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class TIMER, uint8_t NUM, class IDLE = scheduler_wait>
+	class scheduler {
+	public:
+		typedef void (*task_func)();
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  タスク情報
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct info_t {
+			uint16_t	run;	///< 実行回数
+			uint16_t	miss;	///< デッドライン・ミス（取りこぼした周期）の回数
+			uint32_t	max;	///< 最大実行時間（タイマーのカウント）
+			uint32_t	sum;	///< 実行時間の合計（タイマーのカウント）
+		};
+
+	private:
+		struct task_t {
+			task_func	func;
+			uint16_t	period;		///< ０ならワンショット
+			uint16_t	next;		///< 次の実行時刻（ティック）
+			uint8_t		prio;
+			bool		active;
+			info_t		info;
+		};
+
+		typedef decltype(std::declval<const TIMER&>().get_count()) CNT;
+
+		TIMER&		timer_;
+		IDLE		idle_;
+
+		task_t		task_[NUM];
+
+		uint16_t	tick_;
+		CNT			last_;
+		uint32_t	idle_cnt_;
+
+		void update_() {
+			CNT n = timer_.get_count();
+			tick_ += static_cast<CNT>(n - last_);
+			last_ = n;
+		}
+
+		static bool due_(uint16_t now, uint16_t t) {
+			return static_cast<int16_t>(now - t) >= 0;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+			@param[in]	timer	ティックを供給するタイマー
+		*/
+		//-----------------------------------------------------------------//
+		scheduler(TIMER& timer) noexcept : timer_(timer), idle_(), task_{ },
+			tick_(0), last_(timer.get_count()), idle_cnt_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  タスクの追加
+			@param[in]	func	タスク関数
+			@param[in]	period	周期（ティック）、０ならワンショット
+			@param[in]	prio	優先度（０が最も高い）
+			@param[in]	delay	最初の実行までのティック
+			@return タスク ID（登録できない場合「-1」）
+		*/
+		//-----------------------------------------------------------------//
+		int8_t add(task_func func, uint16_t period, uint8_t prio = 0, uint16_t delay = 0) noexcept
+		{
+			if(func == nullptr) return -1;
+			update_();
+			for(uint8_t i = 0; i < NUM; ++i) {
+				task_t& t = task_[i];
+				if(t.func != nullptr) continue;
+				t.func = func;
+				t.period = period;
+				t.next = tick_ + delay;
+				t.prio = prio;
+				t.active = true;
+				t.info = info_t { };
+				return i;
+			}
+			return -1;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  タスクの削除
+			@param[in]	id	タスク ID
+		*/
+		//-----------------------------------------------------------------//
+		void remove(int8_t id) noexcept
+		{
+			if(id < 0 || id >= NUM) return;
+			task_[id].func = nullptr;
+			task_[id].active = false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  タスクの再起動（ワンショットの再設定など）
+			@param[in]	id		タスク ID
+			@param[in]	delay	実行までのティック
+		*/
+		//-----------------------------------------------------------------//
+		void trigger(int8_t id, uint16_t delay = 0) noexcept
+		{
+			if(id < 0 || id >= NUM || task_[id].func == nullptr) return;
+			update_();
+			task_[id].next = tick_ + delay;
+			task_[id].active = true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  タスクの停止
+			@param[in]	id		タスク ID
+		*/
+		//-----------------------------------------------------------------//
+		void stop(int8_t id) noexcept
+		{
+			if(id < 0 || id >= NUM) return;
+			task_[id].active = false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  サービス @n
+					実行時刻になったタスクの内、最も優先度の高いタスクを１つ実行する。@n
+					実行するタスクが無い場合は、IDLE を呼ぶ。
+			@return タスクを実行した場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool service() noexcept
+		{
+			update_();
+
+			int8_t sel = -1;
+			for(uint8_t i = 0; i < NUM; ++i) {
+				const task_t& t = task_[i];
+				if(t.func == nullptr || !t.active) continue;
+				if(!due_(tick_, t.next)) continue;
+				if(sel < 0 || t.prio < task_[sel].prio) sel = i;
+			}
+
+			if(sel < 0) {
+				++idle_cnt_;
+				idle_();
+				return false;
+			}
+
+			task_t& t = task_[sel];
+			if(t.period == 0) {
+				t.active = false;
+			} else {
+				// 周期以上遅れた場合は、取りこぼした周期を数えて位相を保つ
+				uint16_t late = tick_ - t.next;
+				if(late >= t.period) {
+					uint16_t n = late / t.period;
+					t.info.miss += n;
+					t.next += n * t.period;
+				}
+				t.next += t.period;
+			}
+
+			// 実行時間の計測（タイマーはダウンカウント）
+			CNT c0 = timer_.get_count();
+			uint16_t t0 = timer_.get_timer();
+			t.func();
+			uint16_t t1 = timer_.get_timer();
+			CNT c1 = timer_.get_count();
+			int32_t d = static_cast<int32_t>(static_cast<CNT>(c1 - c0))
+				* (static_cast<int32_t>(timer_.get_limit()) + 1) + t0 - t1;
+			if(d < 0) d = 0;  // ティックの更新と読み出しが前後した場合
+
+			++t.info.run;
+			t.info.sum += d;
+			if(static_cast<uint32_t>(d) > t.info.max) t.info.max = d;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  スケジューラーの実行（戻らない）
+		*/
+		//-----------------------------------------------------------------//
+		void run() noexcept
+		{
+			while(1) {
+				service();
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  現在のティックを取得
+			@return ティック
+		*/
+		//-----------------------------------------------------------------//
+		uint16_t get_tick() const noexcept { return tick_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  アイドル回数を取得
+			@return アイドル回数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_idle_count() const noexcept { return idle_cnt_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  タスク情報を取得
+			@param[in]	id		タスク ID
+			@return タスク情報
+		*/
+		//-----------------------------------------------------------------//
+		const info_t& get_info(int8_t id) const noexcept {
+			if(id < 0 || id >= NUM) id = 0;
+			return task_[id].info;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  タスク情報のクリア
+			@param[in]	id		タスク ID
+		*/
+		//-----------------------------------------------------------------//
+		void clear_info(int8_t id) noexcept {
+			if(id < 0 || id >= NUM) return;
+			task_[id].info = info_t { };
+		}
+	};
+}
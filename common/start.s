@@ -21,6 +21,34 @@ _start:
 	fset u
 	ldc #_usp_init,sp
 
+	/* .data セクションのコピー（ROM -> RAM） */
+	/* smovf.w: [r1h:a0] -> [a1]、r3 ワード */
+	.extern __datainternal
+	.extern __datastart
+	.extern __dataend
+	mov.w #__dataend,r3
+	sub.w #__datastart,r3
+	shl.w #-1,r3
+	jz .L_data_done
+	mov.b #0,r1h
+	mov.w #__datainternal,a0
+	mov.w #__datastart,a1
+	smovf.w
+.L_data_done:
+
+	/* .bss セクションのクリア（.noinit はクリアしない） */
+	/* sstr.w: r0 -> [a1]、r3 ワード */
+	.extern __bssstart
+	.extern __bssend
+	mov.w #__bssend,r3
+	sub.w #__bssstart,r3
+	shl.w #-1,r3
+	jz .L_bss_done
+	mov.w #0,r0
+	mov.w #__bssstart,a1
+	sstr.w
+.L_bss_done:
+
 	/* 可変ベクターテーブルアドレス設定 */
 	.extern _variable_vectors_
 	ldc #_variable_vectors_,intbl
@@ -0,0 +1,13 @@
+#=======================================================================
+#   @file
+#   @brief  起動時の .data コピーと .bss クリアのコスト表示 @n
+#			（smovf.w: 5+5m、sstr.w: 3+2m サイクル） @n
+#			リンクのルールで「$(STARTUP_REPORT)」とする。
+#   @author 平松邦仁 (hira@rvf-rc45.net)
+#	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+#				Released under the MIT license @n
+#				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+#=======================================================================
+STARTUP_REPORT	=	@$(SIZE) -A $@ | awk '/^\.data /{d=$$2} /^\.bss /{b=$$2} /^\.noinit /{n=$$2} \
+	END{printf("startup: .data %d bytes (copy), .bss %d bytes (clear), .noinit %d bytes, about %d cycles\n", \
+	d, b, n, 5 + 5 * int(d / 2) + 3 + 2 * int(b / 2))}'
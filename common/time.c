@@ -16,6 +16,11 @@ static const char mday_tbl_[] = {
 	31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
 };
 
+// 1968年3月1日（うるう年の周期の始まり）から 1970年1月1日までの日数
+#define DAYS_1968_03_TO_1970	671
+// 1968年3月1日から 2100年3月1日までの日数（2100年はうるう年では無い）
+#define DAYS_1968_03_TO_2100_03	48212
+
 /// 大阪、札幌、東京のタイムゾーン +9 hour
 static char timezone_offset_ = 9;
 static struct tm time_st_;
@@ -89,22 +94,19 @@ long get_total_day(short year, char mon, char day)
 {
 	if(year < 1970) return -1L;
 
-	long d = 0;
-	short i = 1970;
-	while(i < year) {
-		d += (long)get_yday(i);
-		i++;
-	}
-
-	i = 0;
-	while(i < mon) {
-		d += get_mday(year, i);
-		i++;
+	// ３月始まりの年にすると、２月の日数（うるう日）が年の最後になる
+	uint16_t y = year - 1968;
+	uint16_t m = mon;
+	if(m < 2) {
+		--y;
+		m += 10;
+	} else {
+		m -= 2;
 	}
-
-	d += day - 1;
-
-	return d;
+	uint16_t d = y * 365 + (y >> 2) + (153 * m + 2) / 5 + day - 1;
+	// ４年毎のうるう年から、2100年２月２９日を除く
+	if(d > DAYS_1968_03_TO_2100_03) --d;
+	return (long)(d - DAYS_1968_03_TO_1970);
 }
 
 
@@ -122,58 +124,80 @@ time_t get_timezone_offset(void)
 
 //-----------------------------------------------------------------//
 /*!
-	@brief	グリニッジ標準時への変換
-	@param[in]	timer 
-	@return		グローバル tm 構造体のポインター
+	@brief	グリニッジ標準時への変換（リエントラント）@n
+			３２ビットの割り算は日数を求める１回だけで、他は１６ビットで計算する。
+	@param[in]	tp	時間
+	@param[out]	res	tm 構造体のポインター
+	@return		res
 */
 //-----------------------------------------------------------------//
-struct tm *gmtime(const time_t *tp)
+struct tm *gmtime_r(const time_t *tp, struct tm *res)
 {
-	time_t	t;
-	short	i, j, k;
-
-	t = *tp;
-
-	time_st_.tm_sec  = t % (time_t)60;
-	t /= (time_t)60;
-
-	time_st_.tm_min  = t % (time_t)60;
-	t /= (time_t)60;
-
-	time_st_.tm_hour = t % (time_t)24;
-	t /= (time_t)24;
-
-	time_st_.tm_wday = (t + 4) % 7;
-
-	j = 1970;
-	while(t >= (i = get_yday(j))) {
-		t -= (time_t)i;
-		j++;
+	if(tp == NULL || res == NULL) return NULL;
+
+	// 86400 = 128 * 675
+	uint32_t t = (uint32_t)*tp;
+	uint16_t days = (t >> 7) / 675;
+	t -= (uint32_t)days * 86400;
+
+	// 3600 = 16 * 225
+	uint16_t hour = (uint16_t)(t >> 4) / 225;
+	uint16_t s = (uint16_t)t - hour * 3600;
+	res->tm_hour = hour;
+	res->tm_min  = s / 60;
+	res->tm_sec  = s % 60;
+
+	res->tm_wday = (days + 4) % 7;
+
+	// 1968年3月1日からの日数、2100年２月２９日を補う
+	uint16_t d = days + DAYS_1968_03_TO_1970;
+	if(d >= DAYS_1968_03_TO_2100_03) ++d;
+
+	uint16_t cyc = d / 1461;				// ４年周期
+	uint16_t r = d - cyc * 1461;
+	uint16_t yoc = (r - r / 1460) / 365;	// 周期内の年 [0..3]
+	uint16_t doy = r - yoc * 365;			// ３月１日からの日数 [0..365]
+	uint16_t mp = (5 * doy + 2) / 153;		// ３月始まりの月 [0..11]
+	uint16_t year = 1968 + cyc * 4 + yoc;
+
+	res->tm_mday = doy - (153 * mp + 2) / 5 + 1;
+	if(mp < 10) {
+		res->tm_mon = mp + 2;
+		res->tm_yday = doy + 59 + check_leap_year(year);
+	} else {
+		res->tm_mon = mp - 10;
+		res->tm_yday = doy - 306;
+		++year;
 	}
-	time_st_.tm_year = j - 1900;
+	res->tm_year = year - 1900;
+	res->tm_isdst = 0;
 
-	time_st_.tm_yday = t;
+	return res;
+}
 
-	k = 0;
-	while(t >= (i = get_mday(j, k))) {
-		t -= (time_t)i;
-		k++;
-	}
-	time_st_.tm_mon = k;
-	time_st_.tm_mday = t + 1;
 
-	return &time_st_;
+//-----------------------------------------------------------------//
+/*!
+	@brief	グリニッジ標準時への変換
+	@param[in]	tp	時間
+	@return		グローバル tm 構造体のポインター
+*/
+//-----------------------------------------------------------------//
+struct tm *gmtime(const time_t *tp)
+{
+	return gmtime_r(tp, &time_st_);
 }
 
 
 //-----------------------------------------------------------------//
 /*!
-	@brief	現地時間に変換
-	@param[in]	timer	現地時間
-	@return		tm 構造体のポインター
+	@brief	現地時間に変換（リエントラント）
+	@param[in]	timer	時間
+	@param[out]	res		tm 構造体のポインター
+	@return		res
 */
 //-----------------------------------------------------------------//
-struct tm *localtime(const time_t *timer)
+struct tm *localtime_r(const time_t *timer, struct tm *res)
 {
 	time_t t;
 
@@ -184,9 +208,20 @@ struct tm *localtime(const time_t *timer)
 // GMT から ローカル時間へ
 	t += (time_t)(timezone_offset_) * 3600;
 
-	gmtime(&t);
+	return gmtime_r(&t, res);
+}
 
-	return &time_st_;
+
+//-----------------------------------------------------------------//
+/*!
+	@brief	現地時間に変換
+	@param[in]	timer	現地時間
+	@return		tm 構造体のポインター
+*/
+//-----------------------------------------------------------------//
+struct tm *localtime(const time_t *timer)
+{
+	return localtime_r(timer, &time_st_);
 }
 
 
@@ -95,6 +95,19 @@ inline time_t get_timezone_offset(void);
 struct tm *gmtime(const time_t *);
 
 
+//-----------------------------------------------------------------//
+/*!
+	@brief	世界標準時間（グリニッジ）から、tm 構造体のメンバー
+			を生成する（リエントラント）。@n
+			1970年〜2106年の範囲で、ループを使わずに変換する。
+	@param[in]	tp	時間
+	@param[out]	res	tm 構造体のポインター
+	@return		res
+*/
+//-----------------------------------------------------------------//
+struct tm *gmtime_r(const time_t *tp, struct tm *res);
+
+
 //-----------------------------------------------------------------//
 /*!
 	@brief	tm 構造体から、世界標準(グリニッジ)時間を得る@n
@@ -142,6 +155,17 @@ struct tm *get_tm(void);
 struct tm *localtime(const time_t *timer);
 
 
+//-----------------------------------------------------------------//
+/*!
+	@brief	格納されているデータを現地時間に変換（リエントラント）
+	@param[in]	timer	現地時間
+	@param[out]	res		tm 構造体のポインター
+	@return		res
+*/
+//-----------------------------------------------------------------//
+struct tm *localtime_r(const time_t *timer, struct tm *res);
+
+
 //-----------------------------------------------------------------//
 /*!
 	@brief	tm 構造体のコピー
@@ -69,8 +69,8 @@ namespace device {
 			asm("nop");
 		}
 
-		CNT get_timer_() const {
-			return TRBPRE() | (TRBPR() << 8);
+		uint16_t get_timer_() const {
+			return static_cast<uint16_t>(TRBPRE()) | (static_cast<uint16_t>(TRBPR()) << 8);
 		}
 
 	public:
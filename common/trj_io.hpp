@@ -73,6 +73,17 @@ namespace device {
 		static volatile uint8_t trjmr_;
 		static volatile uint16_t trj_;
 
+		// 周波数計測（レシプロカル方式）
+		static volatile uint16_t ovf_;		///< 周期内のアンダーフロー回数
+		static volatile uint16_t ovf_limit_;	///< 入力無しと判断するアンダーフロー回数
+		static volatile uint32_t acc_;		///< ゲート内のカウント積算
+		static volatile uint16_t num_;		///< ゲート内の周期数
+		static volatile uint32_t gate_;		///< ゲート時間（カウント数）
+		static volatile uint8_t  skip_;		///< 捨てる周期数（計測開始直後）
+		static volatile uint32_t frq_acc_;	///< 確定したカウント積算
+		static volatile uint16_t frq_num_;	///< 確定した周期数
+		static volatile uint8_t  frq_id_;	///< 確定毎に更新
+
 		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 		/*!
 			@brief  パルス出力用割り込み関数
@@ -100,7 +111,68 @@ namespace device {
 		}
 
 
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  周波数計測用割り込み関数 @n
+					周期の測定値とアンダーフローを積算し、ゲート時間を @n
+					超えた所で周期数とカウント数を確定する。
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		static inline void ifreq() {
+			bool edge = TRJCR.TEDGF();
+			bool undf = TRJCR.TUNDF();
+			uint16_t cap = 0;
+			if(edge) cap = ~TRJ();
+			if(undf) {
+				TRJCR.TUNDF = 0;
+				// エッジの前に起きたアンダーフロー（捕獲値が小さい）は、この周期に含める
+				if(!edge || cap < 0x8000) {
+					++ovf_;
+					undf = false;
+				}
+			}
+			if(edge) {
+				TRJCR.TEDGF = 0;
+				uint32_t t = (static_cast<uint32_t>(ovf_) << 16) + cap + 1;
+				ovf_ = undf ? 1 : 0;  // エッジの後のアンダーフローは次の周期
+				if(skip_ > 0) {
+					--skip_;
+				} else {
+					acc_ += t;
+					++num_;
+					if(acc_ >= gate_ || num_ == 0xffff) {
+						frq_acc_ = acc_;
+						frq_num_ = num_;
+						++frq_id_;
+						acc_ = 0;
+						num_ = 0;
+					}
+				}
+			} else if(ovf_ >= ovf_limit_) {  // 入力無し
+				frq_acc_ = 0;
+				frq_num_ = 0;
+				++frq_id_;
+				ovf_ = 0;
+				acc_ = 0;
+				num_ = 0;
+				skip_ = 1;
+			}
+			task_();
+			volatile uint8_t tmp = TRJIR();
+			TRJIR = TRJIR.TRJIE.b(1);
+		}
+
+
 	private:
+		static uint32_t clock_(source s) {
+			switch(s) {
+			case source::f1: return F_CLK;
+			case source::f2: return F_CLK / 2;
+			case source::f8: return F_CLK / 8;
+			default: return 0;
+			}
+		}
+
 		bool set_freq_(uint32_t freq, uint16_t& trj, uint8_t& tck) const {
 			uint32_t tn = F_CLK / (freq * 2);
 			uint8_t cks = 0;
@@ -276,6 +348,102 @@ namespace device {
 			return !TRJCR.TUNDF();
 		}
 
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  周波数計測（レシプロカル方式）の開始（TRJIO 端子から入力）@n
+					入力周期をカウントし、ゲート時間を超えるまで周期を積算する。@n
+					周期毎に割り込みが発生するので、入力周波数の上限は @n
+					割り込み処理時間で決まる（２０ＭＨｚで数十ＫＨｚ程度）。@n
+					割り込み関数から「ifreq()」を呼ぶ事。
+			@param[in]	s		クロック選択（fHOCO は不可）
+			@param[in]	gate	ゲート時間（ミリ秒）
+			@param[in]	ir_lvl	割り込みレベル（１～７）
+			@return 設定が不正な場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool start_freq(source s, uint16_t gate, uint8_t ir_lvl) const {
+			uint32_t clk = clock_(s);
+			if(clk == 0 || gate == 0 || ir_lvl == 0) return false;
+
+			pluse_inp(measurement::freq, s, 0);
+			TRJCR = 0x00;  // カウンタ停止
+
+			gate_ = clk / 1000 * gate;
+			ovf_limit_ = static_cast<uint16_t>((gate_ >> 16) * 2 + 2);
+			ovf_ = 0;
+			acc_ = 0;
+			num_ = 0;
+			skip_ = 1;  // 最初の周期は途中から計測されるので捨てる
+			frq_acc_ = 0;
+			frq_num_ = 0;
+
+			ILVLB.B01 = ir_lvl;
+			TRJIR = TRJIR.TRJIE.b(1);
+			TRJ = 0xffff;
+			TRJCR = TRJCR.TSTART.b(1);  // カウンタを開始
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  計測結果の更新を検査
+			@return 確定する毎に変化する値
+		*/
+		//-----------------------------------------------------------------//
+		uint8_t get_freq_id() const { return frq_id_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  周波数の取得（最後に確定したゲートの値）
+			@param[in]	s		計測に使っているクロック
+			@param[out]	freq	周波数（小数点以下 frac ビットの固定小数点）
+			@param[in]	frac	小数点以下のビット数
+			@return 入力が無い場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool get_freq(source s, uint32_t& freq, uint8_t frac = 0) const {
+			di();
+			uint32_t t = frq_acc_;
+			uint16_t n = frq_num_;
+			ei();
+			if(t == 0 || n == 0) {
+				freq = 0;
+				return false;
+			}
+			// clock * n（48 ビット）を上位 hi、下位 lo に分けて求める
+			uint32_t clk = clock_(s);
+			uint32_t mh = (clk >> 16) * n;
+			uint32_t lo = (clk & 0xffff) * n;
+			uint32_t hi = mh >> 16;
+			mh <<= 16;
+			lo += mh;
+			if(lo < mh) ++hi;
+			// 32 ビットの引き戻し除算、整数部 48 ビットに続けて、余りから frac ビットを求める
+			uint32_t q = 0;
+			uint32_t r = 0;
+			uint8_t i = 0;
+			if(hi < t) {  // 上位 16 ビットの商は０
+				r = hi;
+				i = 16;
+			}
+			for( ; i < (48 + frac); ++i) {
+				bool c = r & 0x80000000;
+				r <<= 1;
+				if(i < 16) r |= (hi >> (15 - i)) & 1;
+				else if(i < 48) r |= (lo >> (47 - i)) & 1;
+				q <<= 1;
+				if(c || r >= t) {
+					r -= t;
+					q |= 1;
+				}
+			}
+			if(r >= (t - r)) ++q;  // 四捨五入
+			freq = q;
+			return true;
+		}
 	};
 
 	// スタティック実態定義
@@ -285,5 +453,23 @@ namespace device {
 	volatile uint8_t trj_io<TASK>::trjmr_;
 	template<class TASK>
 	volatile uint16_t trj_io<TASK>::trj_;
+	template<class TASK>
+	volatile uint16_t trj_io<TASK>::ovf_;
+	template<class TASK>
+	volatile uint16_t trj_io<TASK>::ovf_limit_;
+	template<class TASK>
+	volatile uint32_t trj_io<TASK>::acc_;
+	template<class TASK>
+	volatile uint16_t trj_io<TASK>::num_;
+	template<class TASK>
+	volatile uint32_t trj_io<TASK>::gate_;
+	template<class TASK>
+	volatile uint8_t trj_io<TASK>::skip_;
+	template<class TASK>
+	volatile uint32_t trj_io<TASK>::frq_acc_;
+	template<class TASK>
+	volatile uint16_t trj_io<TASK>::frq_num_;
+	template<class TASK>
+	volatile uint8_t trj_io<TASK>::frq_id_;
 
 }
@@ -0,0 +1,84 @@
+//=====================================================================//
+/*!	@file
+	@brief	adc_io / adc_decimator テスト @n
+			ADC_sample と同じ設定（繰り返し変換、割り込みレベル１）で、@n
+			変換終了毎に ADF をセットし、ADIE が有効な間だけ割り込みを起動する。@n
+			・割り込みが継続し、リングに間引き値が溜まる事 @n
+			・間引き値、最小、最大が入力と一致する事
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include "common/adc_io.hpp"
+
+namespace {
+
+	typedef device::adc_decimator<2, 2, 64> ADC_TASK;
+	typedef device::adc_io<ADC_TASK> ADC;
+	ADC		adc_;
+
+	// 変換１回分のハードウェア動作
+	bool convert_(uint16_t ad0, uint16_t ad1)
+	{
+		if(!device::ADCON0.ADST()) return false;
+		device::wr16_(0x0098, ad0);  // AD0
+		device::wr16_(0x009A, ad1);  // AD1
+		device::ADICSR.ADF = 1;
+		if(device::ADICSR.ADIE()) {
+			adc_.itask();
+		}
+		return true;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	adc_.start(ADC::CH_TYPE::CH0_CH1, ADC::CH_GROUP::AN0_AN1, true, 1);
+	adc_.scan();
+
+	static const uint8_t OUTN = 3;
+	uint32_t n = 0;
+	for(uint8_t k = 0; k < OUTN; ++k) {
+		for(uint32_t i = 0; i < ADC_TASK::NUM; ++i) {
+			// AN0: 一定、AN1: 500 +-3 の三角波
+			uint16_t a1 = 500 + (i % 7) - 3;
+			if(!convert_(512, a1)) {
+				printf("NG: conversion stopped\n");
+				return 1;
+			}
+			++n;
+		}
+		if(!device::ADICSR.ADIE()) {
+			printf("NG: ADIE cleared by itask() after %u conversions\n", static_cast<unsigned>(n));
+			return 1;
+		}
+	}
+
+	if(adc_.at_task().length() != OUTN) {
+		printf("NG: ring length %u (expected %u) after %u conversions\n",
+			adc_.at_task().length(), OUTN, static_cast<unsigned>(n));
+		return 1;
+	}
+
+	ADC_TASK::value_t val[2];
+	uint8_t cnt = 0;
+	while(adc_.at_task().get(val)) {
+		++cnt;
+		// 12 ビット値（10 ビット値の４倍）
+		if(val[0].val != 512 * 4 || val[0].min != 512 || val[0].max != 512) {
+			printf("NG: AN0 %u (%u - %u)\n", val[0].val, val[0].min, val[0].max);
+			return 1;
+		}
+		if(val[1].min != 497 || val[1].max != 503 || val[1].val < 499 * 4 || val[1].val > 501 * 4) {
+			printf("NG: AN1 %u (%u - %u)\n", val[1].val, val[1].min, val[1].max);
+			return 1;
+		}
+	}
+	printf("OK: %u conversions, %u decimated outputs (%u conversions each)\n",
+		static_cast<unsigned>(n), cnt, static_cast<unsigned>(ADC_TASK::NUM));
+	return 0;
+}
@@ -0,0 +1,131 @@
+//=====================================================================//
+/*!	@file
+	@brief	delay サイクル数テスト @n
+			ループ（LOOP_CYCLES）と外側ループ（OUTER_CYCLES）のサイクル数から、@n
+			・nano_second、micro_second、milli_second の待ちが指定時間以上で、@n
+			  超過がループ１回分（＋係数の丸め）以内である事 @n
+			・wait_timer、wait_count がティックの位相によらず、ダウンカウンタの @n
+			  クロック単位で指定時間待つ事（カウンタの一周、割り込みの遅れを含む）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include "common/delay.hpp"
+
+namespace {
+
+	typedef utils::delay DELAY;
+
+	// 読み出し毎に STEP クロック進む、ダウンカウンタとティック・カウンタ @n
+	// ティックのカウントは、ダウンカウンタの再ロードから LAT クロック遅れて進む（割り込みの遅れ）
+	struct sim_timer {
+		mutable uint32_t	clk_;
+		mutable uint32_t	read_;
+		uint16_t			limit_;
+		uint32_t			step_;
+		uint32_t			lat_;
+		uint8_t				base_;
+		sim_timer(uint8_t base, uint16_t limit, uint32_t phase, uint32_t step, uint32_t lat) :
+			clk_(phase), read_(0), limit_(limit), step_(step), lat_(lat), base_(base) { }
+		uint32_t per() const { return static_cast<uint32_t>(limit_) + 1; }
+		uint8_t get_count() const {
+			clk_ += step_;
+			++read_;
+			return base_ + (clk_ < lat_ ? 0 : (clk_ - lat_) / per());
+		}
+		uint16_t get_timer() const {
+			clk_ += step_;
+			++read_;
+			return limit_ - clk_ % per();
+		}
+		uint16_t get_limit() const { return limit_; }
+	};
+
+	bool check_(const char* name, uint32_t want, uint32_t cyc, uint32_t over)
+	{
+		if(cyc < want || cyc >= want + over) {
+			printf("NG: %s: %u cycles (want %u, +%u)\n", name,
+				static_cast<unsigned>(cyc), static_cast<unsigned>(want), static_cast<unsigned>(over));
+			return false;
+		}
+		return true;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	bool ok = true;
+
+	// nano_second（実行時の係数）、１ループ＋係数の丸めで１ループ
+	for(uint32_t ns = 1; ns <= 0xffff; ++ns) {
+		uint32_t cyc = DELAY::ns_loops(ns) * DELAY::LOOP_CYCLES;
+		if(!check_("nano_second(ns)", DELAY::cycles_ns(ns), cyc, DELAY::LOOP_CYCLES * 2)) {
+			ok = false;
+			break;
+		}
+	}
+	// nano_second<NS>（コンパイル時）
+	ok = check_("nano_second<100>", DELAY::cycles_ns(100),
+		DELAY::loops(DELAY::cycles_ns(100)) * DELAY::LOOP_CYCLES, DELAY::LOOP_CYCLES) && ok;
+	ok = check_("nano_second<50000>", DELAY::cycles_ns(50000),
+		DELAY::loops(DELAY::cycles_ns(50000)) * DELAY::LOOP_CYCLES, DELAY::LOOP_CYCLES) && ok;
+
+	uint32_t us = DELAY::us_loops() * DELAY::LOOP_CYCLES + DELAY::OUTER_CYCLES;
+	ok = check_("micro_second(1)", DELAY::cycles_ns(1000), us, DELAY::LOOP_CYCLES) && ok;
+	uint32_t ms = DELAY::ms_loops() * DELAY::LOOP_CYCLES + DELAY::OUTER_CYCLES;
+	ok = check_("milli_second(1)", DELAY::cycles_ns(1000000), ms, DELAY::LOOP_CYCLES) && ok;
+	printf("F_CLK %u: 1us = %u cycles (%u), 1ms = %u cycles (%u)\n",
+		static_cast<unsigned>(DELAY::CLOCK), static_cast<unsigned>(us),
+		static_cast<unsigned>(DELAY::cycles_ns(1000)), static_cast<unsigned>(ms),
+		static_cast<unsigned>(DELAY::cycles_ns(1000000)));
+
+	// wait_timer、wait_count: 開始カウント、ティックの位相、読み出しの間隔、割り込みの遅れを変えて、@n
+	// 指定クロック以上、超過は割り込みの遅れと、読み出し（読み直しを含む）数回分以内である事
+	static const uint16_t limits[] = { 999, 4999, 41665 };
+	static const uint32_t steps[] = { 1, 7, 23 };
+	uint32_t runs = 0;
+	for(uint16_t limit : limits) {
+		uint32_t per = static_cast<uint32_t>(limit) + 1;
+		for(uint32_t base = 0; base < 256 && ok; base += 51) {
+			for(uint32_t phase = 0; phase < per && ok; phase += per / 5 + 3) {
+				for(uint32_t step : steps) {
+					for(uint32_t lat = 0; lat < per / 2; lat += per / 4 + 1) {
+						for(uint32_t n = 1; n < per * 3 && ok; n += per / 3 + 11) {
+							sim_timer tm(base, limit, phase, step, lat);
+							DELAY::wait_timer(tm, n);
+							uint32_t d = tm.clk_ - phase;
+							ok = check_("wait_timer", n, d, lat + step * 16) && ok;
+							++runs;
+						}
+						for(uint16_t n = 1; n < 300 && ok; n += 37) {
+							sim_timer tm(base, limit, phase, step, lat);
+							DELAY::wait_count(tm, n);
+							uint32_t d = tm.clk_ - phase;
+							ok = check_("wait_count", n * per, d, lat + step * 16) && ok;
+							++runs;
+						}
+					}
+				}
+			}
+		}
+	}
+	printf("wait_timer/wait_count: %u runs\n", static_cast<unsigned>(runs));
+
+	// 過ぎたカウントを指定した場合はすぐ戻る
+	{
+		sim_timer tm(10, 99, 0, 1, 0);
+		DELAY::wait_until(tm, static_cast<uint8_t>(5));
+		if(tm.read_ != 1) {
+			printf("NG: wait_until(past) did not return immediately\n");
+			ok = false;
+		}
+	}
+
+	if(!ok) return 1;
+	printf("OK\n");
+	return 0;
+}
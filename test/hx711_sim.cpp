@@ -0,0 +1,316 @@
+//=====================================================================//
+/*!	@file
+	@brief	HX711 シミュレーション・テスト @n
+			HX711（DOUT、PD_SCK、変換周期、ゲイン選択、パワーダウン）をマイクロ秒単位で @n
+			シミュレーションし、chip::HX711 を 1KHz の「itask()」で非同期に読み出す。@n
+			・割り込み１回のパルスが SLICE 以下で、PD_SCK の High が 50us 以下である事 @n
+			・A128、B32、A64 で、２４ビットの後のパルス数（25/26/27）と値が正しい事 @n
+			・設定の変更、パワーダウンからの復帰後、前の設定の変換値が混ざらない事 @n
+			・メディアン・フィルターで、１回のスパイクが結果に出ない事 @n
+			・tare()、calibrate() で、載せた重さが求まる事
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <vector>
+#include "chip/HX711.hpp"
+
+namespace {
+
+	static const uint32_t CONV_US = 12500;	///< 変換周期（80SPS）
+	static const uint32_t TASK_US = 1000;	///< itask の呼び出し周期
+	static const uint8_t SLICE = 9;
+
+	uint64_t	now_ = 0;
+	uint32_t	hi_max_ = 0;	///< PD_SCK の High の最大時間（パワーダウンを除く）
+	uint32_t	bad_ = 0;		///< 変換中のパルス
+
+	// HX711 のモデル
+	struct hx_t {
+		int32_t		in_a;		///< チャネルＡの入力（ゲイン１２８のカウント）
+		int32_t		in_b;		///< チャネルＢの入力（ゲイン３２のカウント）
+		int32_t		spike;		///< 次の変換に加える値
+
+		bool		sck;
+		bool		pd;
+		bool		ready;
+		uint8_t		gain;		///< 次の変換のゲイン（24 ビットの後のパルス数）
+		uint8_t		pulses;
+		uint32_t	data;
+		uint64_t	t_ready;
+		uint64_t	t_high;
+
+		std::vector<uint8_t>	reads;	///< 読み出し毎のパルス数
+
+		hx_t() : in_a(0), in_b(0), spike(0), sck(false), pd(false), ready(false),
+			gain(1), pulses(0), data(0), t_ready(CONV_US), t_high(0) { }
+
+		int32_t value() const {
+			switch(gain) {
+			case 2:  return in_b;
+			case 3:  return in_a / 2;
+			default: return in_a;
+			}
+		}
+
+		void update() {
+			if(sck && (now_ - t_high) > 60) pd = true;
+			if(pd || ready || now_ < t_ready) return;
+			if(pulses != 0) {  // 前の読み出しのパルス数で、この変換のゲインが決まる
+				reads.push_back(pulses);
+				gain = pulses >= 27 ? 3 : pulses - 24;
+				pulses = 0;
+			}
+			data = static_cast<uint32_t>(value() + spike) & 0xffffff;
+			spike = 0;
+			ready = true;
+		}
+
+		bool dout() {
+			update();
+			if(pd) return true;
+			if(pulses > 0) {
+				if(pulses <= 24) return (data >> (24 - pulses)) & 1;
+				return true;
+			}
+			return !ready;
+		}
+
+		void set_sck(bool f) {
+			update();
+			if(f && !sck) {
+				t_high = now_;
+				if(!ready && pulses == 0) ++bad_;
+				else if(pulses < 27) {
+					++pulses;
+					if(pulses == 25) {  // 次の変換を開始
+						ready = false;
+						t_ready = now_ + CONV_US;
+					}
+				}
+			} else if(!f && sck) {
+				uint32_t t = now_ - t_high;
+				if(pd) {  // パワーダウンから復帰、ゲインは A128
+					pd = false;
+					ready = false;
+					gain = 1;
+					pulses = 0;
+					t_ready = now_ + CONV_US;
+				} else if(t > hi_max_) {
+					hi_max_ = t;
+				}
+			}
+			sck = f;
+		}
+	};
+	hx_t hx_;
+
+	struct sck_sim {
+		struct p_t {
+			void operator = (bool f) { hx_.set_sck(f); }
+		};
+		struct dir_t {
+			void operator = (bool f) { }
+		};
+		static p_t		P;
+		static dir_t	DIR;
+	};
+	sck_sim::p_t sck_sim::P;
+	sck_sim::dir_t sck_sim::DIR;
+
+	struct dat_sim {
+		struct p_t {
+			bool operator () () const { return hx_.dout(); }
+		};
+		struct dir_t {
+			void operator = (bool f) { }
+		};
+		static p_t		P;
+		static dir_t	DIR;
+	};
+	dat_sim::p_t dat_sim::P;
+	dat_sim::dir_t dat_sim::DIR;
+
+	typedef chip::HX711<sck_sim, dat_sim, 3, 4, 8, SLICE> HX711;
+	typedef HX711::MODE MODE;
+
+	uint32_t	slice_max_;
+	uint32_t	calls_;
+
+	// ms ミリ秒分、itask とメイン・ループを回し、リングの結果を out に積む
+	void run_(HX711& hx, uint32_t ms, std::vector<int32_t>& out)
+	{
+		for(uint32_t i = 0; i < ms; ++i) {
+			uint8_t before = hx_.pulses;
+			hx.itask();
+			uint32_t np = hx_.pulses - before;
+			if(np > slice_max_) slice_max_ = np;
+			++calls_;
+			sim_advance(TASK_US);
+			hx.service();
+			int32_t v;
+			while(hx.get(v)) out.push_back(v);
+		}
+	}
+
+	bool all_(const char* name, const std::vector<int32_t>& out, size_t from, int32_t want)
+	{
+		if(out.size() <= from) {
+			printf("NG: %s: no results\n", name);
+			return false;
+		}
+		for(size_t i = from; i < out.size(); ++i) {
+			if(out[i] != want) {
+				printf("NG: %s: result %u is %d (want %d)\n", name, static_cast<unsigned>(i),
+					static_cast<int>(out[i]), static_cast<int>(want));
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool pulses_(const char* name, size_t from, uint8_t want)
+	{
+		for(size_t i = from; i < hx_.reads.size(); ++i) {
+			if(hx_.reads[i] != want) {
+				printf("NG: %s: read %u used %u pulses (want %u)\n", name, static_cast<unsigned>(i),
+					hx_.reads[i], want);
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+
+void sim_advance(uint32_t us)
+{
+	now_ += us;
+	hx_.update();
+}
+
+
+int main(int argc, char* argv[])
+{
+	bool ok = true;
+
+	// A128、B32、A64：パワーオン後の最初の変換（A128）は、他の設定では捨てる
+	static const MODE modes[] = { MODE::A128, MODE::B32, MODE::A64 };
+	for(MODE m : modes) {
+		hx_ = hx_t();
+		hx_.in_a = 0x123456;
+		hx_.in_b = -0x2345;
+		HX711 hx;
+		hx.start(m);
+		std::vector<int32_t> out;
+		run_(hx, 200, out);
+		hx_t t = hx_;
+		t.gain = static_cast<uint8_t>(m);
+		char name[16];
+		snprintf(name, sizeof(name), "mode %u", static_cast<unsigned>(m));
+		ok = all_(name, out, 0, t.value()) && ok;
+		ok = pulses_(name, 0, 24 + static_cast<uint8_t>(m)) && ok;
+		// 変換周期と、変換完了から itask までの遅れ、最初の変換を捨てる分
+		if(out.size() < 200000 / (CONV_US + TASK_US) - 2) {
+			printf("NG: %s: %u results in 200ms\n", name, static_cast<unsigned>(out.size()));
+			ok = false;
+		}
+	}
+
+	// 設定の変更（A128 -> B32）
+	{
+		hx_ = hx_t();
+		hx_.in_a = 40000;
+		hx_.in_b = -3000;
+		HX711 hx;
+		hx.start(MODE::A128);
+		std::vector<int32_t> out;
+		run_(hx, 100, out);
+		size_t n = out.size();
+		hx.set_mode(MODE::B32);
+		run_(hx, 100, out);
+		ok = all_("before set_mode", std::vector<int32_t>(out.begin(), out.begin() + n), 0, 40000) && ok;
+		// 切り替え時にリングに残った A128 の結果の後は、B32 だけ
+		size_t i = n;
+		while(i < out.size() && out[i] == 40000) ++i;
+		ok = all_("after set_mode", out, i, -3000) && ok;
+	}
+
+	// メディアン：１回のスパイクは出ない
+	{
+		hx_ = hx_t();
+		hx_.in_a = 250000;
+		HX711 hx;
+		hx.start(MODE::A128);
+		std::vector<int32_t> out;
+		run_(hx, 60, out);
+		hx_.spike = 3000000;
+		run_(hx, 30, out);
+		hx_.spike = -3000000;
+		run_(hx, 60, out);
+		ok = all_("median", out, 0, 250000) && ok;
+	}
+
+	// 風袋、校正
+	{
+		hx_ = hx_t();
+		hx_.in_a = 100000;
+		HX711 hx;
+		hx.start(MODE::A128);
+		std::vector<int32_t> out;
+		run_(hx, 100, out);
+		hx.tare();
+		if(hx.calibrate(500)) {
+			printf("NG: calibrate() at the zero point\n");
+			ok = false;
+		}
+		hx_.in_a = 150000;  // 2000g
+		run_(hx, 100, out);
+		if(!hx.calibrate(2000)) {
+			printf("NG: calibrate(2000) failed\n");
+			ok = false;
+		}
+		int32_t w2000 = hx.get_value();
+		hx_.in_a = 125000;  // 1000g
+		run_(hx, 100, out);
+		int32_t w1000 = hx.get_value();
+		hx_.in_a = 95000;  // -200g
+		out.clear();
+		run_(hx, 100, out);
+		int32_t wm200 = out.back();
+		if(w2000 != 2000 || w1000 < 999 || w1000 > 1001 || wm200 < -201 || wm200 > -199) {
+			printf("NG: tare/calibrate: %d, %d, %d (want 2000, 1000, -200)\n",
+				static_cast<int>(w2000), static_cast<int>(w1000), static_cast<int>(wm200));
+			ok = false;
+		}
+	}
+
+	// パワーダウンからの復帰（B32）：復帰後の最初の変換（A128）は捨てる
+	{
+		hx_ = hx_t();
+		hx_.in_a = 777777;
+		hx_.in_b = 5555;
+		HX711 hx;
+		hx.start(MODE::B32);
+		std::vector<int32_t> out;
+		run_(hx, 100, out);
+		hx.power_down();
+		run_(hx, 20, out);
+		hx.power_up();
+		run_(hx, 100, out);
+		ok = all_("power_up", out, 0, 5555) && ok;
+	}
+
+	if(slice_max_ > SLICE || hi_max_ > 50 || bad_ != 0) {
+		printf("NG: %u pulses in one itask (SLICE %u), PD_SCK high %u us, %u pulses while converting\n",
+			slice_max_, SLICE, hi_max_, bad_);
+		ok = false;
+	}
+
+	if(!ok) return 1;
+	printf("OK: %u itask calls, max %u pulses/call, PD_SCK high max %u us\n", calls_, slice_max_, hi_max_);
+	return 0;
+}
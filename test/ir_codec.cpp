@@ -0,0 +1,135 @@
+//=====================================================================//
+/*!	@file
+	@brief	赤外線リモコン・エンコーダー、デコーダーのテスト @n
+			ir_encoder::pulse() の時間列に、受信モジュールのマークの伸び、@n
+			ジッターを加えて ir_decoder::put() に渡し、@n
+			・NEC（リピート・コードを含む） @n
+			・SONY SIRC 12/15/20 ビット @n
+			・Canon 即時／２秒後 @n
+			が元のフレームに戻る事を検査する
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "common/ir_codec.hpp"
+
+namespace {
+
+	typedef utils::ir_frame FRAME;
+
+	// マークを stretch だけ伸ばし（スペースは縮む）、±jitter の揺らぎを加えて渡す @n
+	// last の場合、最後のスペース（フレーム間隔）の代わりに IDLE を渡す
+	void feed_(utils::ir_decoder& dec, const FRAME& f, int stretch, int jitter, bool last,
+		std::vector<FRAME>& out)
+	{
+		for(uint8_t idx = 0; ; ++idx) {
+			uint32_t t = utils::ir_encoder::pulse(f, idx);
+			if(t == 0) break;
+			bool mark = (idx & 1) == 0;
+			bool gap = !mark && utils::ir_encoder::pulse(f, idx + 1) == 0;
+			uint16_t v;
+			if(gap && last) {
+				v = utils::ir_decoder::IDLE;
+			} else {
+				int32_t d = static_cast<int32_t>(t) + (mark ? stretch : -stretch);
+				if(jitter > 0) d += rand() % (jitter * 2 + 1) - jitter;
+				if(d < 1) d = 1;
+				if(d >= utils::ir_decoder::IDLE) d = utils::ir_decoder::IDLE - 1;
+				v = d;
+			}
+			if(dec.put(mark, v)) out.push_back(dec.get());
+		}
+	}
+
+	bool same_(const FRAME& a, const FRAME& b)
+	{
+		return a.proto == b.proto && a.bits == b.bits && a.repeat == b.repeat && a.data == b.data;
+	}
+
+	FRAME canon_(bool delay) { return FRAME(FRAME::PROTO::CANON, delay ? 1 : 0, 0); }
+
+	FRAME repeat_(const FRAME& f)
+	{
+		FRAME r = f;
+		r.repeat = true;
+		return r;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	srand(1);
+
+	static const int stretch[] = { 0, 100, 200 };
+	static const int jitter[] = { 0, 30, 60 };
+
+	uint32_t frames = 0;
+	bool ok = true;
+	for(int s : stretch) {
+		for(int j : jitter) {
+			for(int r = 0; r < 50 && ok; ++r) {
+				// 期待するフレームの列（NEC の後のリピート、各フォーマット）
+				std::vector<FRAME> in;
+				FRAME nec = FRAME::nec(rand() & 0xff, rand() & 0xff);
+				in.push_back(nec);
+				uint8_t rep = rand() % 4;
+				for(uint8_t i = 0; i < rep; ++i) in.push_back(repeat_(nec));
+				static const uint8_t sbits[] = { 12, 15, 20 };
+				for(uint8_t b : sbits) {
+					in.push_back(FRAME::sony(rand() & 0x1fff, rand() & 0x7f, b));
+				}
+				in.push_back(canon_(false));
+				in.push_back(canon_(true));
+				FRAME nec2 = FRAME::nec(rand() & 0xff, rand() & 0xff);
+				in.push_back(nec2);
+				in.push_back(repeat_(nec2));
+
+				utils::ir_decoder dec;
+				std::vector<FRAME> out;
+				for(size_t i = 0; i < in.size(); ++i) {
+					feed_(dec, in[i], s, j, (i + 1) == in.size() || (rand() & 3) == 0, out);
+				}
+				bool err = out.size() != in.size();
+				for(size_t i = 0; !err && i < in.size(); ++i) {
+					if(!same_(in[i], out[i])) err = true;
+				}
+				if(err) {
+					printf("NG: stretch %d, jitter %d: %u frames in, %u out\n", s, j,
+						static_cast<unsigned>(in.size()), static_cast<unsigned>(out.size()));
+					for(size_t i = 0; i < out.size(); ++i) {
+						printf("  %u: proto %u, bits %u, repeat %d, data 0x%08X\n", static_cast<unsigned>(i),
+							static_cast<unsigned>(out[i].proto), out[i].bits, out[i].repeat,
+							static_cast<unsigned>(out[i].data));
+					}
+					ok = false;
+				}
+				frames += in.size();
+			}
+		}
+	}
+
+	// 元のフレームが無いリピート・コードは捨てる
+	{
+		utils::ir_decoder dec;
+		std::vector<FRAME> out;
+		feed_(dec, repeat_(FRAME::nec(1, 2)), 100, 30, true, out);
+		dec.reset();
+		feed_(dec, FRAME::nec(3, 4), 100, 30, false, out);
+		dec.reset();
+		feed_(dec, repeat_(FRAME::nec(3, 4)), 100, 30, true, out);
+		if(out.size() != 1 || !same_(out[0], FRAME::nec(3, 4))) {
+			printf("NG: NEC repeat without a frame: %u frames\n", static_cast<unsigned>(out.size()));
+			ok = false;
+		}
+	}
+
+	if(!ok) return 1;
+	printf("OK: %u frames (NEC + repeat, SONY 12/15/20, Canon now/delay)\n", static_cast<unsigned>(frames));
+	return 0;
+}
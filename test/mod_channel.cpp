@@ -0,0 +1,176 @@
+//=====================================================================//
+/*!	@file
+	@brief	TX_MOD / RX_MOD 通信路テスト @n
+			TX_MOD の出力（スロット毎のレベル）を、雑音のある通信路モデルを通して、@n
+			RX_MOD で受信する。@n
+			・クロックのずれ（drift）、サンプル位置の揺らぎ（jitter） @n
+			・グリッチ（サンプル毎に反転する確率）、フレーム間の雑音 @n
+			・受信したフレームは全て送信したものと一致する事（誤ったフレームを受けない） @n
+			・雑音だけの入力で、フレームを受けない事
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+namespace {
+
+	uint8_t	tx_level_ = 0;
+	uint8_t	rx_level_ = 0;
+
+	struct dir_null {
+		void operator = (int v) { }
+	};
+
+	// 送信ポート（出力レベルを記録する）
+	struct TX_PORT {
+		struct p_t {
+			void operator = (int v) { tx_level_ = v; }
+			int operator () () const { return tx_level_; }
+		};
+		static p_t		P;
+		static dir_null	DIR;
+	};
+	TX_PORT::p_t	TX_PORT::P;
+	dir_null		TX_PORT::DIR;
+
+	// 受信ポート（通信路モデルの出力を読む）
+	struct RX_PORT {
+		struct p_t {
+			int operator () () const { return rx_level_; }
+		};
+		static p_t		P;
+		static dir_null	DIR;
+	};
+	RX_PORT::p_t	RX_PORT::P;
+	dir_null		RX_PORT::DIR;
+}
+
+#include "chip/TX_MOD.hpp"
+#include "chip/RX_MOD.hpp"
+
+namespace {
+
+	static const uint8_t OVS = 8;
+
+	struct channel_t {
+		double	drift;		///< 受信クロックのずれ（比率）
+		double	jitter;		///< サンプル位置の揺らぎ（スロット）
+		double	glitch;		///< サンプル毎に反転する確率
+		double	noise;		///< フレーム間の雑音の確率
+		int		pass;		///< 受信しなければならないフレーム数
+	};
+
+	// 戻り値：受信したフレーム数、誤ったフレームを受けた場合「-1」
+	template <uint8_t SNUM>
+	int run_(const channel_t& ch, int packets, unsigned seed)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+		chip::TX_MOD<TX_PORT, 4, SNUM> tx;
+		chip::RX_MOD<RX_PORT, 4, SNUM, OVS> rx;
+		tx.start();
+		rx.start();
+
+		// 送信波形（スロット毎のレベル）
+		std::vector<uint8_t> wave;
+		std::vector<std::vector<uint8_t> > sent;
+		for(int p = 0; p < packets; ++p) {
+			int gap = 5 + rng() % 40;
+			for(int i = 0; i < gap; ++i) {
+				wave.push_back(uni(rng) < ch.noise ? (rng() & 1) : tx_level_);
+			}
+			uint8_t d[SNUM];
+			uint8_t len = 1 + rng() % SNUM;
+			for(uint8_t i = 0; i < len; ++i) d[i] = rng();
+			sent.push_back(std::vector<uint8_t>(d, d + len));
+			if(!tx.send(d, len)) return -1;
+			while(tx.probe()) {
+				tx.service();
+				wave.push_back(tx_level_);
+			}
+		}
+		for(int i = 0; i < 10; ++i) wave.push_back(tx_level_);
+
+		// 受信（スロットの OVS 倍の周期でサンプル）
+		int got = 0;
+		size_t idx = 0;
+		uint8_t buf[SNUM];
+		double t = uni(rng);
+		while(1) {
+			double tt = t + (uni(rng) - 0.5) * ch.jitter;
+			size_t slot = static_cast<size_t>(tt);
+			if(slot >= wave.size()) break;
+			rx_level_ = wave[slot];
+			if(uni(rng) < ch.glitch) rx_level_ ^= 1;
+			rx.service();
+			if(rx.probe()) {
+				uint8_t n = rx.get(buf);
+				while(idx < sent.size()
+				  && !(sent[idx].size() == n && std::equal(buf, buf + n, sent[idx].begin()))) ++idx;
+				if(idx >= sent.size()) return -1;
+				++got;
+				++idx;
+			}
+			t += (1.0 / OVS) * (1.0 + ch.drift);
+		}
+		printf("SNUM %2u, drift %+.2f, jitter %.2f, glitch %.3f, noise %.1f: %d/%d (CRC error %u)\n",
+			SNUM, ch.drift, ch.jitter, ch.glitch, ch.noise, got, packets, rx.get_error_count());
+		return got;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	static const channel_t chs[] = {
+		{  0.00, 0.00, 0.000, 0.0, 200 },
+		{  0.03, 0.00, 0.000, 0.0, 200 },
+		{ -0.03, 0.00, 0.000, 0.0, 200 },
+		{  0.02, 0.15, 0.000, 0.5, 198 },
+		{ -0.02, 0.15, 0.003, 0.5, 194 },
+		{  0.00, 0.30, 0.010, 1.0, 180 },
+	};
+
+	bool ok = true;
+	for(unsigned i = 0; i < sizeof(chs) / sizeof(chs[0]); ++i) {
+		const channel_t& ch = chs[i];
+		int n = run_<4>(ch, 200, i + 1);
+		if(n < ch.pass) ok = false;
+	}
+	// 最大長（bit_pos_ が８ビットで数えられる長さ）
+	for(unsigned i = 0; i < 4; ++i) {
+		const channel_t& ch = chs[i];
+		int n = run_<29>(ch, 200, i + 11);
+		if(n < ch.pass) ok = false;
+	}
+
+	// 雑音だけの入力
+	{
+		std::mt19937 rng(7);
+		chip::RX_MOD<RX_PORT, 4, 4, OVS> rx;
+		rx.start();
+		uint8_t buf[4];
+		int n = 0;
+		for(long i = 0; i < 4000000; ++i) {
+			if(i % ((rng() % 7) + 1) == 0) rx_level_ = rng() & 1;
+			rx.service();
+			if(rx.get(buf)) ++n;
+		}
+		printf("noise only: %d frames (CRC error %u)\n", n, rx.get_error_count());
+		if(n != 0) ok = false;
+	}
+
+	if(!ok) {
+		printf("NG\n");
+		return 1;
+	}
+	printf("OK\n");
+	return 0;
+}
@@ -0,0 +1,149 @@
+//=====================================================================//
+/*!	@file
+	@brief	monograph 描画テスト、ベンチマーク @n
+			・ページ構成（PAGE_LAYOUT）の高速パスと、operator() による描画が一致する事 @n
+			・「fb()」を持つが PAGE_LAYOUT を宣言しない（ラスター構成）PLOT が壊れない事 @n
+			・高速パスと operator() パスの描画速度
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include "common/monograph.hpp"
+#include "common/font6x12.hpp"
+
+namespace {
+
+	static const int16_t W = 128;
+	static const int16_t H = 64;
+
+	// ページ構成（縦８ピクセル、１バイト）
+	struct page_base {
+		typedef int16_t value_type;
+		static const int16_t WIDTH  = W;
+		static const int16_t HEIGHT = H;
+		uint8_t	fb_[W * H / 8];
+		void clear(uint8_t v = 0) { memset(fb_, v, sizeof(fb_)); }
+		void operator() (int16_t x, int16_t y, bool val)
+		{
+			if(x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) return;
+			uint8_t& d = fb_[(y >> 3) * WIDTH + x];
+			if(val) d |= 1 << (y & 7);
+			else d &= ~(1 << (y & 7));
+		}
+	};
+
+	struct PAGE_FAST : public page_base {
+		static const bool PAGE_LAYOUT = true;
+		uint8_t* fb() { return fb_; }
+	};
+
+	struct PAGE_SLOW : public page_base { };
+
+	// ラスター構成（横８ピクセル、１バイト）で「fb()」を持つ
+	struct RASTER {
+		typedef int16_t value_type;
+		static const int16_t WIDTH  = W;
+		static const int16_t HEIGHT = H;
+		uint8_t	fb_[W * H / 8];
+		uint8_t* fb() { return fb_; }
+		void clear(uint8_t v = 0) { memset(fb_, v, sizeof(fb_)); }
+		void operator() (int16_t x, int16_t y, bool val)
+		{
+			if(x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) return;
+			uint8_t& d = fb_[y * (WIDTH / 8) + (x >> 3)];
+			if(val) d |= 0x80 >> (x & 7);
+			else d &= ~(0x80 >> (x & 7));
+		}
+		bool get(int16_t x, int16_t y) const {
+			return fb_[y * (WIDTH / 8) + (x >> 3)] & (0x80 >> (x & 7));
+		}
+	};
+
+	graphics::kfont_null kfont_;
+
+	template <class MONO>
+	void draw_ops_(MONO& m, unsigned seed)
+	{
+		srand(seed);
+		m.clear(0);
+		for(int i = 0; i < 300; ++i) {
+			int op = rand() % 6;
+			int x = rand() % 160 - 16;
+			int y = rand() % 90 - 13;
+			int w = rand() % 50;
+			int h = rand() % 40;
+			bool c = rand() & 1;
+			switch(op) {
+			case 0: m.fill(x, y, w, h, c); break;
+			case 1: m.frame(x, y, w, h, c); break;
+			case 2: m.line(x, y, x + (rand() % 3 ? w : 0), y + (rand() % 2 ? h : 0), c); break;
+			case 3:
+				{
+					char t[8];
+					for(int k = 0; k < 7; ++k) t[k] = 32 + rand() % 90;
+					t[7] = 0;
+					m.draw_text(x, y, t);
+				}
+				break;
+			case 4: m.draw_image(x, y, graphics::font6x12::get(rand() % 128), w % 17, h % 13); break;
+			case 5: m.plot(x, y, c); break;
+			}
+		}
+	}
+
+	template <class MONO>
+	double bench_(MONO& m)
+	{
+		auto t0 = std::chrono::steady_clock::now();
+		long px = 0;
+		for(int r = 0; r < 2000; ++r) {
+			for(int l = 0; l < 5; ++l) {
+				m.draw_text(0, l * 12, "Hello R8C 0123456789!");
+				px += 21 * graphics::font6x12::WIDTH * graphics::font6x12::HEIGHT;
+			}
+			m.fill(3, 5, 100, 40, r & 1);
+			px += 100 * 40;
+		}
+		double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		return px / sec / 1e6;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	graphics::monograph<PAGE_FAST, graphics::font6x12> fast(kfont_);
+	graphics::monograph<PAGE_SLOW, graphics::font6x12> slow(kfont_);
+	graphics::monograph<RASTER, graphics::font6x12> raster(kfont_);
+
+	for(unsigned seed = 1; seed < 200; ++seed) {
+		draw_ops_(fast, seed);
+		draw_ops_(slow, seed);
+		draw_ops_(raster, seed);
+		if(memcmp(fast.at_plot().fb_, slow.at_plot().fb_, sizeof(fast.at_plot().fb_)) != 0) {
+			printf("NG: page fast path mismatch (seed %u)\n", seed);
+			return 1;
+		}
+		for(int16_t y = 0; y < H; ++y) {
+			for(int16_t x = 0; x < W; ++x) {
+				bool a = slow.at_plot().fb_[(y >> 3) * W + x] & (1 << (y & 7));
+				if(a != raster.at_plot().get(x, y)) {
+					printf("NG: raster PLOT with fb() mismatch (seed %u, %d, %d)\n", seed, x, y);
+					return 1;
+				}
+			}
+		}
+	}
+	printf("OK: fast path == operator() path, raster fb() PLOT untouched by fast path\n");
+
+	double s = bench_(slow);
+	double f = bench_(fast);
+	printf("operator(): %.1f Mpix/s, page fast path: %.1f Mpix/s (x%.1f)\n", s, f, f / s);
+	return 0;
+}
@@ -0,0 +1,366 @@
+//=====================================================================//
+/*!	@file
+	@brief	nRF905 ベンチマーク @n
+			nRF905 ２台（SPI、端子、ShockBurst の送受信、電波の衝突）をマイクロ秒単位で @n
+			シミュレーションし、chip::nRF905 で一方向にパケットを送り続ける。@n
+			・受信したパケットの内容、順番が正しい事 @n
+			・損失が無い通信路で、パケットが欠けない事 @n
+			・パケット数、再送、１パケット当たりの SPI バイト数を表示
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "chip/nRF905.hpp"
+
+namespace {
+
+	static const uint8_t PW = 32;					///< ペイロード幅
+	static const uint32_t SPI_BYTE_US = 40;			///< SPI １バイトの時間
+	static const uint32_t LOOP_US = 20;				///< メインループ１回の時間
+	static const uint32_t STBY_TO_ACTIVE_US = 650;	///< ST_BY -> TX/RX
+	static const uint32_t BIT_US = 20;				///< 50 kbps（マンチェスター）
+
+	uint64_t	now_ = 0;
+	int			cur_ = 0;
+	uint64_t	cpu_[2];
+	uint32_t	spi_bytes_[2];
+	double		loss_ = 0.0;
+	std::mt19937	rng_(1);
+
+	// 電波（送信されたパケット）
+	struct air_t {
+		int			from;
+		uint32_t	dst;
+		uint8_t		pl[PW];
+		uint64_t	t0;
+		uint64_t	t1;
+		bool		bad;	///< 衝突
+	};
+	std::vector<air_t>	air_;
+
+	// nRF905 のモデル（自動再送無し、固定長ペイロード）
+	struct chip_t {
+		enum class ST { STBY, TX_START, TX, RX_START, RX };
+
+		int			id;
+		uint8_t		cfg[10];
+		uint8_t		txa[4];
+		uint8_t		txp[PW];
+		uint8_t		rxp[PW];
+		bool		ce;
+		bool		txe;
+		bool		pwr;
+		bool		dr;
+		bool		am;
+		ST			st;
+		uint64_t	t_ev;
+		int			air_idx;
+		int			rx_idx;
+		bool		ss;
+		int			cmd;
+		int			pos;
+
+		chip_t(int n) : id(n), cfg{ 0 }, txa{ 0 }, txp{ 0 }, rxp{ 0 },
+			ce(false), txe(false), pwr(false), dr(false), am(false),
+			st(ST::STBY), t_ev(0), air_idx(-1), rx_idx(-1), ss(true), cmd(-1), pos(0) { }
+
+		uint32_t rx_addr() const {
+			return cfg[5] | (cfg[6] << 8) | (cfg[7] << 16) | (static_cast<uint32_t>(cfg[8]) << 24);
+		}
+
+		// プリアンブル、アドレス、ペイロード、CRC
+		static uint64_t air_time() { return (10 + 32 + PW * 8 + 16) * BIT_US; }
+
+		void pins() {
+			if(!pwr) {
+				st = ST::STBY;
+				return;
+			}
+			if(ce && txe) {
+				if(st != ST::TX_START && st != ST::TX) {
+					st = ST::TX_START;
+					t_ev = now_ + STBY_TO_ACTIVE_US;
+					dr = false;
+				}
+			} else if(ce && !txe) {
+				if(st != ST::RX_START && st != ST::RX) {
+					st = ST::RX_START;
+					t_ev = now_ + STBY_TO_ACTIVE_US;
+					dr = false;
+					am = false;
+					rx_idx = -1;
+				}
+			} else if(st == ST::RX || st == ST::RX_START) {
+				st = ST::STBY;
+				am = false;
+				rx_idx = -1;
+			}
+			// 送信中に CE を下げた場合、そのパケットは最後まで送る
+		}
+
+		void update() {
+			if(st == ST::TX_START && now_ >= t_ev) {
+				air_t a;
+				a.from = id;
+				a.dst = txa[0] | (txa[1] << 8) | (txa[2] << 16) | (static_cast<uint32_t>(txa[3]) << 24);
+				memcpy(a.pl, txp, PW);
+				a.t0 = t_ev;
+				a.t1 = t_ev + air_time();
+				a.bad = false;
+				for(auto& b : air_) {
+					if(b.t1 > a.t0) {
+						b.bad = true;
+						a.bad = true;
+					}
+				}
+				air_.push_back(a);
+				air_idx = air_.size() - 1;
+				st = ST::TX;
+			}
+			if(st == ST::TX && now_ >= air_[air_idx].t1) {
+				dr = true;
+				if(ce && txe) {
+					st = ST::TX_START;
+					t_ev = now_;
+				} else {
+					st = ST::STBY;
+				}
+			}
+			if(st == ST::RX_START && now_ >= t_ev) st = ST::RX;
+			if(st != ST::RX) return;
+
+			if(rx_idx < 0) {
+				for(size_t i = 0; i < air_.size(); ++i) {
+					const air_t& a = air_[i];
+					if(a.from == id || a.dst != rx_addr()) continue;
+					uint64_t tam = a.t0 + (10 + 32) * BIT_US;  // アドレス一致
+					if(a.t0 >= t_ev && now_ >= tam && now_ < a.t1) {
+						rx_idx = i;
+						am = true;
+					}
+				}
+			} else if(now_ >= air_[rx_idx].t1) {
+				const air_t& a = air_[rx_idx];
+				am = false;
+				std::uniform_real_distribution<double> uni(0.0, 1.0);
+				if(!a.bad && uni(rng_) >= loss_ && !dr) {
+					memcpy(rxp, a.pl, PW);
+					dr = true;
+				}
+				rx_idx = -1;
+			}
+		}
+
+		uint8_t xchg(uint8_t d) {
+			++spi_bytes_[id];
+			sim_advance(SPI_BYTE_US);
+			if(ss) return 0xff;
+			if(cmd < 0) {  // コマンド、ステータスを返す
+				cmd = d;
+				pos = 0;
+				return (dr ? 0x20 : 0) | (am ? 0x80 : 0);
+			}
+			uint8_t r = 0;
+			if((cmd & 0xf0) == 0x00) {
+				if(cmd + pos < 10) cfg[cmd + pos] = d;
+			} else if((cmd & 0xf0) == 0x10) {
+				if((cmd & 15) + pos < 10) r = cfg[(cmd & 15) + pos];
+			} else if(cmd == 0x20) {
+				if(pos < PW) txp[pos] = d;
+			} else if(cmd == 0x22) {
+				if(pos < 4) txa[pos] = d;
+			} else if(cmd == 0x24) {
+				if(pos < PW) r = rxp[pos];
+			} else if((cmd & 0xf0) == 0x80) {
+				if(pos == 0) {
+					cfg[0] = d;
+					cfg[1] = (cfg[1] & ~0x0f) | (cmd & 0x0f);
+				}
+			}
+			++pos;
+			return r;
+		}
+
+		void select(bool lvl) {
+			if(!ss && lvl) {
+				if(cmd == 0x24) dr = false;  // R_RX_PAYLOAD の後
+				cmd = -1;
+			}
+			ss = lvl;
+		}
+	};
+
+	chip_t*	chips_[2];
+
+	template <int N>
+	struct spi_sim {
+		uint8_t xchg(uint8_t d = 0xff) { return chips_[N]->xchg(d); }
+		void send(const void* src, uint32_t n) {
+			const uint8_t* p = static_cast<const uint8_t*>(src);
+			while(n > 0) { xchg(*p++); --n; }
+		}
+		void recv(void* dst, uint32_t n) {
+			uint8_t* p = static_cast<uint8_t*>(dst);
+			while(n > 0) { *p++ = xchg(); --n; }
+		}
+	};
+
+	enum class PIN { SS, CE, TXE, PWR, DR, AM };
+
+	template <int N, PIN PN>
+	struct port_sim {
+		struct p_t {
+			void operator = (bool f) {
+				chip_t& c = *chips_[N];
+				switch(PN) {
+				case PIN::SS:  c.select(f); break;
+				case PIN::CE:  c.ce = f;  c.pins(); break;
+				case PIN::TXE: c.txe = f; c.pins(); break;
+				case PIN::PWR: c.pwr = f; c.pins(); break;
+				default: break;
+				}
+			}
+			bool operator () () const {
+				chip_t& c = *chips_[N];
+				c.update();
+				if(PN == PIN::DR) return c.dr;
+				if(PN == PIN::AM) return c.am;
+				return false;
+			}
+		};
+		struct dir_t {
+			void operator = (bool f) { }
+		};
+		static p_t		P;
+		static dir_t	DIR;
+	};
+	template <int N, PIN PN> typename port_sim<N, PN>::p_t port_sim<N, PN>::P;
+	template <int N, PIN PN> typename port_sim<N, PN>::dir_t port_sim<N, PN>::DIR;
+
+	template <int N>
+	using RF = chip::nRF905<spi_sim<N>, port_sim<N, PIN::SS>, port_sim<N, PIN::CE>,
+		port_sim<N, PIN::TXE>, port_sim<N, PIN::PWR>, port_sim<N, PIN::DR>, port_sim<N, PIN::AM>, PW>;
+
+	static const uint32_t ADDR0 = 0x11223344;
+	static const uint32_t ADDR1 = 0xA5A5A5A5;
+
+	struct result_t {
+		uint32_t	posted;
+		uint32_t	recv;
+		uint32_t	bad;
+		uint32_t	gaps;
+	};
+
+	// 0 -> 1 へ、データ長 DATA_MAX のパケットを送り続ける
+	bool run_(double loss, bool ack, uint64_t period, result_t& res)
+	{
+		now_ = 0;
+		cpu_[0] = cpu_[1] = 0;
+		spi_bytes_[0] = spi_bytes_[1] = 0;
+		air_.clear();
+		loss_ = loss;
+		rng_.seed(1);
+
+		chip_t c0(0);
+		chip_t c1(1);
+		chips_[0] = &c0;
+		chips_[1] = &c1;
+		spi_sim<0> s0;
+		spi_sim<1> s1;
+		RF<0> r0(s0);
+		RF<1> r1(s1);
+		cur_ = 0;
+		if(!r0.start(ADDR0)) return false;
+		cur_ = 1;
+		now_ = cpu_[0];
+		if(!r1.start(ADDR1)) return false;
+
+		res = result_t { 0, 0, 0, 0 };
+		uint64_t tick[2] = { 0, 0 };
+		uint8_t expect = 0;
+		while(1) {
+			// 時間が遅れている方の CPU を進める
+			cur_ = cpu_[0] <= cpu_[1] ? 0 : 1;
+			now_ = std::max(now_, cpu_[cur_]);
+			cpu_[cur_] = now_;
+			if(now_ >= period) break;
+
+			while(tick[cur_] + 1000 <= now_) {  // 1ms
+				tick[cur_] += 1000;
+				if(cur_ == 0) r0.tick(); else r1.tick();
+			}
+			if(cur_ == 0) {
+				uint8_t d[RF<0>::DATA_MAX];
+				for(uint8_t i = 0; i < sizeof(d); ++i) d[i] = res.posted + i;
+				if(r0.tx_length() == 0 && r0.post(ADDR1, d, sizeof(d), ack)) ++res.posted;
+				r0.service();
+			} else {
+				r1.service();
+				RF<1>::packet_t p;
+				while(r1.get(p)) {
+					if(p.src != ADDR0 || p.len != RF<1>::DATA_MAX) ++res.bad;
+					for(uint8_t i = 0; i < p.len; ++i) {
+						if(p.data[i] != static_cast<uint8_t>(p.data[0] + i)) ++res.bad;
+					}
+					if(p.data[0] != expect) ++res.gaps;
+					expect = p.data[0] + 1;
+					++res.recv;
+				}
+			}
+			sim_advance(LOOP_US);
+		}
+
+		double sec = period / 1e6;
+		printf("loss %.2f, ack %d: posted %u, recv %u (%.1f packet/s, %.1f kbit/s), bad %u, gaps %u\n",
+			loss, ack, res.posted, res.recv, res.recv / sec, res.recv * RF<1>::DATA_MAX * 8 / sec / 1000,
+			res.bad, res.gaps);
+		uint32_t n = res.recv ? res.recv : 1;
+		printf("  send %u, retry %u, fail %u, dup %u, lost %u, SPI bytes/packet TX %.1f, RX %.1f\n",
+			r0.get_send_count(), r0.get_retry_count(), r0.get_fail_count(), r1.get_dup_count(),
+			r1.get_lost(), static_cast<double>(spi_bytes_[0]) / n, static_cast<double>(spi_bytes_[1]) / n);
+		return true;
+	}
+}
+
+
+void sim_advance(uint32_t us)
+{
+	for(uint32_t i = 0; i < us; ++i) {
+		++now_;
+		chips_[0]->update();
+		chips_[1]->update();
+	}
+	cpu_[cur_] = now_;
+}
+
+
+int main(int argc, char* argv[])
+{
+	static const uint64_t PERIOD = 4000000;  // 4 秒
+	bool ok = true;
+	result_t r;
+
+	// 損失無し：全て届く（最後の１パケットは送信中の場合がある）
+	if(!run_(0.0, true, PERIOD, r)) return 1;
+	ok = ok && r.bad == 0 && r.gaps == 0 && r.recv + 1 >= r.posted && r.recv > 0;
+	if(!run_(0.0, false, PERIOD, r)) return 1;
+	ok = ok && r.bad == 0 && r.gaps == 0 && r.recv + 1 >= r.posted && r.recv > 0;
+
+	// 20% の損失：再送で補う、壊れたパケットを受けない
+	if(!run_(0.2, true, PERIOD, r)) return 1;
+	ok = ok && r.bad == 0 && r.recv > 0;
+
+	if(!ok) {
+		printf("NG\n");
+		return 1;
+	}
+	printf("OK\n");
+	return 0;
+}
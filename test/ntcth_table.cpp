@@ -0,0 +1,74 @@
+//=====================================================================//
+/*!	@file
+	@brief	NTCTH テーブル変換テスト @n
+			全ての A/D 値で、テーブル補間（整数演算）と get_float() を比較する @n
+			・-10 ～ 80 度： 最大誤差 0.1 度以下 @n
+			・-40 ～ 125 度：最大誤差 1.0 度以下 @n
+			・温度が A/D 値に対して単調である事
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cmath>
+#include "chip/NTCTH.hpp"
+
+namespace {
+
+	struct range_t {
+		double	lo;
+		double	hi;
+		double	limit;
+	};
+
+	static const range_t ranges_[] = {
+		{ -10.0,  80.0, 0.1 },
+		{ -40.0, 125.0, 1.0 },
+	};
+
+	template <class T, uint32_t ADNUM>
+	bool check_(const char* name, bool up)
+	{
+		T th;
+		bool ok = true;
+		for(const auto& r : ranges_) {
+			double mx = 0.0;
+			uint32_t at = 0;
+			for(uint32_t a = 1; a < ADNUM; ++a) {
+				double ref = T::get_float(a);
+				if(ref < r.lo || r.hi < ref) continue;
+				double e = std::fabs(th(a) / 100.0 - ref);
+				if(e > mx) { mx = e; at = a; }
+			}
+			bool f = mx <= r.limit;
+			printf("%s: %4.0f .. %3.0f C: max error %.3f C (A/D %u) %s\n",
+				name, r.lo, r.hi, mx, static_cast<unsigned>(at), f ? "OK" : "NG");
+			ok = ok && f;
+		}
+
+		// サーミスターが VCC 側なら A/D 値と共に温度が上がる
+		for(uint32_t a = 1; a < ADNUM; ++a) {
+			int16_t t0 = th(a - 1);
+			int16_t t1 = th(a);
+			if(up ? (t1 < t0) : (t1 > t0)) {
+				printf("%s: not monotonic at A/D %u (%d, %d) NG\n", name, static_cast<unsigned>(a), t0, t1);
+				return false;
+			}
+		}
+		return ok;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	using chip::thermistor;
+	bool ok = true;
+	ok &= check_<chip::NTCTH<1023, thermistor::HX103_3380, 10000, true>, 1023>("10 bits, HX103_3380, VCC side", true);
+	ok &= check_<chip::NTCTH<1023, thermistor::NT103_41G, 10000, false>, 1023>("10 bits, NT103_41G, GND side", false);
+	ok &= check_<chip::NTCTH<4095, thermistor::NT103_34G, 10000, true>, 4095>("12 bits, NT103_34G, VCC side", true);
+	ok &= check_<chip::NTCTH<4095, thermistor::NT103_34G, 4700, false>, 4095>("12 bits, NT103_34G 4.7K, GND side", false);
+	return ok ? 0 : 1;
+}
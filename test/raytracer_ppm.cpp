@@ -0,0 +1,100 @@
+//=====================================================================//
+/*!	@file
+	@brief	レイトレーサー、固定小数点版と float 版の比較 @n
+			同じ乱数列で両方を描画し、PPM で出力、平均誤差と１ピクセル当たりの時間を表示する @n
+			raytracer_ppm [出力ディレクトリ]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace {
+
+	static const int W = 320;
+	static const int H = 240;
+
+	/// 平均誤差（８ビット／チャネル）の上限
+	static const double MAE_LIMIT = 2.0;
+
+	std::vector<uint8_t>* img_;
+
+	typedef std::chrono::steady_clock clock_;
+	clock_::time_point start_ = clock_::now();
+
+	void write_ppm_(const std::string& fn, const std::vector<uint8_t>& img)
+	{
+		FILE* fp = fopen(fn.c_str(), "wb");
+		if(fp == nullptr) return;
+		fprintf(fp, "P6\n%d %d\n255\n", W, H);
+		fwrite(&img[0], 1, img.size(), fp);
+		fclose(fp);
+	}
+}
+
+extern "C" {
+
+	void draw_pixel(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b)
+	{
+		auto& v = *img_;
+		int i = (y * W + x) * 3;
+		v[i + 0] = r;
+		v[i + 1] = g;
+		v[i + 2] = b;
+	}
+
+	void draw_text(int16_t x, int16_t y, const char* t) { }
+
+	uint32_t millis(void)
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(clock_::now() - start_).count();
+	}
+};
+
+#include "RAYTRACER_sample/raytracer.hpp"
+
+int main(int argc, char* argv[])
+{
+	std::vector<uint8_t> ref(W * H * 3);
+	std::vector<uint8_t> fix(W * H * 3);
+
+	img_ = &ref;
+	auto t0 = clock_::now();
+	doRaytrace<float>(1, W, H, 1);
+	auto t1 = clock_::now();
+	img_ = &fix;
+	doRaytrace<fixed>(1, W, H, 1);
+	auto t2 = clock_::now();
+	double us_ref = std::chrono::duration<double, std::micro>(t1 - t0).count() / (W * H);
+	double us_fix = std::chrono::duration<double, std::micro>(t2 - t1).count() / (W * H);
+
+	if(argc > 1) {
+		std::string dir = argv[1];
+		write_ppm_(dir + "/ray_float.ppm", ref);
+		write_ppm_(dir + "/ray_fixed.ppm", fix);
+	}
+
+	double sum = 0.0;
+	int max = 0;
+	for(size_t i = 0; i < ref.size(); ++i) {
+		int d = abs(static_cast<int>(ref[i]) - static_cast<int>(fix[i]));
+		sum += d;
+		if(d > max) max = d;
+	}
+	double mae = sum / ref.size();
+	printf("%dx%d, 1 ray/px: mean abs error %.3f, max %d (limit %.1f)\n", W, H, mae, max, MAE_LIMIT);
+	printf("float: %.3f us/px, fixed: %.3f us/px (host)\n", us_ref, us_fix);
+	if(mae > MAE_LIMIT) {
+		printf("NG\n");
+		return 1;
+	}
+	printf("OK\n");
+	return 0;
+}
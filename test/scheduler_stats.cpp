@@ -0,0 +1,92 @@
+//=====================================================================//
+/*!	@file
+	@brief	scheduler / trb_io 実行時間計測テスト @n
+			TETRIS_16x16LED と同じ設定（trb_io<null_task, uint8_t>、60Hz）で、@n
+			TRBPRE/TRBPR の値を書き換えてタスクの実行時間を模擬する。@n
+			・get_timer() が８ビットで切り捨てられない事 @n
+			・ティックを跨いだ場合も含め、max/sum が模擬した時間と一致する事
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include "common/intr_utils.hpp"
+#include "common/trb_io.hpp"
+#include "common/scheduler.hpp"
+
+namespace {
+
+	typedef device::trb_io<utils::null_task, uint8_t> TIMER_B;
+	TIMER_B	timer_b_;
+
+	struct idle_null {
+		void operator() () { }
+	};
+
+	typedef utils::scheduler<TIMER_B, 2, idle_null> SCHEDULER;
+	SCHEDULER	scheduler_(timer_b_);
+
+	void set_timer_(uint16_t n)
+	{
+		device::TRBPRE = n & 0xff;
+		device::TRBPR  = n >> 8;
+	}
+
+	// ティック内で 0x1234 カウント
+	void task_a_()
+	{
+		set_timer_(40000 - 0x1234);
+	}
+
+	// ティックを跨いで 151 カウント
+	void task_b_()
+	{
+		TIMER_B::itask();
+		set_timer_(timer_b_.get_limit() - 50);
+	}
+
+	bool check_(const char* name, int8_t id, uint32_t t)
+	{
+		const SCHEDULER::info_t& i = scheduler_.get_info(id);
+		printf("%s: run %u, max %u, sum %u (expect %u)\n", name,
+			static_cast<unsigned>(i.run), static_cast<unsigned>(i.max),
+			static_cast<unsigned>(i.sum), static_cast<unsigned>(t));
+		return i.run == 1 && i.max == t && i.sum == t;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	timer_b_.start(60, 1);
+	// 20MHz / 8 / 60Hz - 1
+	if(timer_b_.get_limit() != 41665) {
+		printf("NG: limit %u\n", timer_b_.get_limit());
+		return 1;
+	}
+
+	set_timer_(0xA2C1);
+	if(timer_b_.get_timer() != 0xA2C1) {
+		printf("NG: get_timer() 0x%04X\n", timer_b_.get_timer());
+		return 1;
+	}
+
+	int8_t a = scheduler_.add(task_a_, 0);
+	set_timer_(40000);
+	scheduler_.service();
+
+	int8_t b = scheduler_.add(task_b_, 0);
+	set_timer_(100);
+	scheduler_.service();
+
+	bool ok = check_("task A", a, 0x1234);
+	ok = check_("task B", b, (41665 + 1) + 100 - (41665 - 50)) && ok;
+	if(!ok) {
+		printf("NG\n");
+		return 1;
+	}
+	printf("OK\n");
+	return 0;
+}
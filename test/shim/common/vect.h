@@ -0,0 +1,17 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ホスト・テスト用 vect.h 代替 @n
+			割り込み関係を無効化する
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2015, 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <unistd.h>
+
+#define INTERRUPT_FUNC
+
+static inline void di(void) { }
+static inline void ei(void) { }
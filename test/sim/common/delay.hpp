@@ -0,0 +1,28 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	delay の代替（シミュレーション時間を進める） @n
+			待ちの間、シミュレーションしているデバイスの時間を進める為、@n
+			テスト側で「sim_advance」を定義する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+
+/// シミュレーション時間をマイクロ秒単位で進める
+void sim_advance(uint32_t us);
+
+namespace utils {
+
+	struct delay {
+		/// マイクロ秒単位に切り上げて進める
+		template <uint32_t NS>
+		static void nano_second() { sim_advance((NS + 999) / 1000); }
+		static void nano_second(uint16_t ns) { sim_advance((static_cast<uint32_t>(ns) + 999) / 1000); }
+		static void micro_second(uint16_t us) { sim_advance(us); }
+		static void milli_second(uint16_t ms) { sim_advance(static_cast<uint32_t>(ms) * 1000); }
+	};
+}
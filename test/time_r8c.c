@@ -0,0 +1,19 @@
+//=====================================================================//
+/*!	@file
+	@brief	common/time.c をホストでビルドする為のラッパー @n
+			C ライブラリ（glibc）の関数、構造体と名前が重なるので、@n
+			r8c_ を付けた名前でコンパイルする。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#define tm			r8c_tm
+#define gmtime		r8c_gmtime
+#define gmtime_r	r8c_gmtime_r
+#define localtime	r8c_localtime
+#define localtime_r	r8c_localtime_r
+#define mktime		r8c_mktime
+
+#include "common/time.c"
@@ -0,0 +1,92 @@
+//=====================================================================//
+/*!	@file
+	@brief	common/time.c テスト @n
+			1970年～2099年を C ライブラリ（glibc）と比較する。@n
+			・gmtime_r と glibc gmtime_r（約１時間毎、秒、分、時、日、月、年、曜日、通日）@n
+			・mktime_gmt と glibc timegm（gmtime_r の結果を戻す）@n
+			・get_total_day（毎日）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/R8C/blob/master/LICENSE
+*/
+//=====================================================================//
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+// common/time.h の構造体、関数（time_r8c.c で r8c_ を付けてコンパイル）
+struct r8c_tm {
+	uint8_t		tm_sec;
+	uint8_t		tm_min;
+	uint8_t		tm_hour;
+	uint8_t		tm_mday;
+	uint8_t		tm_mon;
+	uint16_t	tm_year;
+	uint8_t		tm_wday;
+	uint16_t	tm_yday;
+	char		tm_isdst;
+};
+struct r8c_tm *r8c_gmtime_r(const time_t *tp, struct r8c_tm *res);
+time_t mktime_gmt(const struct r8c_tm *tmp);
+long get_total_day(short year, char mon, char day);
+
+// 2100年1月1日 00:00:00
+#define TIME_2100	4102444800LL
+
+static long err_ = 0;
+
+static void error_(const char* msg, time_t t)
+{
+	if(err_ < 10) printf("NG: %s: %lld\n", msg, (long long)t);
+	++err_;
+}
+
+int main(int argc, char* argv[])
+{
+	long n = 0;
+	// 素数の刻みで、時、分、秒の組み合わせを変える
+	for(int64_t t = 0; t < TIME_2100; t += 3607) {
+		time_t tt = t;
+		struct tm a;
+		gmtime_r(&tt, &a);
+		struct r8c_tm b;
+		r8c_gmtime_r(&tt, &b);
+		if(a.tm_sec != b.tm_sec || a.tm_min != b.tm_min || a.tm_hour != b.tm_hour
+		  || a.tm_mday != b.tm_mday || a.tm_mon != b.tm_mon || a.tm_year != b.tm_year
+		  || a.tm_wday != b.tm_wday || a.tm_yday != b.tm_yday) {
+			error_("gmtime_r", tt);
+		}
+		if(mktime_gmt(&b) != timegm(&a)) {
+			error_("mktime_gmt", tt);
+		}
+		++n;
+	}
+
+	// 毎日の最後の秒（日付の境界）
+	long days = 0;
+	for(int64_t t = 86399; t < TIME_2100; t += 86400) {
+		time_t tt = t;
+		struct tm a;
+		gmtime_r(&tt, &a);
+		if(get_total_day(a.tm_year + 1900, a.tm_mon, a.tm_mday) != days) {
+			error_("get_total_day", tt);
+		}
+		struct r8c_tm b;
+		r8c_gmtime_r(&tt, &b);
+		if(b.tm_mday != a.tm_mday || b.tm_mon != a.tm_mon || b.tm_year != a.tm_year
+		  || b.tm_yday != a.tm_yday || b.tm_hour != 23 || b.tm_min != 59 || b.tm_sec != 59) {
+			error_("gmtime_r (end of day)", tt);
+		}
+		if(mktime_gmt(&b) != tt) {
+			error_("mktime_gmt (end of day)", tt);
+		}
+		++days;
+	}
+
+	printf("1970 .. 2099: %ld times, %ld days, %ld errors\n", n, days, err_);
+	if(err_ != 0) return 1;
+	printf("OK\n");
+	return 0;
+}